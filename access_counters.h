@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint> // uint64_t
+#include <vector> // std::vector
+#include "cache_sim.h"
+
+// Per-index read and write counts of the array and of the algorithm's scratch buffer (merge buffers, histograms),
+// filled in by the steps of an algorithm the counters are attached to. Out-of-range indices aren't counted.
+// With a cache attached every access is also replayed through it, the buffer laid out apart from the array.
+struct AccessCounters {
+    std::vector<unsigned int> reads;
+    std::vector<unsigned int> writes;
+    std::vector<unsigned int> buffer_reads;
+    std::vector<unsigned int> buffer_writes;
+    CacheSim* cache = nullptr;
+
+    // Zeroes every count (and the cache) and sizes them for an array of size elements
+    void reset(int size) {
+        for (std::vector<unsigned int>* counts : {&reads, &writes, &buffer_reads, &buffer_writes}) {
+            counts->assign(size, 0);
+        }
+        if (cache != nullptr) {
+            cache->reset();
+        }
+    }
+
+    void read(int i) {
+        add(reads, i);
+        replay(ARRAY_BASE, i, false);
+    }
+    void write(int i) {
+        add(writes, i);
+        replay(ARRAY_BASE, i, true);
+    }
+    void buffer_read(int i) {
+        add(buffer_reads, i);
+        replay(BUFFER_BASE, i, false);
+    }
+    void buffer_write(int i) {
+        add(buffer_writes, i);
+        replay(BUFFER_BASE, i, true);
+    }
+
+private:
+    static constexpr uint64_t ARRAY_BASE = 0;
+    static constexpr uint64_t BUFFER_BASE = 1ULL << 40;
+
+    static void add(std::vector<unsigned int>& counts, int i) {
+        if ((unsigned int)i < counts.size()) {
+            ++counts[i];
+        }
+    }
+
+    void replay(uint64_t base, int i, bool write) {
+        if (cache != nullptr) {
+            cache->access(base + ((uint64_t)i * sizeof(int)), write);
+        }
+    }
+};
@@ -0,0 +1,1373 @@
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "sorting_algo.h"
+#include "bench_results.h"
+#include "cache_sim.h"
+#include "complexity.h"
+#include "external_sort.h"
+#include "input_gen.h"
+#include "perf_counters.h"
+#include "sorting_network.h"
+#include "tuning.h"
+
+// Global constants for default settings
+static const int BENCH_SIZE = 100000;
+static const int BENCH_TRIALS = 3;
+static const int PARALLEL_BENCH_SIZE = 10000000;
+static const unsigned int BENCH_SEED = 12345;
+static const int SUITE_QUADRATIC_MAX_SIZE = 2000; // Past it the O(n^2) sorts would take most of the suite's time
+
+// Simple struct describing a headless benchmark command
+struct BenchCommand {
+    const char* name;
+    int (*run)(int argc, char** argv);
+    const char* help;
+};
+
+// Function prototypes
+static int bench_counting(int argc, char** argv);
+static int bench_parallel_merge(int argc, char** argv);
+static int bench_parallel_quick(int argc, char** argv);
+static int bench_parallel_sample(int argc, char** argv);
+static int bench_networks(int argc, char** argv);
+static int bench_leaf(int argc, char** argv);
+static int bench_tune(int argc, char** argv);
+static int bench_gaps(int argc, char** argv);
+static int bench_merge(int argc, char** argv);
+static int bench_in_place(int argc, char** argv);
+static int bench_heap(int argc, char** argv);
+static int bench_writes(int argc, char** argv);
+static int bench_external(int argc, char** argv);
+static int bench_perf(int argc, char** argv);
+static int bench_cache(int argc, char** argv);
+static int bench_steps(int argc, char** argv);
+static int bench_suite(int argc, char** argv);
+static int bench_sweep(int argc, char** argv);
+static int arg_int(int argc, char** argv, const char* flag, int fallback);
+static const char* arg_str(int argc, char** argv, const char* flag, const char* fallback);
+static double time_sort(SortingAlgo& algo, const std::vector<int>& input, int trials);
+static double time_pairs(const std::vector<int>& input, int trials);
+static std::vector<int> thread_counts(int max_threads);
+static bool is_quadratic(const SortingAlgo& algo);
+static std::string format_bytes(double bytes);
+static void print_host_caches();
+static void print_usage(const char* prog);
+
+static const BenchCommand COMMANDS[] = {
+    {"counting", bench_counting, "Counting Sort (plain, stable and on key/payload pairs) vs Quick Sort (3-way) as the key range grows [--size N] [--trials T] [--max-range F (x n)]"},
+    {"pmerge", bench_parallel_merge, "Parallel Merge Sort speedup from 1 to N threads [--size N] [--threads T] [--trials T]"},
+    {"pquick", bench_parallel_quick, "Parallel Quick Sort, work stealing vs fork/join on random and skewed input [--size N] [--threads T] [--trials T]"},
+    {"psample", bench_parallel_sample, "Parallel Sample Sort scaling from 1 to N threads next to the sequential sorts and the other parallel ones [--size N] [--threads T] [--trials T] [--dist random|few|sorted|reversed|nearly]"},
+    {"networks", bench_networks, "Bitonic and Odd-Even Merge networks per SIMD level vs std::sort [--trials T]"},
+    {"leaf", bench_leaf, "Quick Sort and Merge Sort leaf stage (insertion vs network) and threshold per key type [--size N] [--trials T]"},
+    {"merge", bench_merge, "Merge Sort with copy-back vs ping-pong buffers, writes and time [--max-size N] [--trials T]"},
+    {"inplace", bench_in_place, "In-place block merge (internal buffer) and SymMerge vs buffered Merge Sort, auxiliary memory and time [--max-size N] [--trials T]"},
+    {"heap", bench_heap, "Heap Sort arity (2/4/8), bottom-up sift and prefetch from L1 to DRAM sizes [--max-size N] [--trials T]"},
+    {"writes", bench_writes, "Every stepped algorithm ranked by element writes on the same input [--size N] [--dist random|few|sorted|reversed|nearly]"},
+    {"external", bench_external, "External merge sort of a key file under a memory budget, per in-memory algorithm [--size N] [--budget MiB] [--algo NAME] [--input FILE] [--out FILE] [--keep 1]"},
+    {"perf", bench_perf, "Hardware counters per run: IPC, LLC misses per element, branch misses per comparison [--max-size N] [--trials T] [--algo NAME]"},
+    {"cache", bench_cache, "Simulated cache hit/miss rates and line transfers per element of every stepped run [--size N] [--cache SIZE/WAYS,...] [--line B] [--algo NAME] [--dist random|few|sorted|reversed|nearly]"},
+    {"steps", bench_steps, "Time of every stepped algorithm on every distribution, the PGO training run [--size N] [--trials T] [--save FILE] [--baseline FILE]"},
+    {"suite", bench_suite, "Regression suite: every algorithm x distribution x size, JSON out, significant slowdowns vs a baseline exit with 2 [--sizes N1,N2,...] [--trials T] [--warmup W] [--algo NAME] [--out FILE] [--baseline FILE] [--compare FILE] [--threshold PCT]"},
+    {"sweep", bench_sweep, "Geometric size sweep: fitted complexity of comparisons, swaps and time, and the time per element jumps at cache boundaries [--min N] [--max N] [--factor F] [--trials T] [--max-ms MS] [--count-max N] [--jump PCT] [--algo NAME] [--csv FILE]"},
+    {"gaps", bench_gaps, "Shell Sort and Comb Sort comparisons, swaps and time per gap sequence [--max-size N] [--trials T] [--custom G1,G2,...]"},
+    {"tune", bench_tune, "Sweep the tunable parameters and save the best per size class [--size N] [--trials T] [--dist random|few|sorted|reversed|nearly] [--algo NAME] [--out FILE]"},
+};
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    for (const BenchCommand& command : COMMANDS) {
+        if (std::strcmp(argv[1], command.name) == 0) {
+            return command.run(argc - 2, argv + 2);
+        }
+    }
+
+    std::fprintf(stderr, "Unknown command: %s\n", argv[1]);
+    print_usage(argv[0]);
+    return 1;
+}
+
+static void print_usage(const char* prog) {
+    std::fprintf(stderr, "Usage: %s <command> [options]\n\nCommands:\n", prog);
+    for (const BenchCommand& command : COMMANDS) {
+        std::fprintf(stderr, "  %-10s %s\n", command.name, command.help);
+    }
+}
+
+// Counting sort runs in O(n + k) while the 3-way partition runs in O(n log d) for d distinct keys,
+// so sweeping the key range k past n shows where the histogram stops paying for itself
+static int bench_counting(int argc, char** argv) {
+    const int size = std::max(2, arg_int(argc, argv, "--size", BENCH_SIZE));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+    const int max_factor = std::max(1, arg_int(argc, argv, "--max-range", 256));
+
+    QuickSort quick_sort;
+    CountingSort counting_sort;
+    CountingSort stable_counting_sort(true);
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+
+    std::printf("n = %d, best of %d trials (ms), pairs: keys with an index payload through counting_sort_stable()\n", size,
+        trials);
+    std::printf("%12s %10s %12s %12s %12s %12s\n", "key range", "distinct", "quick 3-way", "counting", "stable", "pairs");
+
+    // Counting sort pays a fixed histogram pass, so the 3-way partition wins for a handful of keys as well as for huge ranges
+    long long lower_crossover = -1;
+    long long upper_crossover = -1;
+    long long first_fallback = -1;
+    for (long long key_range = 1; key_range <= (long long)max_factor * size; key_range *= 2) {
+        fill_key_range(input, size, key_range, rng);
+
+        std::vector<int> sorted = input;
+        std::sort(sorted.begin(), sorted.end());
+        const long long distinct = std::unique(sorted.begin(), sorted.end()) - sorted.begin();
+
+        const double quick_ms = time_sort(quick_sort, input, trials);
+        const double counting_ms = time_sort(counting_sort, input, trials);
+        const double stable_ms = time_sort(stable_counting_sort, input, trials);
+        const double pairs_ms = time_pairs(input, trials);
+        // Past the cap the counting columns time the comparison sort fallback
+        const bool counted = counting_range_fits(key_range, size);
+        std::printf("%12lld %10lld %12.3f %12.3f %12.3f %12.3f%s\n", key_range, distinct, quick_ms, counting_ms, stable_ms,
+            pairs_ms, counted ? "" : "  (fallback)");
+
+        if (!counted) {
+            if (first_fallback < 0) {
+                first_fallback = key_range;
+            }
+        } else if (counting_ms < quick_ms) {
+            if (lower_crossover < 0) {
+                lower_crossover = key_range;
+            }
+        } else if (lower_crossover > 0 && upper_crossover < 0) {
+            upper_crossover = key_range;
+        }
+    }
+
+    if (lower_crossover < 0) {
+        std::printf("Crossover: not reached, Quick Sort (3-way) wins over the whole sweep\n");
+        return 0;
+    }
+    std::printf("Counting Sort wins from a key range of %lld\n", lower_crossover);
+    if (upper_crossover > 0) {
+        std::printf("Quick Sort (3-way) wins again from a key range of %lld (%.2f x n)\n", upper_crossover, (double)upper_crossover / size);
+    } else {
+        std::printf("Quick Sort (3-way) does not win again while Counting Sort counts\n");
+    }
+    if (first_fallback > 0) {
+        std::printf("Counting Sort falls back to a comparison sort from a key range of %lld (%.2f x n)\n", first_fallback,
+            (double)first_fallback / size);
+    }
+    return 0;
+}
+
+static int bench_parallel_merge(int argc, char** argv) {
+    const int size = std::max(2, arg_int(argc, argv, "--size", PARALLEL_BENCH_SIZE));
+    const int max_threads = std::max(1, arg_int(argc, argv, "--threads", (int)std::thread::hardware_concurrency()));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+    fill_permutation(input, size, rng);
+
+    std::printf("n = %d, best of %d trials\n", size, trials);
+    std::printf("%8s %12s %10s %12s\n", "threads", "time (ms)", "speedup", "efficiency");
+
+    ParallelMergeSort parallel_merge_sort;
+    double single_ms = 0.0;
+    for (int threads : thread_counts(max_threads)) {
+        parallel_merge_sort.set_threads(threads);
+        const double ms = time_sort(parallel_merge_sort, input, trials);
+        if (threads == 1) {
+            single_ms = ms;
+        }
+        const double speedup = single_ms / ms;
+        std::printf("%8d %12.3f %9.2fx %11.0f%%\n", threads, ms, speedup, (speedup * 100.0) / threads);
+    }
+    return 0;
+}
+
+// Fork/join hands whole subtrees to threads, so one bad pivot near the top leaves most threads idle.
+// Work stealing keeps splitting the big side and lets idle workers take it.
+static int bench_parallel_quick(int argc, char** argv) {
+    const int size = std::max(2, arg_int(argc, argv, "--size", PARALLEL_BENCH_SIZE));
+    const int max_threads = std::max(1, arg_int(argc, argv, "--threads", (int)std::thread::hardware_concurrency()));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+
+    for (int skewed = 0; skewed <= 1; ++skewed) {
+        std::mt19937 rng(BENCH_SEED);
+        std::vector<int> input;
+        if (skewed) {
+            fill_skewed(input, size, 6, 0.05, rng);
+        } else {
+            fill_permutation(input, size, rng);
+        }
+
+        std::printf("%s keys, n = %d, best of %d trials (ms)\n", skewed ? "Skewed (5%/95% pivots, 6 levels)" : "Random", size, trials);
+        std::printf("%8s %14s %10s %14s %10s\n", "threads", "work stealing", "speedup", "fork/join", "speedup");
+
+        ParallelQuickSort stealing(1, true);
+        ParallelQuickSort fork_join(1, false);
+        double stealing_single_ms = 0.0;
+        double fork_join_single_ms = 0.0;
+        for (int threads : thread_counts(max_threads)) {
+            stealing.set_threads(threads);
+            fork_join.set_threads(threads);
+            const double stealing_ms = time_sort(stealing, input, trials);
+            const double fork_join_ms = time_sort(fork_join, input, trials);
+            if (threads == 1) {
+                stealing_single_ms = stealing_ms;
+                fork_join_single_ms = fork_join_ms;
+            }
+            std::printf("%8d %14.3f %9.2fx %14.3f %9.2fx\n", threads, stealing_ms, stealing_single_ms / stealing_ms, fork_join_ms, fork_join_single_ms / fork_join_ms);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
+// Sample sort touches every element a fixed number of times (classify, scatter, sort its bucket, copy back) and
+// the threads never wait on each other between phases, so it should keep scaling where the merge levels run out
+static int bench_parallel_sample(int argc, char** argv) {
+    const int size = std::max(2, arg_int(argc, argv, "--size", PARALLEL_BENCH_SIZE));
+    const int max_threads = std::max(1, arg_int(argc, argv, "--threads", (int)std::thread::hardware_concurrency()));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+    const char* dist = arg_str(argc, argv, "--dist", "random");
+
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+    if (!fill_distribution(input, size, dist, rng)) {
+        std::fprintf(stderr, "Unknown distribution: %s\n", dist);
+        return 1;
+    }
+
+    std::printf("%s keys, n = %d, best of %d trials (ms)\n", dist, size, trials);
+
+    // Sequential baselines, the speedups below are against the fastest of them
+    std::vector<std::unique_ptr<SortingAlgo>> sequential;
+    sequential.emplace_back(std::make_unique<QuickSort>());
+    sequential.emplace_back(std::make_unique<MergeSort>());
+    sequential.emplace_back(std::make_unique<DaryHeapSort>(4, true));
+    double best_sequential_ms = 0.0;
+    for (const std::unique_ptr<SortingAlgo>& algo : sequential) {
+        const double ms = time_sort(*algo, input, trials);
+        best_sequential_ms = (best_sequential_ms == 0.0) ? ms : std::min(best_sequential_ms, ms);
+        std::printf("%-36s %12.3f\n", algo->name(), ms);
+    }
+    std::printf("\n");
+
+    std::printf("%8s %14s %10s %14s %10s %14s %10s\n", "threads", "sample sort", "speedup", "merge sort", "speedup", "quick sort", "speedup");
+    ParallelSampleSort sample_sort;
+    ParallelMergeSort merge_sort;
+    ParallelQuickSort quick_sort;
+    for (int threads : thread_counts(max_threads)) {
+        sample_sort.set_threads(threads);
+        merge_sort.set_threads(threads);
+        quick_sort.set_threads(threads);
+        const double sample_ms = time_sort(sample_sort, input, trials);
+        const double merge_ms = time_sort(merge_sort, input, trials);
+        const double quick_ms = time_sort(quick_sort, input, trials);
+        std::printf("%8d %14.3f %9.2fx %14.3f %9.2fx %14.3f %9.2fx\n", threads, sample_ms, best_sequential_ms / sample_ms,
+            merge_ms, best_sequential_ms / merge_ms, quick_ms, best_sequential_ms / quick_ms);
+    }
+    return 0;
+}
+
+// Every comparator layer is a run of independent min/max pairs, so the networks trade their extra
+// O(n log² n) comparisons for wide data-parallel layers
+static int bench_networks(int argc, char** argv) {
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+    const int sizes[] = {1 << 12, 1 << 16, 1000003, 1 << 22};
+
+    std::printf("Best of %d trials, throughput in M keys/s (CPU supports up to %s)\n", trials, simd_level_name(network_max_simd_level()));
+    std::printf("%10s %10s %12s %12s %12s\n", "n", "std::sort", "kernel", "bitonic", "odd-even");
+
+    BitonicSort bitonic_sort_algo;
+    OddEvenMergeSort odd_even_algo;
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+    std::vector<int> arr;
+    for (int size : sizes) {
+        fill_permutation(input, size, rng);
+
+        double std_sort_ms = 0.0;
+        for (int trial = 0; trial < trials; ++trial) {
+            arr = input;
+            const auto start = std::chrono::steady_clock::now();
+            std::sort(arr.begin(), arr.end());
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std_sort_ms = (trial == 0) ? ms : std::min(std_sort_ms, ms);
+        }
+
+        const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2};
+        for (SimdLevel level : levels) {
+            if ((int)level > (int)network_max_simd_level()) {
+                continue;
+            }
+            set_network_simd_level(level);
+            const double bitonic_ms = time_sort(bitonic_sort_algo, input, trials);
+            const double odd_even_ms = time_sort(odd_even_algo, input, trials);
+            std::printf("%10d %10.1f %12s %12.1f %12.1f\n", size, size / (std_sort_ms * 1000.0), simd_level_name(level),
+                size / (bitonic_ms * 1000.0), size / (odd_even_ms * 1000.0));
+        }
+    }
+    set_network_simd_level(network_max_simd_level());
+    return 0;
+}
+
+// Best wall time (ms) of the native Quick Sort or Merge Sort kernel with the given leaf stage
+template <typename T>
+static double time_leaf_kernel(bool merge, const std::vector<T>& input, LeafSort leaf, int threshold, int trials) {
+    double best_ms = 0.0;
+    std::vector<T> arr;
+    std::vector<T> buffer(input.size());
+    for (int trial = 0; trial < trials; ++trial) {
+        arr = input;
+        const auto start = std::chrono::steady_clock::now();
+        if (merge) {
+            merge_sort_bottom_up(arr.data(), buffer.data(), (int)arr.size(), leaf, threshold);
+        } else {
+            quick_sort_3way(arr.data(), (int)arr.size(), leaf, threshold);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        if (!std::is_sorted(arr.begin(), arr.end())) {
+            std::fprintf(stderr, "%s sort with %s leaves of %d left the array unsorted!\n", merge ? "Merge" : "Quick", leaf_sort_name(leaf), threshold);
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (trial == 0 || ms < best_ms) {
+            best_ms = ms;
+        }
+    }
+    return best_ms;
+}
+
+template <typename T>
+static void bench_leaf_type(const char* type_name, int size, int trials, std::mt19937& rng) {
+    const int thresholds[] = {2, 4, 6, 8, 12, 16, 20, 24, 32};
+    const LeafSort leaves[] = {LeafSort::Insertion, LeafSort::Network};
+
+    std::vector<T> input(size);
+    std::uniform_int_distribution<long long> dist(-1000000000LL, 1000000000LL);
+    for (T& value : input) {
+        value = (T)dist(rng);
+    }
+
+    std::printf("\n%s keys (ms)\n", type_name);
+    std::printf("%10s %14s %14s %14s %14s\n", "threshold", "quick/insert", "quick/network", "merge/insert", "merge/network");
+
+    double best_ms[4] = {0.0, 0.0, 0.0, 0.0};
+    int best_threshold[4] = {0, 0, 0, 0};
+    for (int threshold : thresholds) {
+        double ms[4];
+        for (int kernel = 0; kernel < 4; ++kernel) {
+            ms[kernel] = time_leaf_kernel(kernel >= 2, input, leaves[kernel % 2], threshold, trials);
+            if (best_threshold[kernel] == 0 || ms[kernel] < best_ms[kernel]) {
+                best_ms[kernel] = ms[kernel];
+                best_threshold[kernel] = threshold;
+            }
+        }
+        std::printf("%10d %14.2f %14.2f %14.2f %14.2f\n", threshold, ms[0], ms[1], ms[2], ms[3]);
+    }
+
+    for (int algo = 0; algo < 2; ++algo) {
+        const int kernel = (best_ms[2 * algo + 1] < best_ms[2 * algo]) ? (2 * algo + 1) : (2 * algo);
+        std::printf("Best %s leaf for %s: %s up to %d (%.2f ms)\n", (algo == 0) ? "Quick Sort" : "Merge Sort", type_name,
+            leaf_sort_name(leaves[kernel % 2]), best_threshold[kernel], best_ms[kernel]);
+    }
+}
+
+// The network leaves are branchless, so their payoff depends on how cheap a conditional move is for the key type
+static int bench_leaf(int argc, char** argv) {
+    const int size = std::max(2, arg_int(argc, argv, "--size", BENCH_SIZE * 10));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+
+    std::printf("Best of %d trials, n = %d\n", trials, size);
+    std::mt19937 rng(BENCH_SEED);
+    bench_leaf_type<int>("int32", size, trials, rng);
+    bench_leaf_type<long long>("int64", size, trials, rng);
+    bench_leaf_type<float>("float", size, trials, rng);
+    bench_leaf_type<double>("double", size, trials, rng);
+    return 0;
+}
+
+// The copy-back variant writes every merged element twice per pass, the ping-pong one once (plus a final copy on odd
+// pass counts), so the native kernel should gain most once the array no longer fits in cache
+static int bench_merge(int argc, char** argv) {
+    const int max_size = std::max(2, arg_int(argc, argv, "--max-size", 1 << 22));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+    const int max_stepped_size = 1 << 20;
+
+    std::printf("Best of %d trials on random permutations, writes per element (merge passes only)\n", trials);
+    std::printf("%10s %-24s %14s %14s %12s\n", "n", "algorithm", "stepped writes", "native writes", "ms");
+
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+    std::vector<int> arr;
+    std::vector<int> buffer;
+    for (int size = 1 << 10; size <= max_size; size *= 4) {
+        fill_permutation(input, size, rng);
+        buffer.resize(size);
+        for (int ping_pong = 0; ping_pong < 2; ++ping_pong) {
+            MergeSort algo(LeafSort::Insertion, DEFAULT_LEAF_THRESHOLD, ping_pong != 0);
+
+            // Stepping is slow, so the stepped counts stop at 2^20
+            double stepped_writes = -1.0;
+            if (size <= max_stepped_size) {
+                long long writes = 0;
+                arr = input;
+                algo.reset(size);
+                while (true) {
+                    const SortStepResult result = algo.step(arr);
+                    writes += result.write_count;
+                    if (result.done) {
+                        break;
+                    }
+                }
+                stepped_writes = (double)writes / size;
+            }
+
+            arr = input;
+            const long long native_writes = ping_pong ? merge_sort_ping_pong(arr.data(), buffer.data(), size, LeafSort::Insertion, DEFAULT_LEAF_THRESHOLD)
+                                                      : merge_sort_bottom_up(arr.data(), buffer.data(), size, LeafSort::Insertion, DEFAULT_LEAF_THRESHOLD);
+            const double ms = time_sort(algo, input, trials);
+
+            char stepped[32] = "-";
+            if (stepped_writes >= 0.0) {
+                std::snprintf(stepped, sizeof(stepped), "%.2f", stepped_writes);
+            }
+            std::printf("%10d %-24s %14s %14.2f %12.2f\n", size, algo.name(), stepped, (double)native_writes / size, ms);
+        }
+    }
+    return 0;
+}
+
+// The in-place sort trades the n-element buffer for an O(log n) merge stack and O(n log^2 n) element moves
+static int bench_in_place(int argc, char** argv) {
+    const int max_size = std::max(2, arg_int(argc, argv, "--max-size", 1 << 22));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+
+    std::printf("Best of %d trials on random permutations\n", trials);
+    std::printf("%10s %-36s %14s %12s\n", "n", "algorithm", "aux bytes", "ms");
+
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+    for (int size = 1 << 10; size <= max_size; size *= 4) {
+        fill_permutation(input, size, rng);
+
+        std::vector<std::unique_ptr<SortingAlgo>> algorithms;
+        algorithms.emplace_back(std::make_unique<MergeSort>());
+        algorithms.emplace_back(std::make_unique<MergeSort>(LeafSort::Insertion, DEFAULT_LEAF_THRESHOLD, true));
+        algorithms.emplace_back(std::make_unique<InPlaceMergeSort>());
+        algorithms.emplace_back(std::make_unique<BlockMergeSort>());
+        for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+            const double ms = time_sort(*algo, input, trials);
+            std::printf("%10d %-36s %14zu %12.2f\n", size, algo->name(), algo->aux_memory_bytes(), ms);
+        }
+    }
+    return 0;
+}
+
+// Wider heaps have fewer levels and keep all children of a node in one or two cache lines, bottom-up sifting saves
+// comparisons, and prefetching the grandchildren hides the miss of the next level once the heap outgrows the caches
+static int bench_heap(int argc, char** argv) {
+    const int max_size = std::max(2, arg_int(argc, argv, "--max-size", 1 << 22));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+
+    struct Variant {
+        int arity;
+        bool bottom_up;
+        bool prefetch;
+    };
+    const Variant variants[] = {
+        {2, false, false}, {2, true, false}, {2, true, true}, {4, false, true},
+        {4, true, false}, {4, true, true}, {8, true, false}, {8, true, true},
+    };
+
+    std::printf("Best of %d trials on random permutations\n", trials);
+    std::printf("%10s %10s %6s %10s %9s %12s %12s\n", "n", "KiB", "arity", "sift", "prefetch", "cmp/elem", "ns/elem");
+
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+    std::vector<int> arr;
+    for (int size = 1 << 10; size <= max_size; size *= 4) {
+        fill_permutation(input, size, rng);
+        for (const Variant& variant : variants) {
+            long long comparisons = 0;
+            double best_ms = 0.0;
+            for (int trial = 0; trial < trials; ++trial) {
+                arr = input;
+                const auto start = std::chrono::steady_clock::now();
+                comparisons = heap_sort(arr.data(), size, variant.arity, variant.bottom_up, variant.prefetch);
+                const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                best_ms = (trial == 0) ? ms : std::min(best_ms, ms);
+            }
+            if (!std::is_sorted(arr.begin(), arr.end())) {
+                std::fprintf(stderr, "%d-ary heap sort left the array unsorted!\n", variant.arity);
+            }
+
+            std::printf("%10d %10zu %6d %10s %9s %12.2f %12.2f\n", size, (size * sizeof(int)) / 1024, variant.arity,
+                variant.bottom_up ? "bottom-up" : "top-down", variant.prefetch ? "yes" : "no", (double)comparisons / size,
+                (best_ms * 1e6) / size);
+        }
+    }
+    return 0;
+}
+
+// Writes are what wears out flash or NVM cells and what costs most on slow memory, and a swap flag can't tell one
+// write from two, so every algorithm is stepped like the GUI does and ranked by the element writes it reports
+static int bench_writes(int argc, char** argv) {
+    const int size = std::max(2, arg_int(argc, argv, "--size", 1000));
+    const char* dist = arg_str(argc, argv, "--dist", "random");
+
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+    if (!fill_distribution(input, size, dist, rng)) {
+        std::fprintf(stderr, "Unknown distribution: %s\n", dist);
+        return 1;
+    }
+
+    const std::vector<std::unique_ptr<SortingAlgo>> algorithms = make_algorithms();
+
+    struct Row {
+        const SortingAlgo* algo;
+        SortRunTotals totals;
+    };
+    std::vector<Row> rows;
+    std::vector<int> arr;
+    for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+        arr = input;
+        const SortRunTotals totals = run_steps(*algo, arr);
+        if (!std::is_sorted(arr.begin(), arr.end())) {
+            std::fprintf(stderr, "%s left the array unsorted!\n", algo->name());
+        }
+        rows.push_back({algo.get(), totals});
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.totals.writes < b.totals.writes; });
+
+    std::printf("Stepped runs on %d %s keys, per element\n", size, dist);
+    std::printf("%4s %-40s %10s %10s %10s\n", "rank", "algorithm", "writes", "swaps", "compares");
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const SortRunTotals& totals = rows[i].totals;
+        std::printf("%4zu %-40s %10.2f %10.2f %10.2f\n", i + 1, rows[i].algo->name(), (double)totals.writes / size,
+            (double)totals.swaps / size, (double)totals.compares / size);
+    }
+    return 0;
+}
+
+// Sorts a key file too big for the budget: sorted runs of budget size, then a streamed k-way merge. Unless --input
+// names an existing file of int32 keys, a random one of --size keys is generated and removed afterwards.
+static int bench_external(int argc, char** argv) {
+    const int size = std::max(1, arg_int(argc, argv, "--size", 1 << 24));
+    const int budget_mib = std::max(1, arg_int(argc, argv, "--budget", 16));
+    const char* filter = arg_str(argc, argv, "--algo", "");
+    const char* input_path = arg_str(argc, argv, "--input", "");
+    const char* output_path = arg_str(argc, argv, "--out", "vsort_external.out");
+    const bool keep = (arg_int(argc, argv, "--keep", 0) != 0);
+
+    const bool generate = (*input_path == '\0');
+    const char* key_path = generate ? "vsort_external.keys" : input_path;
+    if (generate) {
+        FILE* file = std::fopen(key_path, "wb");
+        if (file == nullptr) {
+            std::fprintf(stderr, "Failed to create %s\n", key_path);
+            return 1;
+        }
+        std::mt19937 rng(BENCH_SEED);
+        std::vector<int> block;
+        for (int written = 0; written < size; written += (int)block.size()) {
+            block.resize(std::min(1 << 16, size - written));
+            for (int& key : block) {
+                key = (int)(rng() >> 1);
+            }
+            std::fwrite(block.data(), sizeof(int), block.size(), file);
+        }
+        std::fclose(file);
+    }
+
+    std::vector<std::unique_ptr<SortingAlgo>> algorithms;
+    algorithms.emplace_back(std::make_unique<QuickSort>());
+    algorithms.emplace_back(std::make_unique<MergeSort>());
+    algorithms.emplace_back(std::make_unique<DaryHeapSort>(4, true));
+    algorithms.emplace_back(std::make_unique<ParallelSampleSort>());
+
+    ExternalSortOptions options;
+    options.memory_budget = (size_t)budget_mib << 20;
+
+    // The fan-in is per algorithm, its aux memory comes out of the merge's share of the budget
+    std::printf("%s, budget %d MiB\n", key_path, budget_mib);
+    std::printf("%-32s %10s %6s %7s %7s %10s %10s %10s %9s %7s\n", "algorithm", "chunk", "runs", "fan-in", "passes", "peak MiB",
+        "runs ms", "merge ms", "MB/s", "sorted");
+
+    int status = 0;
+    for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+        if (std::strstr(algo->name(), filter) == nullptr) {
+            continue;
+        }
+
+        ExternalSortStats stats;
+        if (!external_sort(key_path, output_path, *algo, options, stats)) {
+            status = 1;
+            break;
+        }
+
+        // Stream the output back to check it
+        bool sorted = true;
+        long long count = 0;
+        FILE* file = std::fopen(output_path, "rb");
+        if (file != nullptr) {
+            std::vector<int> block(1 << 16);
+            int last = INT_MIN;
+            size_t read = 0;
+            while ((read = std::fread(block.data(), sizeof(int), block.size(), file)) > 0) {
+                for (size_t i = 0; i < read; ++i) {
+                    sorted = sorted && (last <= block[i]);
+                    last = block[i];
+                }
+                count += (long long)read;
+            }
+            std::fclose(file);
+        }
+        sorted = sorted && (count == stats.keys);
+
+        const double total_ms = stats.run_ms + stats.merge_ms;
+        std::printf("%-32s %10d %6d %7d %7d %10.2f %10.1f %10.1f %9.1f %7s\n", algo->name(), stats.chunk_keys, stats.runs,
+            stats.fan_in, stats.merge_passes, (double)stats.peak_bytes / (1 << 20), stats.run_ms, stats.merge_ms,
+            ((double)stats.keys * sizeof(int) / 1e6) / (total_ms / 1000.0), sorted ? "yes" : "NO");
+    }
+
+    if (!keep) {
+        std::remove(output_path);
+        if (generate) {
+            std::remove(key_path);
+        }
+    }
+    return status;
+}
+
+// Comparison counts don't explain wall time once the array leaves the caches, so every native run is wrapped in the
+// hardware counters. The comparisons come from a stepped run on the same input, like everywhere else in the bench.
+static int bench_perf(int argc, char** argv) {
+    const int max_size = std::max(2, arg_int(argc, argv, "--max-size", 1 << 20));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+    const char* filter = arg_str(argc, argv, "--algo", "");
+
+    PerfCounters counters;
+    if (!counters.available()) {
+        std::printf("Hardware counters unavailable (%s), showing time and comparisons only\n", counters.unavailable_reason());
+    }
+
+    std::vector<std::unique_ptr<SortingAlgo>> algorithms;
+    algorithms.emplace_back(std::make_unique<QuickSort>());
+    algorithms.emplace_back(std::make_unique<MergeSort>());
+    algorithms.emplace_back(std::make_unique<InPlaceMergeSort>());
+    algorithms.emplace_back(std::make_unique<BlockMergeSort>());
+    algorithms.emplace_back(std::make_unique<HeapSort>());
+    algorithms.emplace_back(std::make_unique<DaryHeapSort>(4, true));
+    algorithms.emplace_back(std::make_unique<ShellSort>());
+
+    std::printf("Best of %d trials on random permutations, counters of the best trial\n", trials);
+    std::printf("%10s %-32s %10s %10s %7s %12s %12s\n", "n", "algorithm", "ms", "cmp/elem", "IPC", "LLC miss/el", "br miss/cmp");
+
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+    std::vector<int> arr;
+    for (int size = 1 << 12; size <= max_size; size *= 16) {
+        fill_permutation(input, size, rng);
+        for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+            if (std::strstr(algo->name(), filter) == nullptr) {
+                continue;
+            }
+
+            arr = input;
+            const SortRunTotals totals = run_steps(*algo, arr);
+
+            double best_ms = 0.0;
+            PerfSample best;
+            for (int trial = 0; trial < trials; ++trial) {
+                arr = input;
+                counters.start();
+                const auto start = std::chrono::steady_clock::now();
+                algo->sort(arr);
+                const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                const PerfSample sample = counters.stop();
+                if (trial == 0 || ms < best_ms) {
+                    best_ms = ms;
+                    best = sample;
+                }
+            }
+            if (!std::is_sorted(arr.begin(), arr.end())) {
+                std::fprintf(stderr, "%s left the array unsorted!\n", algo->name());
+            }
+
+            char ipc[16] = "-";
+            char llc[16] = "-";
+            char branch[16] = "-";
+            if (best.has(PerfEvent::Cycles) && best.has(PerfEvent::Instructions) && best.get(PerfEvent::Cycles) > 0) {
+                std::snprintf(ipc, sizeof(ipc), "%.2f", (double)best.get(PerfEvent::Instructions) / best.get(PerfEvent::Cycles));
+            }
+            if (best.has(PerfEvent::LlcMisses)) {
+                std::snprintf(llc, sizeof(llc), "%.3f", (double)best.get(PerfEvent::LlcMisses) / size);
+            }
+            if (best.has(PerfEvent::BranchMisses) && totals.compares > 0) {
+                std::snprintf(branch, sizeof(branch), "%.3f", (double)best.get(PerfEvent::BranchMisses) / totals.compares);
+            }
+            std::printf("%10d %-32s %10.2f %10.2f %7s %12s %12s\n", size, algo->name(), best_ms, (double)totals.compares / size,
+                ipc, llc, branch);
+        }
+    }
+    return 0;
+}
+
+// Replays every access of the stepped runs, buffers included, through the cache model. Unlike perf, the numbers
+// only depend on the algorithm and the modelled hierarchy, not on the host CPU.
+static int bench_cache(int argc, char** argv) {
+    const int size = std::max(2, arg_int(argc, argv, "--size", 1 << 16));
+    const char* dist = arg_str(argc, argv, "--dist", "random");
+    const char* filter = arg_str(argc, argv, "--algo", "");
+
+    CacheConfig config = default_cache_config();
+    config.line_bytes = std::max(4, arg_int(argc, argv, "--line", config.line_bytes));
+    const char* levels = arg_str(argc, argv, "--cache", "");
+    if (*levels != '\0' && !parse_cache_levels(levels, config.levels)) {
+        std::fprintf(stderr, "Bad cache levels: %s (expected SIZE/WAYS,... e.g. 32K/8,1M/16)\n", levels);
+        return 1;
+    }
+
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+    if (!fill_distribution(input, size, dist, rng)) {
+        std::fprintf(stderr, "Unknown distribution: %s\n", dist);
+        return 1;
+    }
+
+    // The quadratic sorts are left out, their stepped runs take too long at cache-sized inputs (so is Parallel Sample
+    // Sort, whose stepped buckets are insertion sorted)
+    std::vector<std::unique_ptr<SortingAlgo>> algorithms;
+    algorithms.emplace_back(std::make_unique<CombSort>());
+    algorithms.emplace_back(std::make_unique<ShellSort>());
+    algorithms.emplace_back(std::make_unique<QuickSort>());
+    algorithms.emplace_back(std::make_unique<HeapSort>());
+    algorithms.emplace_back(std::make_unique<DaryHeapSort>(4, true));
+    algorithms.emplace_back(std::make_unique<MergeSort>());
+    algorithms.emplace_back(std::make_unique<MergeSort>(LeafSort::Insertion, DEFAULT_LEAF_THRESHOLD, true));
+    algorithms.emplace_back(std::make_unique<InPlaceMergeSort>());
+    algorithms.emplace_back(std::make_unique<BlockMergeSort>());
+    algorithms.emplace_back(std::make_unique<CountingSort>());
+    algorithms.emplace_back(std::make_unique<ParallelMergeSort>());
+    algorithms.emplace_back(std::make_unique<ParallelQuickSort>());
+    algorithms.emplace_back(std::make_unique<BitonicSort>());
+    algorithms.emplace_back(std::make_unique<OddEvenMergeSort>());
+
+    std::printf("Stepped runs on %d %s keys (%.1f KiB), %d B lines:", size, dist, (double)size * sizeof(int) / 1024.0, config.line_bytes);
+    for (size_t i = 0; i < config.levels.size(); ++i) {
+        const size_t bytes = config.levels[i].size_bytes;
+        if (bytes % 1024 == 0) {
+            std::printf(" L%zu %zu KiB %d-way", i + 1, bytes >> 10, config.levels[i].ways);
+        } else {
+            std::printf(" L%zu %zu B %d-way", i + 1, bytes, config.levels[i].ways);
+        }
+    }
+    std::printf("\n%-40s %10s", "algorithm", "acc/elem");
+    for (size_t i = 0; i < config.levels.size(); ++i) {
+        std::printf("   L%zu miss%% L%zu xfer/el", i + 1, i + 1);
+    }
+    std::printf("\n");
+
+    CacheSim cache(config);
+    AccessCounters counters; // No per-index counts, only the cache
+    counters.cache = &cache;
+    std::vector<int> arr;
+    for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+        if (std::strstr(algo->name(), filter) == nullptr) {
+            continue;
+        }
+
+        arr = input;
+        cache.reset();
+        algo->set_access_counters(&counters);
+        run_steps(*algo, arr);
+        algo->set_access_counters(nullptr);
+        if (!std::is_sorted(arr.begin(), arr.end())) {
+            std::fprintf(stderr, "%s left the array unsorted!\n", algo->name());
+        }
+
+        std::printf("%-40s %10.2f", algo->name(), (double)cache.accesses() / size);
+        for (int level = 0; level < cache.level_count(); ++level) {
+            const CacheLevelStats& stats = cache.stats(level);
+            std::printf("   %7.2f %10.3f", stats.miss_rate() * 100.0, (double)stats.transfers() / size);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
+// Times the stepped runs (the step() state machines the GUI drives) of every algorithm on every distribution. It is the
+// training workload of `make pgo`, which saves the -O2 times with --save and prints the gain with --baseline.
+static int bench_steps(int argc, char** argv) {
+    const int size = std::max(2, arg_int(argc, argv, "--size", 2000));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+    const char* save_path = arg_str(argc, argv, "--save", "");
+    const char* baseline_path = arg_str(argc, argv, "--baseline", "");
+    static const char* const DISTS[] = {"random", "few", "sorted", "reversed", "nearly"};
+
+    // Baseline lines are "ms<TAB>dist<TAB>algorithm", in the order the runs below are made
+    std::vector<double> baseline;
+    if (*baseline_path != '\0') {
+        FILE* file = std::fopen(baseline_path, "r");
+        if (file == nullptr) {
+            std::fprintf(stderr, "Failed to open %s\n", baseline_path);
+            return 1;
+        }
+        char line[256];
+        while (std::fgets(line, sizeof(line), file) != nullptr) {
+            baseline.push_back(std::strtod(line, nullptr));
+        }
+        std::fclose(file);
+    }
+    FILE* save = nullptr;
+    if (*save_path != '\0') {
+        save = std::fopen(save_path, "w");
+        if (save == nullptr) {
+            std::fprintf(stderr, "Failed to create %s\n", save_path);
+            return 1;
+        }
+    }
+
+    const std::vector<std::unique_ptr<SortingAlgo>> algorithms = make_algorithms();
+    std::printf("Stepped runs on %d keys, best of %d (ms)\n", size, trials);
+    std::printf("%-40s %-9s %10s", "algorithm", "dist", "ms");
+    if (!baseline.empty()) {
+        std::printf(" %10s %8s", "baseline", "gain");
+    }
+    std::printf("\n");
+
+    size_t run = 0;
+    double total_ms = 0.0;
+    double total_baseline_ms = 0.0;
+    double log_gain_sum = 0.0;
+    int gain_runs = 0;
+    std::vector<int> input;
+    std::vector<int> arr;
+    for (const char* dist : DISTS) {
+        std::mt19937 rng(BENCH_SEED);
+        fill_distribution(input, size, dist, rng);
+        for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+            double best_ms = 0.0;
+            for (int trial = 0; trial < trials; ++trial) {
+                arr = input;
+                const auto start = std::chrono::steady_clock::now();
+                run_steps(*algo, arr);
+                const auto end = std::chrono::steady_clock::now();
+                const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+                if (trial == 0 || ms < best_ms) {
+                    best_ms = ms;
+                }
+            }
+            if (!std::is_sorted(arr.begin(), arr.end())) {
+                std::fprintf(stderr, "%s left the array unsorted!\n", algo->name());
+            }
+
+            total_ms += best_ms;
+            std::printf("%-40s %-9s %10.3f", algo->name(), dist, best_ms);
+            if (run < baseline.size() && baseline[run] > 0.0 && best_ms > 0.0) {
+                const double gain = baseline[run] / best_ms;
+                total_baseline_ms += baseline[run];
+                log_gain_sum += std::log(gain);
+                ++gain_runs;
+                std::printf(" %10.3f %7.2fx", baseline[run], gain);
+            }
+            std::printf("\n");
+            if (save != nullptr) {
+                std::fprintf(save, "%.6f\t%s\t%s\n", best_ms, dist, algo->name());
+            }
+            ++run;
+        }
+    }
+
+    std::printf("\nTotal %.1f ms", total_ms);
+    if (gain_runs > 0) {
+        std::printf(", baseline %.1f ms: %.2fx overall, %.2fx geometric mean per run", total_baseline_ms,
+            total_baseline_ms / total_ms, std::exp(log_gain_sum / gain_runs));
+    }
+    std::printf("\n");
+    if (!baseline.empty() && baseline.size() != run) {
+        std::fprintf(stderr, "%s has %zu runs, expected %zu (different build or --size?)\n", baseline_path,
+            baseline.size(), run);
+    }
+    if (save != nullptr) {
+        std::fclose(save);
+        std::printf("Saved to %s\n", save_path);
+    }
+    return 0;
+}
+
+// Runs the fixed regression matrix (every algorithm's sort() on every distribution and size) with warmup and repeated
+// trials, and saves it as JSON. Against a --baseline run it flags the cases whose slowdown is significant and exits
+// with 2 if there are any, so it can gate changes to the algorithms. --compare diffs two saved runs without running.
+static int bench_suite(int argc, char** argv) {
+    const int trials = std::max(2, arg_int(argc, argv, "--trials", 10));
+    const int warmup = std::max(0, arg_int(argc, argv, "--warmup", 1));
+    const char* sizes_arg = arg_str(argc, argv, "--sizes", "1000,10000,100000");
+    const char* filter = arg_str(argc, argv, "--algo", "");
+    const char* out = arg_str(argc, argv, "--out", "vsort_bench.json");
+    const char* baseline_path = arg_str(argc, argv, "--baseline", "");
+    const char* compare_path = arg_str(argc, argv, "--compare", "");
+    const double threshold = std::max(0, arg_int(argc, argv, "--threshold", 10)) / 100.0;
+    static const char* const DISTS[] = {"random", "sorted", "reversed", "few", "nearly"};
+
+    BenchResults baseline;
+    if (*baseline_path != '\0' && !baseline.load_json(baseline_path)) {
+        std::fprintf(stderr, "Failed to read %s\n", baseline_path);
+        return 1;
+    }
+
+    BenchResults results;
+    if (*compare_path != '\0') {
+        if (!results.load_json(compare_path)) {
+            std::fprintf(stderr, "Failed to read %s\n", compare_path);
+            return 1;
+        }
+    } else {
+        std::vector<int> sizes;
+        for (const char* p = sizes_arg; *p != '\0';) {
+            char* end = nullptr;
+            const long size = std::strtol(p, &end, 10);
+            if (end == p || size < 2) {
+                std::fprintf(stderr, "Bad sizes: %s (expected N1,N2,...)\n", sizes_arg);
+                return 1;
+            }
+            sizes.push_back((int)size);
+            p = (*end == ',') ? end + 1 : end;
+        }
+
+        std::printf("Suite: %d trials after %d warmup run(s) per case\n", trials, warmup);
+        std::printf("%-40s %-9s %8s %10s %10s %10s\n", "algorithm", "dist", "size", "mean ms", "+-95%", "stddev");
+        const std::vector<std::unique_ptr<SortingAlgo>> algorithms = make_algorithms();
+        std::vector<int> input;
+        std::vector<int> arr;
+        for (int size : sizes) {
+            for (const char* dist : DISTS) {
+                std::mt19937 rng(BENCH_SEED);
+                fill_distribution(input, size, dist, rng);
+                for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+                    if (std::strstr(algo->name(), filter) == nullptr ||
+                        (is_quadratic(*algo) && size > SUITE_QUADRATIC_MAX_SIZE)) {
+                        continue;
+                    }
+
+                    std::vector<double> times_ms;
+                    for (int run = 0; run < warmup + trials; ++run) {
+                        arr = input;
+                        const auto start = std::chrono::steady_clock::now();
+                        algo->sort(arr);
+                        const auto end = std::chrono::steady_clock::now();
+                        if (run >= warmup) {
+                            times_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                        }
+                    }
+                    if (!std::is_sorted(arr.begin(), arr.end())) {
+                        std::fprintf(stderr, "%s left the array unsorted!\n", algo->name());
+                    }
+
+                    BenchCase bench_case;
+                    bench_case.algo = algo->name();
+                    bench_case.dist = dist;
+                    bench_case.size = size;
+                    bench_case.warmup = warmup;
+                    bench_case.stats = summarize_timings(times_ms);
+                    results.add(bench_case);
+                    std::printf("%-40s %-9s %8d %10.3f %10.3f %10.3f\n", algo->name(), dist, size,
+                        bench_case.stats.mean_ms, bench_case.stats.ci95_ms, bench_case.stats.stddev_ms);
+                }
+            }
+        }
+
+        if (!results.save_json(out)) {
+            std::fprintf(stderr, "Failed to write %s\n", out);
+            return 1;
+        }
+        std::printf("\nSaved to %s\n", out);
+    }
+
+    if (*baseline_path == '\0') {
+        return 0;
+    }
+
+    // Only the significant changes are listed, the rest is summarized by the counts
+    std::printf("\nAgainst %s (threshold %.0f%%, 95%% interval of the difference of means)\n", baseline_path,
+        threshold * 100.0);
+    std::printf("%-40s %-9s %8s %10s %10s %8s %22s\n", "algorithm", "dist", "size", "base ms", "ms", "ratio",
+        "diff interval ms");
+    int slower = 0;
+    int faster = 0;
+    int same = 0;
+    int missing = 0;
+    for (const BenchCase& current : results.cases()) {
+        const BenchCase* base = baseline.find(current.algo, current.dist, current.size);
+        if (base == nullptr) {
+            ++missing;
+            continue;
+        }
+        const BenchDiff diff = compare_timings(base->stats, current.stats, threshold);
+        if (diff.verdict == BenchVerdict::Same) {
+            ++same;
+            continue;
+        }
+        (diff.verdict == BenchVerdict::Slower) ? ++slower : ++faster;
+        std::printf("%-40s %-9s %8d %10.3f %10.3f %7.2fx [%9.3f, %9.3f] %s\n", current.algo.c_str(),
+            current.dist.c_str(), current.size, base->stats.mean_ms, current.stats.mean_ms, diff.ratio,
+            diff.diff_low_ms, diff.diff_high_ms, (diff.verdict == BenchVerdict::Slower) ? "SLOWER" : "faster");
+    }
+    std::printf("\n%d slower, %d faster, %d unchanged", slower, faster, same);
+    if (missing > 0) {
+        std::printf(", %d not in the baseline", missing);
+    }
+    std::printf("\n");
+    return (slower > 0) ? 2 : 0;
+}
+
+// Geometric size sweep of every algorithm: fitted growth of the comparisons, swaps and time (power-law exponent and the
+// closest standard model) and the sizes where the time per element jumps, i.e. where the array outgrows a cache level
+static int bench_sweep(int argc, char** argv) {
+    SweepOptions options;
+    options.min_size = std::max(2, arg_int(argc, argv, "--min", options.min_size));
+    options.max_size = std::max(options.min_size, arg_int(argc, argv, "--max", options.max_size));
+    options.factor = std::max(1.05, std::strtod(arg_str(argc, argv, "--factor", "2"), nullptr));
+    options.trials = std::max(1, arg_int(argc, argv, "--trials", options.trials));
+    options.max_ms = std::max(1, arg_int(argc, argv, "--max-ms", (int)options.max_ms));
+    options.count_max_size = arg_int(argc, argv, "--count-max", options.count_max_size);
+    const double jump = std::max(1, arg_int(argc, argv, "--jump", 25)) / 100.0;
+    const char* filter = arg_str(argc, argv, "--algo", "");
+    const char* csv_path = arg_str(argc, argv, "--csv", "vsort_sweep.csv");
+
+    print_host_caches();
+    std::printf("Sizes %d to %d (x%.2f), best of %d, counts up to %d, random permutations\n", options.min_size,
+        options.max_size, options.factor, options.trials, options.count_max_size);
+    std::printf("Columns: fitted power-law exponent / closest model, time per element jumps > %.0f%% (array size)\n\n",
+        jump * 100.0);
+    std::printf("%-40s %8s %18s %18s %18s  %s\n", "algorithm", "max n", "compares", "swaps", "time", "jumps");
+
+    std::vector<SweepSeries> series;
+    const std::vector<std::unique_ptr<SortingAlgo>> algorithms = make_algorithms();
+    for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+        if (std::strstr(algo->name(), filter) == nullptr) {
+            continue;
+        }
+        series.push_back({algo->name(), run_sweep(*algo, options, BENCH_SEED)});
+        const std::vector<SweepPoint>& points = series.back().points;
+
+        std::vector<double> sizes;
+        std::vector<double> compares;
+        std::vector<double> swaps;
+        std::vector<double> times;
+        for (const SweepPoint& point : points) {
+            sizes.push_back(point.size);
+            compares.push_back((double)point.compares);
+            swaps.push_back((double)point.swaps);
+            times.push_back(point.ms);
+        }
+
+        std::printf("%-40s %8d", algo->name(), points.back().size);
+        for (const std::vector<double>* values : {&compares, &swaps, &times}) {
+            const ComplexityFit fit = fit_complexity(sizes, *values);
+            char cell[32];
+            if (fit.points < 3) {
+                std::snprintf(cell, sizeof(cell), "-");
+            } else {
+                std::snprintf(cell, sizeof(cell), "%.2f / %s", fit.exponent, growth_model_name(fit.model));
+            }
+            std::printf(" %18s", cell);
+        }
+
+        // Jumps are measured against the model the comparisons follow, so the algorithm's own growth doesn't count
+        const ComplexityFit work = fit_complexity(sizes, compares);
+        const GrowthModel model = (work.points >= 3) ? work.model : GrowthModel::NLogN;
+        std::printf(" ");
+        for (int i : find_jumps(sizes, times, model, jump)) {
+            std::printf(" %s", format_bytes((double)points[i].size * sizeof(int)).c_str());
+        }
+        std::printf("\n");
+    }
+
+    if (!save_sweep_csv(csv_path, series)) {
+        std::fprintf(stderr, "Failed to write %s\n", csv_path);
+        return 1;
+    }
+    std::printf("\nSaved to %s\n", csv_path);
+    return 0;
+}
+
+// Comparisons and swaps come from stepping the algorithm like the GUI does, the time from its native kernel
+static int bench_gaps(int argc, char** argv) {
+    const int max_size = std::max(2, arg_int(argc, argv, "--max-size", 1 << 20));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS));
+    const char* custom = arg_str(argc, argv, "--custom", "");
+
+    std::vector<int> custom_gaps;
+    for (const char* gap = custom; *gap != '\0'; ++gap) {
+        if (gap == custom || *(gap - 1) == ',') {
+            custom_gaps.push_back(std::atoi(gap));
+        }
+    }
+
+    // Comb Sort only gets the sequences that shrink slowly enough, the others leave it bubbling with gap 1
+    struct Row {
+        bool comb;
+        GapSequence sequence;
+    };
+    std::vector<Row> rows = {
+        {false, GapSequence::Ciura}, {false, GapSequence::Tokuda}, {false, GapSequence::Sedgewick},
+        {false, GapSequence::Pratt}, {false, GapSequence::Hibbard}, {true, GapSequence::Shrink},
+    };
+    if (!custom_gaps.empty()) {
+        rows.push_back({false, GapSequence::Custom});
+    }
+
+    std::printf("Best of %d trials on random permutations, comparisons and swaps per element\n", trials);
+    std::printf("%10s %-28s %10s %10s %10s %12s\n", "n", "algorithm", "gaps", "compares", "swaps", "ms");
+
+    std::mt19937 rng(BENCH_SEED);
+    std::vector<int> input;
+    std::vector<int> arr;
+    for (int size = 1 << 10; size <= max_size; size *= 8) {
+        fill_permutation(input, size, rng);
+        for (const Row& row : rows) {
+            std::unique_ptr<SortingAlgo> algo;
+            GapSequenceEngine* engine = nullptr;
+            if (row.comb) {
+                auto comb = std::make_unique<CombSort>(row.sequence);
+                engine = &comb->gap_engine();
+                algo = std::move(comb);
+            } else {
+                auto shell = std::make_unique<ShellSort>(row.sequence);
+                engine = &shell->gap_engine();
+                algo = std::move(shell);
+            }
+            engine->set_custom(custom_gaps);
+
+            arr = input;
+            const SortRunTotals totals = run_steps(*algo, arr);
+
+            const double ms = time_sort(*algo, input, trials);
+            std::printf("%10d %-28s %10d %10.2f %10.2f %12.2f\n", size, algo->name(), (int)engine->gaps(size).size(),
+                (double)totals.compares / size, (double)totals.swaps / size, ms);
+        }
+    }
+    return 0;
+}
+
+// Exhaustive grid over each algorithm's parameters (they are few and coarse), keeping the fastest configuration
+static int bench_tune(int argc, char** argv) {
+    const int size = std::max(2, arg_int(argc, argv, "--size", BENCH_SIZE));
+    const int trials = std::max(1, arg_int(argc, argv, "--trials", BENCH_TRIALS + 2));
+    const char* dist = arg_str(argc, argv, "--dist", "random");
+    const char* filter = arg_str(argc, argv, "--algo", "");
+    const char* out = arg_str(argc, argv, "--out", TUNING_FILE);
+
+    std::vector<int> input;
+    std::mt19937 rng(BENCH_SEED);
+    if (!fill_distribution(input, size, dist, rng)) {
+        std::fprintf(stderr, "Unknown distribution: %s\n", dist);
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<SortingAlgo>> algorithms;
+    algorithms.emplace_back(std::make_unique<QuickSort>());
+    algorithms.emplace_back(std::make_unique<MergeSort>());
+    algorithms.emplace_back(std::make_unique<CombSort>());
+    algorithms.emplace_back(std::make_unique<ShellSort>());
+
+    // Earlier results for other sizes and key types are kept
+    TuningTable table;
+    table.load(out);
+
+    std::printf("Best of %d trials, n = %d (size class 2^%d), %s input\n", trials, size, tuning_size_class(size), dist);
+    for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+        const std::string key = algo->name();
+        if (std::strstr(key.c_str(), filter) == nullptr) {
+            continue;
+        }
+
+        std::vector<AlgoParam> params = algo->params();
+        std::vector<AlgoParam> best = params;
+        const double default_ms = time_sort(*algo, input, trials);
+        double best_ms = default_ms;
+        int configs = 0;
+
+        // Odometer over the parameter grid, the first parameter changing slowest
+        std::vector<int> index(params.size(), 0);
+        while (true) {
+            for (size_t p = 0; p < params.size(); ++p) {
+                params[p].value = params[p].min + (index[p] * params[p].step);
+                algo->set_param(params[p].name, params[p].value);
+            }
+
+            const double ms = time_sort(*algo, input, trials);
+            ++configs;
+            if (ms < best_ms) {
+                best_ms = ms;
+                best = params;
+            }
+
+            int p = (int)params.size() - 1;
+            for (; p >= 0; --p) {
+                if (params[p].min + ((index[p] + 1) * params[p].step) <= params[p].max + (params[p].step * 0.5)) {
+                    ++index[p];
+                    break;
+                }
+                index[p] = 0;
+            }
+            if (p < 0) {
+                break;
+            }
+        }
+
+        for (const AlgoParam& param : best) {
+            algo->set_param(param.name, param.value);
+        }
+        table.store(key.c_str(), "int32", size, best);
+
+        std::printf("\n%s: %d configurations, default %.2f ms, best %.2f ms (%.2fx) with", key.c_str(), configs, default_ms, best_ms,
+            default_ms / best_ms);
+        for (const AlgoParam& param : best) {
+            std::printf(" %s=%g", param.name, param.value);
+        }
+        std::printf("\n");
+    }
+
+    if (!table.save(out)) {
+        std::fprintf(stderr, "Failed to write %s\n", out);
+        return 1;
+    }
+    std::printf("\nSaved to %s\n", out);
+    return 0;
+}
+
+static int arg_int(int argc, char** argv, const char* flag, int fallback) {
+    for (int i = 0; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], flag) == 0) {
+            return std::atoi(argv[i + 1]);
+        }
+    }
+    return fallback;
+}
+
+static const char* arg_str(int argc, char** argv, const char* flag, const char* fallback) {
+    for (int i = 0; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], flag) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return fallback;
+}
+
+// Runs the algorithm's sort() (native kernel or stepped to completion) and returns the best wall time (ms) over the trials
+static double time_sort(SortingAlgo& algo, const std::vector<int>& input, int trials) {
+    double best_ms = 0.0;
+    std::vector<int> arr;
+    for (int trial = 0; trial < trials; ++trial) {
+        arr = input;
+        const auto start = std::chrono::steady_clock::now();
+        algo.sort(arr);
+        const auto end = std::chrono::steady_clock::now();
+
+        if (!std::is_sorted(arr.begin(), arr.end())) {
+            std::fprintf(stderr, "%s left the array unsorted!\n", algo.name());
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (trial == 0 || ms < best_ms) {
+            best_ms = ms;
+        }
+    }
+    return best_ms;
+}
+
+// Best time of counting_sort_stable() over the keys carrying their input index, which must stay ascending per key
+static double time_pairs(const std::vector<int>& input, int trials) {
+    double best_ms = 0.0;
+    std::vector<int> keys;
+    std::vector<int> values(input.size());
+    for (int trial = 0; trial < trials; ++trial) {
+        keys = input;
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = (int)i;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        counting_sort_stable(keys, values);
+        const auto end = std::chrono::steady_clock::now();
+
+        for (size_t i = 1; i < keys.size(); ++i) {
+            if (keys[i - 1] > keys[i] || (keys[i - 1] == keys[i] && values[i - 1] > values[i])) {
+                std::fprintf(stderr, "counting_sort_stable() left the pairs unsorted or unstable!\n");
+                break;
+            }
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (trial == 0 || ms < best_ms) {
+            best_ms = ms;
+        }
+    }
+    return best_ms;
+}
+
+// One instance of every algorithm and variant the GUI steps through
+static bool is_quadratic(const SortingAlgo& algo) {
+    return dynamic_cast<const BubbleSort*>(&algo) != nullptr || dynamic_cast<const SelectionSort*>(&algo) != nullptr ||
+        dynamic_cast<const CycleSort*>(&algo) != nullptr || dynamic_cast<const InsertionSort*>(&algo) != nullptr ||
+        dynamic_cast<const CocktailSort*>(&algo) != nullptr;
+}
+
+// Bytes in B, KiB or MiB, whichever reads best
+static std::string format_bytes(double bytes) {
+    char text[32];
+    if (bytes >= 1024.0 * 1024.0) {
+        std::snprintf(text, sizeof(text), "%.3g MiB", bytes / (1024.0 * 1024.0));
+    } else if (bytes >= 1024.0) {
+        std::snprintf(text, sizeof(text), "%.3g KiB", bytes / 1024.0);
+    } else {
+        std::snprintf(text, sizeof(text), "%.0f B", bytes);
+    }
+    return text;
+}
+
+static void print_host_caches() {
+    CacheConfig host;
+    if (!host_cache_config(host)) {
+        std::printf("Host caches: unknown\n");
+        return;
+    }
+    std::printf("Host caches:");
+    for (size_t i = 0; i < host.levels.size(); ++i) {
+        std::printf(" L%zu %s %d-way", i + 1, format_bytes((double)host.levels[i].size_bytes).c_str(), host.levels[i].ways);
+    }
+    std::printf(", %d B lines\n", host.line_bytes);
+}
+
+// 1, 2, 4, ... up to max_threads, always ending with max_threads itself
+static std::vector<int> thread_counts(int max_threads) {
+    std::vector<int> counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
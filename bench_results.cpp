@@ -0,0 +1,187 @@
+#include <algorithm> // std::sort()
+#include <cmath> // std::sqrt(), std::floor()
+#include <cstdio> // std::fopen(), std::fprintf()
+#include <cstdlib> // std::strtod()
+#include <fstream> // std::ifstream
+#include "bench_results.h"
+#include "json_util.h"
+
+namespace {
+
+// Position just past `"key":` and any spaces, npos if the line has no such key
+size_t find_value(const std::string& line, const char* key) {
+    const std::string quoted = std::string("\"") + key + "\":";
+    size_t pos = line.find(quoted);
+    if (pos == std::string::npos) {
+        return pos;
+    }
+    pos += quoted.size();
+    while (pos < line.size() && line[pos] == ' ') {
+        ++pos;
+    }
+    return pos;
+}
+
+bool read_string(const std::string& line, const char* key, std::string& value) {
+    size_t pos = find_value(line, key);
+    return pos != std::string::npos && read_json_string(line, pos, value);
+}
+
+bool read_number(const std::string& line, const char* key, double& value) {
+    const size_t pos = find_value(line, key);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    const char* start = line.c_str() + pos;
+    char* end = nullptr;
+    value = std::strtod(start, &end);
+    return end != start;
+}
+
+} // namespace
+
+TimingStats summarize_timings(std::vector<double> times_ms) {
+    TimingStats stats;
+    stats.trials = (int)times_ms.size();
+    if (times_ms.empty()) {
+        return stats;
+    }
+
+    std::sort(times_ms.begin(), times_ms.end());
+    const size_t n = times_ms.size();
+    stats.min_ms = times_ms[0];
+    stats.median_ms = (n % 2 == 1) ? times_ms[n / 2] : 0.5 * (times_ms[n / 2 - 1] + times_ms[n / 2]);
+
+    double sum = 0.0;
+    for (double ms : times_ms) {
+        sum += ms;
+    }
+    stats.mean_ms = sum / (double)n;
+    if (n > 1) {
+        double squares = 0.0;
+        for (double ms : times_ms) {
+            squares += (ms - stats.mean_ms) * (ms - stats.mean_ms);
+        }
+        stats.stddev_ms = std::sqrt(squares / (double)(n - 1));
+        stats.ci95_ms = student_t95((double)(n - 1)) * stats.stddev_ms / std::sqrt((double)n);
+    }
+    return stats;
+}
+
+double student_t95(double dof) {
+    static const double TABLE[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179,
+        2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048,
+        2.045, 2.042};
+    const int table_size = (int)(sizeof(TABLE) / sizeof(TABLE[0]));
+    // Rounding the degrees of freedom down errs on the wide side
+    const int whole = (int)std::floor(dof);
+    if (whole < 1) {
+        return TABLE[0];
+    }
+    if (whole <= table_size) {
+        return TABLE[whole - 1];
+    }
+    // Within 0.002 of the exact value past 30 degrees of freedom
+    return 1.960 + 2.4 / (double)whole;
+}
+
+BenchDiff compare_timings(const TimingStats& baseline, const TimingStats& current, double threshold) {
+    BenchDiff diff;
+    if (baseline.mean_ms <= 0.0 || baseline.trials < 2 || current.trials < 2) {
+        return diff;
+    }
+    diff.ratio = current.mean_ms / baseline.mean_ms;
+
+    // Welch's interval: the two runs may have different variances and trial counts
+    const double var_base = baseline.stddev_ms * baseline.stddev_ms / baseline.trials;
+    const double var_current = current.stddev_ms * current.stddev_ms / current.trials;
+    const double se = std::sqrt(var_base + var_current);
+    double dof = 1.0;
+    if (se > 0.0) {
+        dof = (var_base + var_current) * (var_base + var_current) /
+            (var_base * var_base / (baseline.trials - 1) + var_current * var_current / (current.trials - 1));
+    }
+    const double delta = current.mean_ms - baseline.mean_ms;
+    const double half = student_t95(dof) * se;
+    diff.diff_low_ms = delta - half;
+    diff.diff_high_ms = delta + half;
+
+    const double margin = threshold * baseline.mean_ms;
+    if (diff.diff_low_ms > margin) {
+        diff.verdict = BenchVerdict::Slower;
+    } else if (diff.diff_high_ms < -margin) {
+        diff.verdict = BenchVerdict::Faster;
+    }
+    return diff;
+}
+
+bool BenchResults::load_json(const char* path) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    m_cases.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        BenchCase bench_case;
+        double size = 0.0;
+        double warmup = 0.0;
+        double trials = 0.0;
+        TimingStats& stats = bench_case.stats;
+        if (!read_string(line, "algo", bench_case.algo)) {
+            continue;
+        }
+        if (!read_string(line, "dist", bench_case.dist) || !read_number(line, "size", size) ||
+            !read_number(line, "trials", trials) || !read_number(line, "mean_ms", stats.mean_ms) ||
+            !read_number(line, "stddev_ms", stats.stddev_ms)) {
+            std::fprintf(stderr, "Skipping malformed benchmark case: %s\n", line.c_str());
+            continue;
+        }
+        read_number(line, "warmup", warmup);
+        read_number(line, "median_ms", stats.median_ms);
+        read_number(line, "min_ms", stats.min_ms);
+        read_number(line, "ci95_ms", stats.ci95_ms);
+        bench_case.size = (int)size;
+        bench_case.warmup = (int)warmup;
+        stats.trials = (int)trials;
+        m_cases.push_back(bench_case);
+    }
+    return true;
+}
+
+bool BenchResults::save_json(const char* path) const {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::fprintf(file, "{\"cases\": [\n");
+    for (size_t i = 0; i < m_cases.size(); ++i) {
+        const BenchCase& bench_case = m_cases[i];
+        const TimingStats& stats = bench_case.stats;
+        std::fprintf(file, "{\"algo\": ");
+        write_json_string(file, bench_case.algo);
+        std::fprintf(file, ", \"dist\": ");
+        write_json_string(file, bench_case.dist);
+        std::fprintf(file, ", \"size\": %d, \"warmup\": %d, \"trials\": %d, \"mean_ms\": %.6f, \"stddev_ms\": %.6f, "
+            "\"median_ms\": %.6f, \"min_ms\": %.6f, \"ci95_ms\": %.6f}%s\n", bench_case.size, bench_case.warmup,
+            stats.trials, stats.mean_ms, stats.stddev_ms, stats.median_ms, stats.min_ms, stats.ci95_ms,
+            (i + 1 < m_cases.size()) ? "," : "");
+    }
+    std::fprintf(file, "]}\n");
+    return std::fclose(file) == 0;
+}
+
+void BenchResults::add(const BenchCase& bench_case) {
+    m_cases.push_back(bench_case);
+}
+
+const BenchCase* BenchResults::find(const std::string& algo, const std::string& dist, int size) const {
+    for (const BenchCase& bench_case : m_cases) {
+        if (bench_case.algo == algo && bench_case.dist == dist && bench_case.size == size) {
+            return &bench_case;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string> // std::string
+#include <vector> // std::vector
+
+// Summary of the repeated wall times (ms) of one benchmark case
+struct TimingStats {
+    int trials = 0;
+    double mean_ms = 0.0;
+    double stddev_ms = 0.0; // Sample standard deviation
+    double median_ms = 0.0;
+    double min_ms = 0.0;
+    double ci95_ms = 0.0; // Half-width of the 95% confidence interval of the mean (Student's t)
+};
+
+TimingStats summarize_timings(std::vector<double> times_ms);
+
+// Two-sided 95% critical value of Student's t distribution with dof degrees of freedom
+double student_t95(double dof);
+
+struct BenchCase {
+    std::string algo;
+    std::string dist;
+    int size = 0;
+    int warmup = 0; // Untimed runs before the trials
+    TimingStats stats;
+};
+
+enum class BenchVerdict {
+    Same, // The difference is within noise or under the threshold
+    Faster,
+    Slower,
+};
+
+struct BenchDiff {
+    double ratio = 1.0; // Current mean over baseline mean
+    double diff_low_ms = 0.0; // 95% interval of current minus baseline mean (Welch)
+    double diff_high_ms = 0.0;
+    BenchVerdict verdict = BenchVerdict::Same;
+};
+
+// A case is Slower (Faster) only when the whole interval of the difference lies beyond threshold (a fraction of the
+// baseline mean, e.g. 0.05) above (below) zero, so noisy cases need a bigger change to be flagged
+BenchDiff compare_timings(const TimingStats& baseline, const TimingStats& current, double threshold);
+
+// A benchmark run: one case per algorithm, distribution and size. Stored as JSON with one case object per line, which
+// is also the only layout load_json() reads back.
+class BenchResults {
+public:
+    bool load_json(const char* path);
+    bool save_json(const char* path) const;
+
+    void add(const BenchCase& bench_case);
+    // Null when the run has no such case
+    const BenchCase* find(const std::string& algo, const std::string& dist, int size) const;
+
+    const std::vector<BenchCase>& cases() const {
+        return m_cases;
+    }
+
+private:
+    std::vector<BenchCase> m_cases;
+};
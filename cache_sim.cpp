@@ -0,0 +1,129 @@
+#include <algorithm> // std::max()
+#include <cstdlib> // std::strtoull(), std::strtol()
+#include "cache_sim.h"
+
+#ifdef __linux__
+#include <unistd.h> // sysconf()
+#endif
+
+CacheConfig default_cache_config() {
+    CacheConfig config;
+    config.line_bytes = 64;
+    config.levels = {{32 << 10, 8}, {1 << 20, 16}, {8 << 20, 16}};
+    return config;
+}
+
+bool host_cache_config(CacheConfig& config) {
+    config.levels.clear();
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    const int names[][2] = {
+        {_SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL1_DCACHE_ASSOC},
+        {_SC_LEVEL2_CACHE_SIZE, _SC_LEVEL2_CACHE_ASSOC},
+        {_SC_LEVEL3_CACHE_SIZE, _SC_LEVEL3_CACHE_ASSOC},
+    };
+    for (const int* name : names) {
+        const long size = sysconf(name[0]);
+        if (size <= 0) {
+            break;
+        }
+        config.levels.push_back({(size_t)size, std::max(1, (int)sysconf(name[1]))});
+    }
+    const long line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    config.line_bytes = (line > 0) ? (int)line : 64;
+#endif
+    return !config.levels.empty();
+}
+
+bool parse_cache_levels(const char* spec, std::vector<CacheLevelConfig>& levels) {
+    levels.clear();
+    const char* p = spec;
+    while (*p != '\0') {
+        char* end = nullptr;
+        CacheLevelConfig level;
+        level.size_bytes = (size_t)std::strtoull(p, &end, 10);
+        if (end == p) {
+            return false;
+        }
+        if (*end == 'K' || *end == 'k') {
+            level.size_bytes <<= 10;
+            ++end;
+        } else if (*end == 'M' || *end == 'm') {
+            level.size_bytes <<= 20;
+            ++end;
+        }
+        if (*end != '/') {
+            return false;
+        }
+        p = end + 1;
+        level.ways = (int)std::strtol(p, &end, 10);
+        if (end == p || level.size_bytes == 0 || level.ways <= 0) {
+            return false;
+        }
+        levels.push_back(level);
+
+        p = end;
+        if (*p == ',') {
+            ++p;
+        } else if (*p != '\0') {
+            return false;
+        }
+    }
+    return !levels.empty();
+}
+
+CacheSim::CacheSim(const CacheConfig& config) : m_config(config) {
+    m_config.line_bytes = std::max(1, m_config.line_bytes);
+    for (const CacheLevelConfig& level_config : m_config.levels) {
+        Level level;
+        level.ways = std::max(1, level_config.ways);
+        level.sets = std::max<int>(1, (int)(level_config.size_bytes / ((size_t)m_config.line_bytes * level.ways)));
+        level.slots.resize((size_t)level.sets * level.ways);
+        m_levels.push_back(level);
+    }
+}
+
+void CacheSim::reset() {
+    for (Level& level : m_levels) {
+        std::fill(level.slots.begin(), level.slots.end(), Way());
+        level.stats = CacheLevelStats();
+    }
+    m_clock = 0;
+    m_accesses = 0;
+}
+
+void CacheSim::access(uint64_t address, bool write) {
+    ++m_accesses;
+    const uint64_t line = address / (uint64_t)m_config.line_bytes;
+    for (Level& level : m_levels) {
+        if (touch(level, line, write)) {
+            return;
+        }
+    }
+}
+
+bool CacheSim::touch(Level& level, uint64_t line, bool write) {
+    ++m_clock;
+    Way* set = &level.slots[(size_t)(line % (uint64_t)level.sets) * level.ways];
+    Way* victim = set;
+    for (int w = 0; w < level.ways; ++w) {
+        Way& way = set[w];
+        if (way.last_use != 0 && way.line == line) {
+            way.last_use = m_clock;
+            way.dirty = way.dirty || write;
+            ++level.stats.hits;
+            return true;
+        }
+        if (way.last_use < victim->last_use) {
+            victim = &way;
+        }
+    }
+
+    ++level.stats.misses;
+    if (victim->last_use != 0 && victim->dirty) {
+        ++level.stats.writebacks;
+    }
+    victim->line = line;
+    victim->last_use = m_clock;
+    victim->dirty = write;
+    return false;
+}
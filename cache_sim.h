@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <vector> // std::vector
+
+struct CacheLevelConfig {
+    size_t size_bytes = 0;
+    int ways = 1;
+};
+
+struct CacheConfig {
+    int line_bytes = 64;
+    std::vector<CacheLevelConfig> levels; // L1 first
+};
+
+// A typical desktop hierarchy: 32 KiB 8-way L1, 1 MiB 16-way L2, 8 MiB 16-way L3, 64 B lines
+CacheConfig default_cache_config();
+
+// The host's data cache levels as the C library reports them (Linux/glibc), false when it doesn't
+bool host_cache_config(CacheConfig& config);
+
+// Levels as comma-separated SIZE/WAYS with an optional K or M suffix (e.g. "32K/8,1M/16,8M/16"), false if malformed
+bool parse_cache_levels(const char* spec, std::vector<CacheLevelConfig>& levels);
+
+struct CacheLevelStats {
+    long long hits = 0;
+    long long misses = 0;
+    long long writebacks = 0; // Dirty lines evicted
+
+    double miss_rate() const {
+        return (hits + misses > 0) ? (double)misses / (double)(hits + misses) : 0.0;
+    }
+    // Lines moved between this level and the next one down
+    long long transfers() const {
+        return misses + writebacks;
+    }
+};
+
+// Deterministic model of a multi-level set-associative LRU cache, write-allocate and write-back. An access walks down
+// the levels until one hits and fills the line into every level that missed. Dirty evictions are counted as
+// writebacks but not replayed into the level below, so the lower levels see demand traffic only.
+class CacheSim {
+public:
+    explicit CacheSim(const CacheConfig& config);
+
+    void access(uint64_t address, bool write);
+    void reset();
+
+    const CacheConfig& config() const {
+        return m_config;
+    }
+    int level_count() const {
+        return (int)m_levels.size();
+    }
+    const CacheLevelStats& stats(int level) const {
+        return m_levels[level].stats;
+    }
+    long long accesses() const {
+        return m_accesses;
+    }
+
+private:
+    struct Way {
+        uint64_t line = 0;
+        uint64_t last_use = 0; // 0 for an empty way
+        bool dirty = false;
+    };
+
+    struct Level {
+        int sets = 1;
+        int ways = 1;
+        std::vector<Way> slots; // sets * ways, one set after the other
+        CacheLevelStats stats;
+    };
+
+    // True on a hit. A miss replaces the least recently used way of the set.
+    bool touch(Level& level, uint64_t line, bool write);
+
+    CacheConfig m_config;
+    std::vector<Level> m_levels;
+    uint64_t m_clock = 0;
+    long long m_accesses = 0;
+};
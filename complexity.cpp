@@ -0,0 +1,202 @@
+#include <algorithm> // std::is_sorted()
+#include <chrono> // std::chrono::steady_clock
+#include <cmath> // std::log(), std::log2(), std::sqrt(), std::exp()
+#include <cstdio> // std::fopen(), std::fprintf()
+#include <random> // std::mt19937
+#include "complexity.h"
+#include "input_gen.h"
+
+namespace {
+
+// Wall time (ms) of one call
+template <typename F>
+double time_ms(F&& run) {
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Mean log residual of values against the model is its least-squares log coefficient, the RMS around it the fit error
+void fit_model(const std::vector<double>& n, const std::vector<double>& log_y, GrowthModel model, double& log_coefficient,
+    double& rms) {
+    const size_t count = n.size();
+    log_coefficient = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        log_coefficient += log_y[i] - std::log(growth_model_value(model, n[i]));
+    }
+    log_coefficient /= (double)count;
+    double squares = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        const double residual = log_y[i] - std::log(growth_model_value(model, n[i])) - log_coefficient;
+        squares += residual * residual;
+    }
+    rms = std::sqrt(squares / (double)count);
+}
+
+} // namespace
+
+std::vector<SweepPoint> run_sweep(SortingAlgo& algo, const SweepOptions& options, unsigned int seed) {
+    std::vector<SweepPoint> points;
+    std::vector<int> arr;
+    const double factor = std::max(1.01, options.factor);
+    int previous = 0;
+    bool counting = true;
+    for (double next = std::max(2, options.min_size); next <= (double)options.max_size + 0.5; next *= factor) {
+        const int size = (int)(next + 0.5);
+        if (size == previous) {
+            continue;
+        }
+        previous = size;
+
+        // A fresh permutation per run, the branch predictor would learn a small input that is sorted over and over
+        std::mt19937 rng(seed);
+        SweepPoint point;
+        point.size = size;
+        if (counting && size <= options.count_max_size) {
+            fill_permutation(arr, size, rng);
+            SortRunTotals totals;
+            counting = time_ms([&]() { totals = run_steps(algo, arr); }) <= options.max_ms;
+            point.compares = totals.compares;
+            point.swaps = totals.swaps;
+            point.writes = totals.writes;
+        }
+        for (int trial = 0; trial < std::max(1, options.trials); ++trial) {
+            fill_permutation(arr, size, rng);
+            const double ms = time_ms([&]() { algo.sort(arr); });
+            if (trial == 0 || ms < point.ms) {
+                point.ms = ms;
+            }
+            if (!std::is_sorted(arr.begin(), arr.end())) {
+                std::fprintf(stderr, "%s left the array unsorted!\n", algo.name());
+            }
+        }
+        points.push_back(point);
+
+        if (point.ms > options.max_ms) {
+            break;
+        }
+    }
+    return points;
+}
+
+bool save_sweep_csv(const char* path, const std::vector<SweepSeries>& series) {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::fprintf(file, "algorithm,size,bytes,ms,ns_per_element,compares,swaps,writes\n");
+    for (const SweepSeries& entry : series) {
+        for (const SweepPoint& point : entry.points) {
+            // Names have no commas but may gain one, quoting keeps the columns intact
+            std::fprintf(file, "\"%s\",%d,%zu,%.6f,%.3f,", entry.algo.c_str(), point.size, (size_t)point.size * sizeof(int),
+                point.ms, point.ms * 1e6 / point.size);
+            if (point.compares >= 0) {
+                std::fprintf(file, "%lld,%lld,%lld\n", point.compares, point.swaps, point.writes);
+            } else {
+                std::fprintf(file, ",,\n");
+            }
+        }
+    }
+    return std::fclose(file) == 0;
+}
+
+const char* growth_model_name(GrowthModel model) {
+    switch (model) {
+    case GrowthModel::Linear:
+        return "n";
+    case GrowthModel::NLogN:
+        return "n log n";
+    case GrowthModel::N1_5:
+        return "n^1.5";
+    case GrowthModel::NLog2N:
+        return "n log^2 n";
+    case GrowthModel::Quadratic:
+        return "n^2";
+    }
+    return "?";
+}
+
+double growth_model_value(GrowthModel model, double n) {
+    const double log_n = std::log2(std::max(2.0, n));
+    switch (model) {
+    case GrowthModel::Linear:
+        return n;
+    case GrowthModel::NLogN:
+        return n * log_n;
+    case GrowthModel::N1_5:
+        return n * std::sqrt(n);
+    case GrowthModel::NLog2N:
+        return n * log_n * log_n;
+    case GrowthModel::Quadratic:
+        return n * n;
+    }
+    return n;
+}
+
+ComplexityFit fit_complexity(const std::vector<double>& sizes, const std::vector<double>& values) {
+    ComplexityFit fit;
+    std::vector<double> n;
+    std::vector<double> log_n;
+    std::vector<double> log_y;
+    for (size_t i = 0; i < sizes.size() && i < values.size(); ++i) {
+        if (sizes[i] > 1.0 && values[i] > 0.0) {
+            n.push_back(sizes[i]);
+            log_n.push_back(std::log(sizes[i]));
+            log_y.push_back(std::log(values[i]));
+        }
+    }
+    fit.points = (int)n.size();
+    if (fit.points < 3) {
+        return fit;
+    }
+
+    // Ordinary least squares of log y on log n
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    for (int i = 0; i < fit.points; ++i) {
+        mean_x += log_n[i];
+        mean_y += log_y[i];
+    }
+    mean_x /= fit.points;
+    mean_y /= fit.points;
+    double sxy = 0.0;
+    double sxx = 0.0;
+    for (int i = 0; i < fit.points; ++i) {
+        sxy += (log_n[i] - mean_x) * (log_y[i] - mean_y);
+        sxx += (log_n[i] - mean_x) * (log_n[i] - mean_x);
+    }
+    fit.exponent = (sxx > 0.0) ? sxy / sxx : 0.0;
+
+    double log_coefficient = 0.0;
+    fit_model(n, log_y, GrowthModel::NLogN, log_coefficient, fit.nlogn_rms);
+    fit.nlogn_coefficient = std::exp(log_coefficient);
+
+    fit.model_rms = -1.0;
+    for (int m = 0; m < GROWTH_MODEL_COUNT; ++m) {
+        double rms = 0.0;
+        fit_model(n, log_y, (GrowthModel)m, log_coefficient, rms);
+        if (fit.model_rms < 0.0 || rms < fit.model_rms) {
+            fit.model = (GrowthModel)m;
+            fit.model_rms = rms;
+        }
+    }
+    return fit;
+}
+
+std::vector<int> find_jumps(const std::vector<double>& sizes, const std::vector<double>& values, GrowthModel model,
+    double threshold) {
+    std::vector<int> jumps;
+    for (size_t i = 1; i < sizes.size() && i < values.size(); ++i) {
+        if (values[i - 1] <= 0.0 || values[i] <= 0.0) {
+            continue;
+        }
+        const double before = values[i - 1] / growth_model_value(model, sizes[i - 1]);
+        const double after = values[i] / growth_model_value(model, sizes[i]);
+        if (after > before * (1.0 + threshold)) {
+            jumps.push_back((int)i);
+        }
+    }
+    return jumps;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string> // std::string
+#include <vector> // std::vector
+#include "sorting_algo.h"
+
+// One size of a sweep
+struct SweepPoint {
+    int size = 0;
+    double ms = 0.0; // Best wall time of sort() over the trials
+    long long compares = -1; // From a stepped run, -1 where the sweep didn't count
+    long long swaps = -1;
+    long long writes = -1;
+};
+
+struct SweepOptions {
+    int min_size = 256;
+    int max_size = 1 << 22;
+    double factor = 2.0; // Geometric size progression
+    int trials = 3;
+    double max_ms = 250.0; // The sweep stops after the first size whose sort takes longer, the counting after its stepped run does
+    int count_max_size = 1 << 16; // Stepped runs for the counts only up to this size
+};
+
+// Sorts random permutations of every size in the progression, a new one per run (the same ones for every algorithm)
+std::vector<SweepPoint> run_sweep(SortingAlgo& algo, const SweepOptions& options, unsigned int seed);
+
+// The algorithms' sweeps, saved as CSV with one row per algorithm and size (counts empty where not measured)
+struct SweepSeries {
+    std::string algo;
+    std::vector<SweepPoint> points;
+};
+
+bool save_sweep_csv(const char* path, const std::vector<SweepSeries>& series);
+
+enum class GrowthModel {
+    Linear,
+    NLogN,
+    N1_5,
+    NLog2N,
+    Quadratic,
+};
+
+static const int GROWTH_MODEL_COUNT = 5;
+
+const char* growth_model_name(GrowthModel model);
+// f(n) of the model, without the constant factor
+double growth_model_value(GrowthModel model, double n);
+
+struct ComplexityFit {
+    int points = 0; // Sizes with a positive value, fewer than 3 leave the fit empty
+    double exponent = 0.0; // k of the least-squares power law c * n^k (a straight line in log-log space)
+    double nlogn_coefficient = 0.0; // c of the least-squares c * n log2 n
+    double nlogn_rms = 0.0; // RMS of its log residuals, ~0.05 for a 5% typical deviation
+    GrowthModel model = GrowthModel::NLogN; // The standard model with the smallest RMS log residual
+    double model_rms = 0.0;
+};
+
+ComplexityFit fit_complexity(const std::vector<double>& sizes, const std::vector<double>& values);
+
+// Indices i where the value over the model's f(n) rises by more than threshold (e.g. 0.25) from point i - 1. Fed the
+// sort times, these are the sizes where the array spills out of a cache level.
+std::vector<int> find_jumps(const std::vector<double>& sizes, const std::vector<double>& values, GrowthModel model,
+    double threshold);
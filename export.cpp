@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include "frame_export.h"
+#include "input_gen.h"
+#include "sorting_algo.h"
+
+#ifdef _WIN32
+#include <fcntl.h> // _O_BINARY
+#include <io.h> // _setmode(), _fileno()
+#endif
+
+// Global constants for default settings
+static const int EXPORT_SIZE = 100;
+static const unsigned int EXPORT_SEED = 12345;
+
+// Function prototypes
+static int arg_int(int argc, char** argv, const char* flag, int fallback);
+static const char* arg_str(int argc, char** argv, const char* flag, const char* fallback);
+static void print_usage(const char* prog, const std::vector<std::unique_ptr<SortingAlgo>>& algorithms);
+
+// Renders a run offscreen, without SDL or a window, and streams its frames as Y4M or raw RGB24 to a file or stdout
+int main(int argc, char** argv) {
+    const std::vector<std::unique_ptr<SortingAlgo>> algorithms = make_algorithms();
+
+    if (argc > 1 && std::strcmp(argv[1], "--help") == 0) {
+        print_usage(argv[0], algorithms);
+        return 0;
+    }
+
+    const char* filter = arg_str(argc, argv, "--algo", "Quick Sort");
+    const char* dist = arg_str(argc, argv, "--dist", "random");
+    const char* out_path = arg_str(argc, argv, "--out", "vsort.y4m");
+    const char* format = arg_str(argc, argv, "--format", "y4m");
+    const int size = std::max(2, arg_int(argc, argv, "--size", EXPORT_SIZE));
+
+    ExportOptions options;
+    options.width = arg_int(argc, argv, "--width", options.width);
+    options.height = arg_int(argc, argv, "--height", options.height);
+    options.fps = arg_int(argc, argv, "--fps", options.fps);
+    options.every = arg_int(argc, argv, "--every", options.every);
+    options.bar_spacing = arg_int(argc, argv, "--spacing", options.bar_spacing);
+    options.threads = std::max(1, arg_int(argc, argv, "--threads", (int)std::thread::hardware_concurrency()));
+    if (std::strcmp(format, "y4m") == 0) {
+        options.format = ExportFormat::Y4M;
+    } else if (std::strcmp(format, "rgb") == 0) {
+        options.format = ExportFormat::RawRgb;
+    } else {
+        std::fprintf(stderr, "Unknown format: %s (y4m or rgb)\n", format);
+        return 1;
+    }
+
+    SortingAlgo* algo = nullptr;
+    for (const std::unique_ptr<SortingAlgo>& candidate : algorithms) {
+        if (std::strstr(candidate->name(), filter) != nullptr) {
+            algo = candidate.get();
+            break;
+        }
+    }
+    if (algo == nullptr) {
+        std::fprintf(stderr, "No algorithm matches: %s\n", filter);
+        return 1;
+    }
+
+    std::mt19937 rng(EXPORT_SEED);
+    std::vector<int> arr;
+    if (!fill_distribution(arr, size, dist, rng)) {
+        std::fprintf(stderr, "Unknown distribution: %s\n", dist);
+        return 1;
+    }
+
+    // "-" streams to stdout (e.g. into ffmpeg -i -), so everything else goes to stderr
+    const bool to_stdout = (std::strcmp(out_path, "-") == 0);
+    FILE* out = stdout;
+    if (to_stdout) {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    } else {
+        out = std::fopen(out_path, "wb");
+        if (out == nullptr) {
+            std::fprintf(stderr, "Failed to create %s\n", out_path);
+            return 1;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const long long frames = export_run(*algo, arr, options, out);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!to_stdout && std::fclose(out) != 0) {
+        std::fprintf(stderr, "Failed to write %s\n", out_path);
+        return 1;
+    }
+    if (frames < 0) {
+        std::fprintf(stderr, "Failed to write %s\n", to_stdout ? "to stdout" : out_path);
+        return 1;
+    }
+
+    std::fprintf(stderr, "%s on %d %s keys: %lld frames (every %d steps) at %dx%d in %.2f s, %.0f frames/s on %d threads\n",
+        algo->name(), size, dist, frames, std::max(1, options.every), options.width & ~1, options.height & ~1, seconds,
+        frames / std::max(seconds, 1e-9), options.threads);
+    if (options.format == ExportFormat::RawRgb) {
+        std::fprintf(stderr, "Encode with: ffmpeg -f rawvideo -pix_fmt rgb24 -s %dx%d -r %d -i %s out.mp4\n",
+            options.width & ~1, options.height & ~1, options.fps, out_path);
+    }
+    return 0;
+}
+
+static int arg_int(int argc, char** argv, const char* flag, int fallback) {
+    for (int i = 0; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], flag) == 0) {
+            return std::atoi(argv[i + 1]);
+        }
+    }
+    return fallback;
+}
+
+static const char* arg_str(int argc, char** argv, const char* flag, const char* fallback) {
+    for (int i = 0; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], flag) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return fallback;
+}
+
+static void print_usage(const char* prog, const std::vector<std::unique_ptr<SortingAlgo>>& algorithms) {
+    std::fprintf(stderr,
+        "Usage: %s [options], every option has a default\n\n"
+        "  --algo NAME       First algorithm whose name contains NAME (default Quick Sort)\n"
+        "  --size N          Array size (default %d)\n"
+        "  --dist D          random, few, sorted, reversed or nearly (default random)\n"
+        "  --every N         One frame every N steps (default 1)\n"
+        "  --width W         Frame width (default 1280)\n"
+        "  --height H        Frame height (default 720)\n"
+        "  --fps F           Frame rate in the Y4M header (default 60)\n"
+        "  --spacing PX      Pixels between bars (default 2)\n"
+        "  --format FMT      y4m or rgb (raw RGB24 frames, default y4m)\n"
+        "  --threads T       Rendering threads (default all cores)\n"
+        "  --out FILE        Output file, - for stdout (default vsort.y4m)\n\n"
+        "Algorithms:\n",
+        prog, EXPORT_SIZE);
+    for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+        std::fprintf(stderr, "  %s\n", algo->name());
+    }
+}
@@ -0,0 +1,288 @@
+#include <algorithm> // std::push_heap(), std::pop_heap()
+#include <chrono> // std::chrono::steady_clock
+#include <climits> // INT_MAX
+#include <cstdio> // std::fopen(), std::fread(), std::fwrite()
+#include <vector> // std::vector
+#include "external_sort.h"
+
+namespace {
+
+static const int PROBE_KEYS = 1 << 14;
+
+// Aux bytes per key the algorithm keeps while sorting, from a small sort of keys in a bounded range (so a counting
+// sort's histogram is measured at a realistic density rather than over the whole int range)
+double probe_aux_per_key(SortingAlgo& algo) {
+    std::vector<int> probe(PROBE_KEYS);
+    for (int i = 0; i < PROBE_KEYS; ++i) {
+        probe[i] = (int)(((long long)i * 7919) % PROBE_KEYS);
+    }
+    algo.sort(probe);
+    return (double)algo.aux_memory_bytes() / PROBE_KEYS;
+}
+
+// The stdio buffers are turned off, every read and write is a whole block of ours
+FILE* open_unbuffered(const char* path, const char* mode) {
+    FILE* file = std::fopen(path, mode);
+    if (file == nullptr) {
+        std::fprintf(stderr, "Failed to open %s\n", path);
+        return nullptr;
+    }
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    return file;
+}
+
+class BlockWriter {
+public:
+    BlockWriter(FILE* file, size_t block_keys, long long& bytes_written) : m_file(file), m_bytes_written(bytes_written) {
+        m_block.reserve(block_keys);
+    }
+
+    void push(int key) {
+        m_block.push_back(key);
+        if (m_block.size() == m_block.capacity()) {
+            flush();
+        }
+    }
+
+    void write(const int* keys, size_t count) {
+        flush();
+        m_failed = m_failed || (std::fwrite(keys, sizeof(int), count, m_file) != count);
+        m_bytes_written += (long long)(count * sizeof(int));
+    }
+
+    // Returns false if any write failed
+    bool flush() {
+        if (!m_block.empty()) {
+            m_failed = m_failed || (std::fwrite(m_block.data(), sizeof(int), m_block.size(), m_file) != m_block.size());
+            m_bytes_written += (long long)(m_block.size() * sizeof(int));
+            m_block.clear();
+        }
+        return !m_failed;
+    }
+
+private:
+    FILE* m_file;
+    std::vector<int> m_block;
+    long long& m_bytes_written;
+    bool m_failed = false;
+};
+
+class BlockReader {
+public:
+    BlockReader(FILE* file, size_t block_keys, long long& bytes_read) : m_file(file), m_block(block_keys), m_bytes_read(bytes_read) {}
+
+    // False once the file is exhausted or a read failed (see failed())
+    bool next(int& key) {
+        if (m_pos == m_count) {
+            m_count = std::fread(m_block.data(), sizeof(int), m_block.size(), m_file);
+            m_bytes_read += (long long)(m_count * sizeof(int));
+            m_pos = 0;
+            if (m_count < m_block.size() && std::ferror(m_file)) {
+                m_failed = true;
+                m_count = 0;
+            }
+            if (m_count == 0) {
+                return false;
+            }
+        }
+        key = m_block[m_pos++];
+        return true;
+    }
+
+    bool failed() const {
+        return m_failed;
+    }
+
+private:
+    FILE* m_file;
+    std::vector<int> m_block;
+    size_t m_pos = 0;
+    size_t m_count = 0;
+    long long& m_bytes_read;
+    bool m_failed = false;
+};
+
+// Merges the sorted runs into output with a min-heap holding the head of every run
+bool merge_files(const std::vector<std::string>& inputs, const std::string& output, size_t budget, ExternalSortStats& stats) {
+    const size_t block_keys = std::max<size_t>(1, budget / ((inputs.size() + 1) * sizeof(int)));
+    stats.peak_bytes = std::max(stats.peak_bytes, (inputs.size() + 1) * block_keys * sizeof(int));
+
+    std::vector<FILE*> files;
+    std::vector<BlockReader> readers;
+    readers.reserve(inputs.size());
+    bool ok = true;
+    for (const std::string& input : inputs) {
+        FILE* file = open_unbuffered(input.c_str(), "rb");
+        if (file == nullptr) {
+            ok = false;
+            break;
+        }
+        files.push_back(file);
+        readers.emplace_back(file, block_keys, stats.bytes_read);
+    }
+
+    FILE* out = ok ? open_unbuffered(output.c_str(), "wb") : nullptr;
+    if (out != nullptr) {
+        struct Head {
+            int key;
+            int run;
+        };
+        const auto greater = [](const Head& a, const Head& b) {
+            return b.key < a.key;
+        };
+
+        std::vector<Head> heap;
+        for (int run = 0; run < (int)readers.size(); ++run) {
+            Head head = {0, run};
+            if (readers[run].next(head.key)) {
+                heap.push_back(head);
+            }
+        }
+        std::make_heap(heap.begin(), heap.end(), greater);
+
+        BlockWriter writer(out, block_keys, stats.bytes_written);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            Head& head = heap.back();
+            writer.push(head.key);
+            if (readers[head.run].next(head.key)) {
+                std::push_heap(heap.begin(), heap.end(), greater);
+            } else {
+                heap.pop_back();
+            }
+        }
+
+        // A failed read ends its run early, which would still leave a sorted but incomplete output
+        for (size_t run = 0; run < readers.size(); ++run) {
+            if (readers[run].failed()) {
+                std::fprintf(stderr, "Failed to read %s\n", inputs[run].c_str());
+                ok = false;
+            }
+        }
+        const bool written = writer.flush();
+        if (std::fclose(out) != 0 || !written) {
+            std::fprintf(stderr, "Failed to write %s\n", output.c_str());
+            ok = false;
+        }
+    } else {
+        ok = false;
+    }
+
+    for (FILE* file : files) {
+        std::fclose(file);
+    }
+    return ok;
+}
+
+void remove_files(const std::vector<std::string>& paths) {
+    for (const std::string& path : paths) {
+        std::remove(path.c_str());
+    }
+}
+
+} // namespace
+
+bool external_sort(const char* input_path, const char* output_path, SortingAlgo& algo, const ExternalSortOptions& options,
+    ExternalSortStats& stats) {
+    stats = ExternalSortStats();
+    const std::string prefix = options.temp_prefix.empty() ? std::string(output_path) : options.temp_prefix;
+    int next_run_id = 0;
+    const auto run_path = [&prefix, &next_run_id]() {
+        return prefix + ".run" + std::to_string(next_run_id++);
+    };
+
+    // Run formation: the chunk and the algorithm's buffers share the budget
+    const auto run_start = std::chrono::steady_clock::now();
+    const double bytes_per_key = sizeof(int) + probe_aux_per_key(algo);
+    stats.chunk_keys = (int)std::min<double>(INT_MAX, std::max(1.0, (double)options.memory_budget / bytes_per_key));
+
+    FILE* input = open_unbuffered(input_path, "rb");
+    if (input == nullptr) {
+        return false;
+    }
+
+    std::vector<std::string> runs;
+    std::vector<int> chunk(stats.chunk_keys);
+    bool ok = true;
+    while (ok) {
+        // Read as bytes so a trailing partial key shows up instead of being dropped by fread
+        chunk.resize(stats.chunk_keys);
+        const size_t bytes = std::fread(chunk.data(), 1, chunk.size() * sizeof(int), input);
+        if (bytes < chunk.size() * sizeof(int) && std::ferror(input)) {
+            std::fprintf(stderr, "Failed to read %s\n", input_path);
+            ok = false;
+            break;
+        }
+        if (bytes % sizeof(int) != 0) {
+            std::fprintf(stderr, "%s ends in a partial key (%lld bytes, not a multiple of %zu)\n", input_path,
+                stats.bytes_read + (long long)bytes, sizeof(int));
+            ok = false;
+            break;
+        }
+        const size_t count = bytes / sizeof(int);
+        if (count == 0) {
+            break;
+        }
+        stats.keys += (long long)count;
+        stats.bytes_read += (long long)(count * sizeof(int));
+
+        chunk.resize(count);
+        algo.sort(chunk);
+        stats.peak_bytes = std::max(stats.peak_bytes, (count * sizeof(int)) + algo.aux_memory_bytes());
+
+        runs.push_back(run_path());
+        FILE* run = open_unbuffered(runs.back().c_str(), "wb");
+        if (run == nullptr) {
+            ok = false;
+            break;
+        }
+        BlockWriter writer(run, 0, stats.bytes_written);
+        writer.write(chunk.data(), chunk.size());
+        ok = writer.flush();
+        ok = (std::fclose(run) == 0) && ok;
+        if (!ok) {
+            std::fprintf(stderr, "Failed to write %s\n", runs.back().c_str());
+        }
+    }
+    std::fclose(input);
+    std::vector<int>().swap(chunk);
+    stats.runs = (int)runs.size();
+    stats.run_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - run_start).count();
+
+    if (!ok) {
+        remove_files(runs);
+        return false;
+    }
+
+    // Merge passes: as many runs at a time as the budget gives a full block each, the last pass into the output.
+    // Buffers the algorithm still holds on to come out of the merge's share.
+    const auto merge_start = std::chrono::steady_clock::now();
+    const size_t merge_budget = options.memory_budget - std::min(options.memory_budget / 2, algo.aux_memory_bytes());
+    // One of the blocks is the output's, clamped first so a budget under two blocks still merges pairs
+    const size_t fan_in = std::max<size_t>(3, merge_budget / MIN_MERGE_BLOCK_BYTES) - 1;
+    stats.fan_in = (int)std::min<size_t>(INT_MAX, fan_in);
+    while (ok && runs.size() > fan_in) {
+        ++stats.merge_passes;
+        std::vector<std::string> merged;
+        for (size_t first = 0; ok && first < runs.size(); first += fan_in) {
+            const std::vector<std::string> group(runs.begin() + first, runs.begin() + std::min(first + fan_in, runs.size()));
+            merged.push_back(run_path());
+            ok = merge_files(group, merged.back(), merge_budget, stats);
+            remove_files(group);
+        }
+        if (!ok) {
+            for (size_t first = merged.size() * fan_in; first < runs.size(); ++first) {
+                std::remove(runs[first].c_str());
+            }
+        }
+        runs.swap(merged);
+    }
+
+    if (ok) {
+        ++stats.merge_passes;
+        ok = merge_files(runs, output_path, merge_budget, stats);
+    }
+    remove_files(runs);
+    stats.merge_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - merge_start).count();
+    return ok;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef> // size_t
+#include <string> // std::string
+#include "sorting_algo.h"
+
+// Key files are flat arrays of native-endian int32 keys, without a header
+
+// Smallest read block per run while merging. A budget too small to give every run one makes the merge take several
+// passes instead, since tiny reads spread over many files turn sequential I/O into seeks.
+static const size_t MIN_MERGE_BLOCK_BYTES = 256 * 1024;
+
+struct ExternalSortOptions {
+    size_t memory_budget = 64 << 20; // Bytes of keys and buffers held at once, in both phases
+    std::string temp_prefix; // Runs go to <temp_prefix>.run<N>, next to the output when empty
+};
+
+struct ExternalSortStats {
+    long long keys = 0;
+    int chunk_keys = 0;
+    int runs = 0;
+    int merge_passes = 0;
+    int fan_in = 0; // Runs per merge pass, from the budget left after the algorithm's aux memory
+    size_t peak_bytes = 0; // Largest chunk plus the algorithm's aux memory, or all buffers of a merge
+    long long bytes_read = 0;
+    long long bytes_written = 0;
+    double run_ms = 0.0;
+    double merge_ms = 0.0;
+};
+
+// Sorts the keys of input_path into output_path. Chunks that fit the budget (with the aux memory algo needs, measured
+// on a probe sort) are sorted in memory and written out as runs, then the runs are streamed through a k-way merge with
+// one block reader per run. Returns false on I/O errors or an input that ends in a partial key, after printing what
+// failed and removing the run files.
+bool external_sort(const char* input_path, const char* output_path, SortingAlgo& algo, const ExternalSortOptions& options,
+    ExternalSortStats& stats);
@@ -0,0 +1,237 @@
+#include <algorithm> // std::max(), std::min(), std::max_element()
+#include <atomic> // std::atomic
+#include <cmath> // std::lround()
+#include <cstring> // std::memcpy(), std::memcmp()
+#include <thread> // std::thread
+#include "frame_export.h"
+#include "palette.h"
+
+namespace {
+
+// A snapshot and its encoded frame. Slots are reused batch after batch, so their buffers are allocated once.
+struct FrameSlot {
+    BarFrame frame;
+    std::vector<uint8_t> pixels;
+};
+
+void snapshot(const std::vector<int>& arr, int hi1, int hi2, const SortingAlgo& algo, FrameSlot& slot) {
+    slot.frame.values.assign(arr.begin(), arr.end());
+    slot.frame.hi1 = hi1;
+    slot.frame.hi2 = hi2;
+    const std::vector<SortRegion>& regions = algo.regions();
+    slot.frame.regions.assign(regions.begin(), regions.end());
+}
+
+// Renders slots[0..count) on up to threads threads, each taking the next unrendered slot
+void render_batch(std::vector<FrameSlot>& slots, int count, int max_value, const ExportOptions& options, int width, int height,
+    std::vector<std::vector<uint8_t>>& scratch) {
+    std::atomic<int> next(0);
+    auto worker = [&](int thread) {
+        for (int i = next++; i < count; i = next++) {
+            FrameSlot& slot = slots[i];
+            if (options.format == ExportFormat::RawRgb) {
+                render_bar_frame(slot.frame, max_value, width, height, options.bar_spacing, slot.pixels);
+            } else {
+                render_bar_frame(slot.frame, max_value, width, height, options.bar_spacing, scratch[thread]);
+                rgb_to_i420(scratch[thread].data(), width, height, slot.pixels);
+            }
+        }
+    };
+
+    const int thread_count = std::min((int)scratch.size(), count);
+    std::vector<std::thread> threads;
+    for (int t = 1; t < thread_count; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+bool write_batch(const std::vector<FrameSlot>& slots, int count, ExportFormat format, FILE* out) {
+    for (int i = 0; i < count; ++i) {
+        if (format == ExportFormat::Y4M && std::fputs("FRAME\n", out) == EOF) {
+            return false;
+        }
+        const std::vector<uint8_t>& pixels = slots[i].pixels;
+        if (std::fwrite(pixels.data(), 1, pixels.size(), out) != pixels.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void render_bar_frame(const BarFrame& frame, int max_value, int width, int height, int bar_spacing, std::vector<uint8_t>& rgb) {
+    rgb.resize((size_t)width * height * 3);
+    const int bar_count = (int)frame.values.size();
+
+    // Per column: the first row of its bar (height for none) and its color, then every row is a lookup per pixel
+    std::vector<int> top(width, height);
+    std::vector<PaletteColor> color(width, PALETTE_BACKGROUND);
+    if (bar_count > 0) {
+        int spacing = std::max(0, bar_spacing);
+        if (width - (bar_count - 1) * spacing < bar_count) {
+            spacing = 0;
+        }
+        const double bar_width = (double)(width - (bar_count - 1) * spacing) / bar_count;
+        const double scale = (double)height / std::max(1, max_value);
+        for (int i = 0; i < bar_count; ++i) {
+            PaletteColor col = PALETTE_BAR;
+            for (const SortRegion& region : frame.regions) {
+                if (i >= region.lo && i <= region.hi) {
+                    col = PALETTE_WORKERS[region.worker % PALETTE_WORKER_COUNT];
+                }
+            }
+            if (i == frame.hi1) {
+                col = PALETTE_HIGHLIGHT1;
+            }
+            if (i == frame.hi2) {
+                col = PALETTE_HIGHLIGHT2;
+            }
+
+            const int bar_height = std::min(height, (int)std::lround(frame.values[i] * scale));
+            const double x = i * (bar_width + spacing);
+            const int x0 = std::min(width - 1, (int)std::lround(x));
+            const int x1 = std::min(width, std::max(x0 + 1, (int)std::lround(x + bar_width)));
+            for (int column = x0; column < x1; ++column) {
+                top[column] = height - bar_height;
+                color[column] = col;
+            }
+        }
+    }
+
+    // A row only differs from the one above where some bar starts, every other row is a copy
+    std::vector<char> bar_starts(height, 0);
+    for (int x = 0; x < width; ++x) {
+        if (top[x] < height) {
+            bar_starts[top[x]] = 1;
+        }
+    }
+    const size_t stride = (size_t)width * 3;
+    for (int y = 0; y < height; ++y) {
+        uint8_t* row = rgb.data() + y * stride;
+        if (y > 0 && !bar_starts[y]) {
+            std::memcpy(row, row - stride, stride);
+            continue;
+        }
+        for (int x = 0; x < width; ++x) {
+            const PaletteColor& c = (y >= top[x]) ? color[x] : PALETTE_BACKGROUND;
+            row[x * 3] = c.r;
+            row[x * 3 + 1] = c.g;
+            row[x * 3 + 2] = c.b;
+        }
+    }
+}
+
+void rgb_to_i420(const uint8_t* rgb, int width, int height, std::vector<uint8_t>& yuv) {
+    const int chroma_width = width / 2;
+    const int chroma_height = height / 2;
+    yuv.resize((size_t)width * height + 2 * (size_t)chroma_width * chroma_height);
+    uint8_t* y_plane = yuv.data();
+    uint8_t* u_plane = y_plane + (size_t)width * height;
+    uint8_t* v_plane = u_plane + (size_t)chroma_width * chroma_height;
+
+    // BT.601 limited range in 8-bit fixed point. Rows equal to the previous one (most of a bar chart) are copied.
+    const size_t stride = (size_t)width * 3;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* src = rgb + y * stride;
+        uint8_t* dst = y_plane + (size_t)y * width;
+        if (y > 0 && std::memcmp(src, src - stride, stride) == 0) {
+            std::memcpy(dst, dst - width, width);
+            continue;
+        }
+        for (int x = 0; x < width; ++x) {
+            const int r = src[x * 3];
+            const int g = src[x * 3 + 1];
+            const int b = src[x * 3 + 2];
+            dst[x] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+    for (int cy = 0; cy < chroma_height; ++cy) {
+        const uint8_t* row0 = rgb + (size_t)(cy * 2) * stride;
+        const uint8_t* row1 = row0 + stride;
+        uint8_t* u_row = u_plane + (size_t)cy * chroma_width;
+        uint8_t* v_row = v_plane + (size_t)cy * chroma_width;
+        if (cy > 0 && std::memcmp(row0, row0 - 2 * stride, 2 * stride) == 0) {
+            std::memcpy(u_row, u_row - chroma_width, chroma_width);
+            std::memcpy(v_row, v_row - chroma_width, chroma_width);
+            continue;
+        }
+        for (int cx = 0; cx < chroma_width; ++cx) {
+            const int o = cx * 6;
+            const int r = row0[o] + row0[o + 3] + row1[o] + row1[o + 3];
+            const int g = row0[o + 1] + row0[o + 4] + row1[o + 1] + row1[o + 4];
+            const int b = row0[o + 2] + row0[o + 5] + row1[o + 2] + row1[o + 5];
+            // Sums of four samples, hence the extra >> 2
+            u_row[cx] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+            v_row[cx] = (uint8_t)(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+        }
+    }
+}
+
+long long export_run(SortingAlgo& algo, std::vector<int>& arr, const ExportOptions& options, FILE* out) {
+    const int width = std::max(2, options.width & ~1);
+    const int height = std::max(2, options.height & ~1);
+    const int every = std::max(1, options.every);
+    const int threads = std::max(1, options.threads);
+    const int max_value = arr.empty() ? 1 : std::max(1, *std::max_element(arr.begin(), arr.end()));
+
+    if (options.format == ExportFormat::Y4M &&
+        std::fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, std::max(1, options.fps)) < 0) {
+        return -1;
+    }
+
+    // Two batches: one is rendered while the other is written
+    const int batch_size = threads * 2;
+    std::vector<FrameSlot> batches[2] = {std::vector<FrameSlot>(batch_size), std::vector<FrameSlot>(batch_size)};
+    std::vector<std::vector<uint8_t>> scratch(threads);
+    std::thread writer;
+    std::atomic<bool> write_ok(true);
+    long long frames = 0;
+
+    algo.reset((int)arr.size());
+    bool done = arr.size() < 2;
+    bool first = true;
+    long long steps = 0;
+    for (int current = 0;; current ^= 1) {
+        std::vector<FrameSlot>& batch = batches[current];
+        int count = 0;
+        if (first) {
+            snapshot(arr, -1, -1, algo, batch[count++]);
+            first = false;
+        }
+        while (count < batch_size && !done) {
+            const SortStepResult step_result = algo.step(arr);
+            ++steps;
+            done = step_result.done;
+            if (done) {
+                snapshot(arr, -1, -1, algo, batch[count++]); // The sorted array without highlights
+            } else if (steps % every == 0) {
+                snapshot(arr, step_result.hi1, step_result.hi2, algo, batch[count++]);
+            }
+        }
+        if (count == 0) {
+            break;
+        }
+
+        render_batch(batch, count, max_value, options, width, height, scratch);
+        if (writer.joinable()) {
+            writer.join();
+        }
+        if (!write_ok) {
+            break;
+        }
+        const std::vector<FrameSlot>* written = &batch;
+        writer = std::thread([written, count, &options, out, &write_ok]() {
+            write_ok = write_batch(*written, count, options.format, out);
+        });
+        frames += count;
+    }
+    if (writer.joinable()) {
+        writer.join();
+    }
+    return (write_ok && std::fflush(out) == 0) ? frames : -1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint> // uint8_t
+#include <cstdio> // FILE
+#include <vector> // std::vector
+#include "sorting_algo.h"
+
+enum class ExportFormat {
+    Y4M, // YUV4MPEG2, 4:2:0 BT.601 limited range, which ffmpeg and most players read directly
+    RawRgb, // Bare RGB24 frames, no header
+};
+
+struct ExportOptions {
+    int width = 1280; // Rounded down to even, 4:2:0 halves both dimensions
+    int height = 720;
+    int fps = 60; // Only stored in the Y4M header
+    int every = 1; // A frame every N steps (the first and the final state are always written)
+    int threads = 4; // Frames rendered in parallel
+    int bar_spacing = 2; // Pixels between bars, dropped when the bars would get narrower than a pixel
+    ExportFormat format = ExportFormat::Y4M;
+};
+
+// What one frame shows, copied out of the run so it can be rendered on another thread
+struct BarFrame {
+    std::vector<int> values;
+    int hi1 = -1;
+    int hi2 = -1;
+    std::vector<SortRegion> regions;
+};
+
+// Draws the bars the way the GUI does (same colors and highlights) into width x height RGB24, rows top to bottom.
+// Bar heights are value / max_value of the frame height.
+void render_bar_frame(const BarFrame& frame, int max_value, int width, int height, int bar_spacing, std::vector<uint8_t>& rgb);
+
+// RGB24 to planar 4:2:0 (Y, then Cb and Cr at half resolution, each chroma sample the mean of a 2x2 block)
+void rgb_to_i420(const uint8_t* rgb, int width, int height, std::vector<uint8_t>& yuv);
+
+// Steps algo over arr to completion and streams every options.every-th state to out as frames. The algorithm steps on
+// the calling thread while a batch of snapshots is rendered by options.threads threads, and the previous batch is
+// written by another, in order. Returns the number of frames written, -1 if out failed.
+long long export_run(SortingAlgo& algo, std::vector<int>& arr, const ExportOptions& options, FILE* out);
@@ -0,0 +1,82 @@
+#include <algorithm> // std::nth_element(), std::min()
+#include <cmath> // std::ceil()
+#include "frame_stats.h"
+
+const char* frame_stage_name(FrameStage stage) {
+    switch (stage) {
+    case FrameStage::Events:
+        return "Events";
+    case FrameStage::Step:
+        return "Step";
+    case FrameStage::UiBuild:
+        return "UI build";
+    case FrameStage::Submit:
+        return "Draw submit";
+    case FrameStage::Present:
+        return "Present";
+    }
+    return "?";
+}
+
+FrameStats::FrameStats() : m_frame_ms(HISTORY), m_stage_ms(FRAME_STAGE_COUNT, RingBuffer<float>(HISTORY)) {}
+
+void FrameStats::add(const double (&stage_ms)[FRAME_STAGE_COUNT]) {
+    double frame_ms = 0.0;
+    for (int i = 0; i < FRAME_STAGE_COUNT; ++i) {
+        m_stage_ms[i].push((float)stage_ms[i]);
+        frame_ms += stage_ms[i];
+    }
+    m_frame_ms.push((float)frame_ms);
+}
+
+void FrameStats::clear() {
+    m_frame_ms.clear();
+    for (RingBuffer<float>& history : m_stage_ms) {
+        history.clear();
+    }
+}
+
+float FrameStats::frame_percentile(double p) const {
+    return percentile(m_frame_ms, p);
+}
+
+float FrameStats::stage_percentile(FrameStage stage, double p) const {
+    return percentile(m_stage_ms[(int)stage], p);
+}
+
+double FrameStats::stage_share(FrameStage stage) const {
+    const RingBuffer<float>& history = m_stage_ms[(int)stage];
+    double stage_total = 0.0;
+    double frame_total = 0.0;
+    for (size_t i = 0; i < history.size(); ++i) {
+        stage_total += history[i];
+        frame_total += m_frame_ms[i];
+    }
+    return (frame_total > 0.0) ? stage_total / frame_total : 0.0;
+}
+
+void FrameStats::histogram(float max_ms, std::vector<float>& bins) const {
+    std::fill(bins.begin(), bins.end(), 0.0f);
+    if (bins.empty() || max_ms <= 0.0f) {
+        return;
+    }
+    const float bin_ms = max_ms / (float)bins.size();
+    for (size_t i = 0; i < m_frame_ms.size(); ++i) {
+        const size_t bin = std::min(bins.size() - 1, (size_t)(m_frame_ms[i] / bin_ms));
+        bins[bin] += 1.0f;
+    }
+}
+
+float FrameStats::percentile(const RingBuffer<float>& history, double p) const {
+    if (history.empty()) {
+        return 0.0f;
+    }
+    m_scratch.resize(history.size());
+    for (size_t i = 0; i < history.size(); ++i) {
+        m_scratch[i] = history[i];
+    }
+    const size_t rank = (size_t)std::ceil((p / 100.0) * (double)m_scratch.size());
+    const size_t k = std::min(m_scratch.size() - 1, (rank > 0) ? rank - 1 : 0);
+    std::nth_element(m_scratch.begin(), m_scratch.begin() + k, m_scratch.end());
+    return m_scratch[k];
+}
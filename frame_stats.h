@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector> // std::vector
+#include "ring_buffer.h"
+
+// Consecutive parts of a frame, from polling events to presenting
+enum class FrameStage {
+    Events, // SDL event handling
+    Step, // The algorithm's step
+    UiBuild, // ImGui frame, windows and draw lists
+    Submit, // Clearing and handing the draw data to the renderer
+    Present, // SDL_RenderPresent (waits for vsync when it's on)
+};
+
+static constexpr int FRAME_STAGE_COUNT = 5;
+
+const char* frame_stage_name(FrameStage stage);
+
+// Rolling per-stage timings of the last HISTORY frames. The frame time is the sum of the stages, so the frame cap
+// delay is left out and the numbers show the cost of a frame rather than the cap.
+class FrameStats {
+public:
+    static constexpr size_t HISTORY = 600;
+
+    FrameStats();
+
+    void add(const double (&stage_ms)[FRAME_STAGE_COUNT]);
+    void clear();
+
+    size_t frames() const {
+        return m_frame_ms.size();
+    }
+    const RingBuffer<float>& frame_history() const {
+        return m_frame_ms;
+    }
+
+    // Nearest-rank percentile (0-100) over the history, 0 when empty
+    float frame_percentile(double p) const;
+    float stage_percentile(FrameStage stage, double p) const;
+
+    // Share of the summed frame time spent in the stage over the history (0-1)
+    double stage_share(FrameStage stage) const;
+
+    // Frame times counted into bins.size() equal bins from 0 to max_ms, longer frames land in the last bin
+    void histogram(float max_ms, std::vector<float>& bins) const;
+
+private:
+    float percentile(const RingBuffer<float>& history, double p) const;
+
+    RingBuffer<float> m_frame_ms;
+    std::vector<RingBuffer<float>> m_stage_ms;
+    mutable std::vector<float> m_scratch; // Sorted copy for the percentiles
+};
@@ -0,0 +1,132 @@
+#include <algorithm> // std::sort(), std::unique()
+#include <cmath> // std::ceil(), std::pow()
+#include <functional> // std::greater
+#include "gap_sequence.h"
+
+const char* gap_sequence_name(GapSequence sequence) {
+    switch (sequence) {
+        case GapSequence::Ciura:
+            return "Ciura";
+        case GapSequence::Tokuda:
+            return "Tokuda";
+        case GapSequence::Sedgewick:
+            return "Sedgewick";
+        case GapSequence::Pratt:
+            return "Pratt";
+        case GapSequence::Hibbard:
+            return "Hibbard";
+        case GapSequence::Shrink:
+            return "Shrink";
+        case GapSequence::Custom:
+            return "Custom";
+    }
+    return "?";
+}
+
+GapSequenceEngine::GapSequenceEngine(GapSequence sequence) : m_sequence(sequence) {}
+
+void GapSequenceEngine::set_sequence(GapSequence sequence) {
+    if (sequence != m_sequence) {
+        m_sequence = sequence;
+        m_cache.clear();
+    }
+}
+
+void GapSequenceEngine::set_growth(double growth) {
+    if (growth > 1.0 && growth != m_growth) {
+        m_growth = growth;
+        m_cache.clear();
+    }
+}
+
+void GapSequenceEngine::set_shrink(double shrink) {
+    if (shrink > 1.0 && shrink != m_shrink) {
+        m_shrink = shrink;
+        m_cache.clear();
+    }
+}
+
+void GapSequenceEngine::set_custom(const std::vector<int>& gaps) {
+    m_custom = gaps;
+    m_cache.clear();
+}
+
+const std::vector<int>& GapSequenceEngine::gaps(int size) {
+    auto it = m_cache.find(size);
+    if (it == m_cache.end()) {
+        it = m_cache.emplace(size, std::vector<int>()).first;
+        build(size, it->second);
+    }
+    return it->second;
+}
+
+void GapSequenceEngine::build(int size, std::vector<int>& gaps) const {
+    gaps.clear();
+    if (size <= 1) {
+        return;
+    }
+
+    // Ascending candidates (the Shrink sequence is built top-down instead), filtered and reversed below
+    std::vector<long long> candidates;
+    switch (m_sequence) {
+        case GapSequence::Ciura: {
+            candidates = {1, 4, 10, 23, 57, 132, 301, 701};
+            while (candidates.back() < size) {
+                long long next = (long long)(candidates.back() * m_growth);
+                if (next <= candidates.back()) {
+                    next = candidates.back() + 1;
+                }
+                candidates.push_back(next);
+            }
+            break;
+        }
+        case GapSequence::Tokuda: {
+            for (int k = 1; candidates.empty() || candidates.back() < size; ++k) {
+                candidates.push_back((long long)std::ceil(((9.0 * std::pow(2.25, k - 1)) - 4.0) / 5.0));
+            }
+            break;
+        }
+        case GapSequence::Sedgewick: {
+            candidates.push_back(1);
+            for (int k = 1; candidates.back() < size; ++k) {
+                candidates.push_back((1LL << (2 * k)) + (3LL << (k - 1)) + 1);
+            }
+            break;
+        }
+        case GapSequence::Pratt: {
+            for (long long pow2 = 1; pow2 < size; pow2 *= 2) {
+                for (long long gap = pow2; gap < size; gap *= 3) {
+                    candidates.push_back(gap);
+                }
+            }
+            break;
+        }
+        case GapSequence::Hibbard: {
+            for (int k = 1; candidates.empty() || candidates.back() < size; ++k) {
+                candidates.push_back((1LL << k) - 1);
+            }
+            break;
+        }
+        case GapSequence::Shrink: {
+            int gap = size;
+            while (gap > 1) {
+                gap = std::max(1, (int)(gap / m_shrink));
+                gaps.push_back(gap);
+            }
+            return;
+        }
+        case GapSequence::Custom: {
+            candidates.assign(m_custom.begin(), m_custom.end());
+            candidates.push_back(1);
+            break;
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), std::greater<long long>());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (long long gap : candidates) {
+        if (gap >= 1 && gap < size) {
+            gaps.push_back((int)gap);
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <map> // std::map
+#include <vector> // std::vector
+
+// Gap sequences for Shell Sort and Comb Sort
+enum class GapSequence {
+    Ciura, // 1, 4, 10, 23, 57, 132, 301, 701, then extended by the growth factor
+    Tokuda, // ceil((9^k - 4^k) / (5 * 4^(k - 1)))
+    Sedgewick, // 1, then 4^k + 3 * 2^(k - 1) + 1
+    Pratt, // Every 2^p * 3^q (3-smooth numbers)
+    Hibbard, // 2^k - 1
+    Shrink, // size divided by the shrink factor again and again (Comb Sort's classic rule)
+    Custom,
+};
+
+static constexpr int GAP_SEQUENCE_COUNT = (int)GapSequence::Custom + 1;
+
+const char* gap_sequence_name(GapSequence sequence);
+
+// Builds the gaps for a sequence and caches them per array size, so a reset() with the same size is free.
+// Changing the sequence or its factors drops the cache, which also invalidates references returned by gaps().
+class GapSequenceEngine {
+public:
+    static constexpr double DEFAULT_GROWTH = 2.25;
+    static constexpr double DEFAULT_SHRINK = 1.3;
+
+    explicit GapSequenceEngine(GapSequence sequence = GapSequence::Ciura);
+
+    GapSequence sequence() const {
+        return m_sequence;
+    }
+    double growth() const {
+        return m_growth;
+    }
+    double shrink() const {
+        return m_shrink;
+    }
+
+    void set_sequence(GapSequence sequence);
+    void set_growth(double growth); // Extends Ciura's list past 701
+    void set_shrink(double shrink); // Divisor of the Shrink sequence
+    void set_custom(const std::vector<int>& gaps);
+
+    // The gaps below size in descending order, always ending with 1 (empty for size <= 1)
+    const std::vector<int>& gaps(int size);
+
+private:
+    void build(int size, std::vector<int>& gaps) const;
+
+    GapSequence m_sequence = GapSequence::Ciura;
+    double m_growth = DEFAULT_GROWTH;
+    double m_shrink = DEFAULT_SHRINK;
+    std::vector<int> m_custom;
+    std::map<int, std::vector<int>> m_cache;
+};
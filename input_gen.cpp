@@ -0,0 +1,114 @@
+#include <algorithm> // std::shuffle(), std::nth_element(), std::find()
+#include <cstring> // std::strcmp()
+#include <numeric> // std::iota()
+#include <utility> // std::pair
+#include "input_gen.h"
+
+// Uniform keys in [1, key_range]
+void fill_key_range(std::vector<int>& arr, int size, long long key_range, std::mt19937& rng) {
+    std::uniform_int_distribution<long long> dist(1, key_range);
+    arr.resize(size);
+    for (int i = 0; i < size; ++i) {
+        arr[i] = (int)dist(rng);
+    }
+}
+
+// Random permutation of 1..size, the same keys the GUI sorts
+void fill_permutation(std::vector<int>& arr, int size, std::mt19937& rng) {
+    arr.resize(size);
+    for (int i = 0; i < size; ++i) {
+        arr[i] = i + 1;
+    }
+    std::shuffle(arr.begin(), arr.end(), rng);
+}
+
+// Middle-pivot quick sorts split badly when the middle element of a range has an extreme rank. Replaying the 3-way
+// partition level by level, the element that lands in the middle of every range of the first `depth` levels is swapped
+// (in the input) with the one of rank `fraction` in that range. Both lie on the same side of every earlier pivot, so
+// the earlier partitions replay identically and only the targeted pivot changes.
+void fill_skewed(std::vector<int>& arr, int size, int depth, double fraction, std::mt19937& rng) {
+    fill_permutation(arr, size, rng);
+
+    std::vector<int> values;
+    std::vector<int> origin(size);
+    std::vector<int> range_values;
+    std::vector<std::pair<int, int>> ranges;
+    std::vector<std::pair<int, int>> next_ranges;
+    for (int level = 0; level < depth; ++level) {
+        values = arr;
+        std::iota(origin.begin(), origin.end(), 0);
+        ranges.assign(1, {0, size - 1});
+
+        for (int replay = 0; replay <= level && !ranges.empty(); ++replay) {
+            next_ranges.clear();
+            for (const auto& range : ranges) {
+                const int lo = range.first;
+                const int hi = range.second;
+                const int mid = lo + ((hi - lo) / 2);
+
+                if (replay == level) {
+                    range_values.assign(values.begin() + lo, values.begin() + hi + 1);
+                    const int rank = (int)((hi - lo) * fraction);
+                    std::nth_element(range_values.begin(), range_values.begin() + rank, range_values.end());
+                    const int pos = (int)(std::find(values.begin() + lo, values.begin() + hi + 1, range_values[rank]) - values.begin());
+                    std::swap(arr[origin[mid]], arr[origin[pos]]);
+                    continue;
+                }
+
+                const int pivot = values[mid];
+                int lt = lo;
+                int i = lo;
+                int gt = hi;
+                while (i <= gt) {
+                    if (values[i] < pivot) {
+                        std::swap(values[lt], values[i]);
+                        std::swap(origin[lt++], origin[i++]);
+                    } else if (values[i] > pivot) {
+                        std::swap(values[i], values[gt]);
+                        std::swap(origin[i], origin[gt--]);
+                    } else {
+                        ++i;
+                    }
+                }
+
+                if (lt - 1 > lo) {
+                    next_ranges.push_back({lo, lt - 1});
+                }
+                if (hi > gt + 1) {
+                    next_ranges.push_back({gt + 1, hi});
+                }
+            }
+            ranges.swap(next_ranges);
+        }
+    }
+}
+
+// Named input distributions: a random permutation, few unique keys, sorted, reversed and nearly sorted (1% swapped pairs)
+bool fill_distribution(std::vector<int>& arr, int size, const char* dist, std::mt19937& rng) {
+    if (std::strcmp(dist, "few") == 0) {
+        fill_key_range(arr, size, 16, rng);
+        return true;
+    }
+
+    fill_permutation(arr, size, rng);
+    if (std::strcmp(dist, "random") == 0) {
+        return true;
+    }
+
+    std::sort(arr.begin(), arr.end());
+    if (std::strcmp(dist, "sorted") == 0) {
+        return true;
+    }
+    if (std::strcmp(dist, "reversed") == 0) {
+        std::reverse(arr.begin(), arr.end());
+        return true;
+    }
+    if (std::strcmp(dist, "nearly") == 0) {
+        std::uniform_int_distribution<int> pick(0, size - 1);
+        for (int swaps = std::max(1, size / 100); swaps > 0; --swaps) {
+            std::swap(arr[pick(rng)], arr[pick(rng)]);
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <random> // std::mt19937
+#include <vector> // std::vector
+
+// Inputs for the benchmarks and anything else driving the algorithms headless. Every generator resizes arr to size
+// and draws only from rng, so a seed reproduces the input.
+
+// Uniform keys in [1, key_range]
+void fill_key_range(std::vector<int>& arr, int size, long long key_range, std::mt19937& rng);
+
+// Random permutation of 1..size, the same keys the GUI sorts
+void fill_permutation(std::vector<int>& arr, int size, std::mt19937& rng);
+
+// Permutation whose middle pivots of the first `depth` 3-way partition levels have rank `fraction` in their range
+void fill_skewed(std::vector<int>& arr, int size, int depth, double fraction, std::mt19937& rng);
+
+// Named distributions (random, few, sorted, reversed, nearly), false for an unknown name
+bool fill_distribution(std::vector<int>& arr, int size, const char* dist, std::mt19937& rng);
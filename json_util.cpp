@@ -0,0 +1,87 @@
+#include <cstdlib> // std::strtol()
+#include "json_util.h"
+
+void write_json_string(FILE* file, const std::string& text) {
+    std::fputc('"', file);
+    for (char c : text) {
+        const unsigned char byte = (unsigned char)c;
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+            std::fputc(c, file);
+        } else if (c == '\n') {
+            std::fputs("\\n", file);
+        } else if (c == '\t') {
+            std::fputs("\\t", file);
+        } else if (byte < 0x20) {
+            std::fprintf(file, "\\u%04x", byte);
+        } else {
+            std::fputc(c, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+bool read_json_string(const std::string& text, size_t& pos, std::string& value) {
+    if (pos >= text.size() || text[pos] != '"') {
+        return false;
+    }
+    value.clear();
+    for (++pos; pos < text.size(); ++pos) {
+        const char c = text[pos];
+        if (c == '"') {
+            ++pos;
+            return true;
+        }
+        if (c != '\\' || pos + 1 >= text.size()) {
+            value += c;
+            continue;
+        }
+
+        const char escape = text[++pos];
+        switch (escape) {
+            case 'n':
+                value += '\n';
+                break;
+            case 't':
+                value += '\t';
+                break;
+            case 'r':
+                value += '\r';
+                break;
+            case 'b':
+                value += '\b';
+                break;
+            case 'f':
+                value += '\f';
+                break;
+            case 'u': {
+                if (pos + 4 >= text.size()) {
+                    return false;
+                }
+                const std::string hex = text.substr(pos + 1, 4);
+                char* end = nullptr;
+                const long code = std::strtol(hex.c_str(), &end, 16);
+                if (end != hex.c_str() + 4) {
+                    return false;
+                }
+                pos += 4;
+                // UTF-8, surrogate pairs aren't combined
+                if (code < 0x80) {
+                    value += (char)code;
+                } else if (code < 0x800) {
+                    value += (char)(0xC0 | (code >> 6));
+                    value += (char)(0x80 | (code & 0x3F));
+                } else {
+                    value += (char)(0xE0 | (code >> 12));
+                    value += (char)(0x80 | ((code >> 6) & 0x3F));
+                    value += (char)(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default: // \" \\ \/
+                value += escape;
+                break;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdio> // FILE
+#include <string> // std::string
+
+// Writes text as a quoted JSON string: quotes and backslashes escaped, newlines and tabs as \n and \t, every other
+// byte below 0x20 as \u00XX. Other bytes (UTF-8 included) are written as they are.
+void write_json_string(FILE* file, const std::string& text);
+
+// Reads the quoted JSON string starting at text[pos] and decodes its escapes into value. pos ends up just past the
+// closing quote. False if there is no string at pos or it isn't terminated.
+bool read_json_string(const std::string& text, size_t& pos, std::string& value);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint> // uint8_t
+
+// Bar chart colors, shared by the GUI and the frame exporter so an exported run looks like the window
+struct PaletteColor {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+static const PaletteColor PALETTE_BACKGROUND = {13, 13, 13};
+static const PaletteColor PALETTE_BAR = {220, 220, 220};
+static const PaletteColor PALETTE_HIGHLIGHT1 = {255, 60, 60};
+static const PaletteColor PALETTE_HIGHLIGHT2 = {255, 200, 0};
+
+// Bars in the region owned by each worker of a parallel algorithm, worker % PALETTE_WORKER_COUNT
+static const PaletteColor PALETTE_WORKERS[] = {
+    {90, 160, 255},
+    {110, 220, 120},
+    {200, 130, 255},
+    {255, 150, 80},
+    {80, 220, 220},
+    {240, 110, 180},
+    {190, 200, 90},
+    {160, 160, 255},
+};
+static const int PALETTE_WORKER_COUNT = (int)(sizeof(PALETTE_WORKERS) / sizeof(PALETTE_WORKERS[0]));
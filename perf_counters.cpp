@@ -0,0 +1,127 @@
+#include <cstdio> // std::snprintf()
+#include <cstring> // std::strerror()
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <cerrno> // errno
+#include <linux/perf_event.h> // perf_event_attr, PERF_COUNT_HW_*
+#include <sys/ioctl.h> // ioctl()
+#include <sys/syscall.h> // SYS_perf_event_open
+#include <unistd.h> // syscall(), read(), close()
+#endif
+
+const char* perf_event_name(PerfEvent event) {
+    switch (event) {
+    case PerfEvent::Cycles:
+        return "cycles";
+    case PerfEvent::Instructions:
+        return "instructions";
+    case PerfEvent::LlcMisses:
+        return "LLC misses";
+    case PerfEvent::BranchMisses:
+        return "branch misses";
+    }
+    return "?";
+}
+
+#ifdef __linux__
+
+namespace {
+
+const unsigned long long EVENT_CONFIGS[PERF_EVENT_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+    m_reason[0] = '\0';
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = EVENT_CONFIGS[i];
+        attr.disabled = 1;
+        attr.inherit = 1; // Worker threads of the parallel sorts count too
+        attr.exclude_kernel = 1; // Allowed up to perf_event_paranoid 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        m_fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (m_fds[i] < 0 && m_reason[0] == '\0') {
+            std::snprintf(m_reason, sizeof(m_reason), "perf_event_open(%s): %s", perf_event_name((PerfEvent)i), std::strerror(errno));
+        }
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : m_fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+bool PerfCounters::available() const {
+    for (int fd : m_fds) {
+        if (fd >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PerfCounters::start() {
+    for (int fd : m_fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample sample;
+    for (int fd : m_fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+        unsigned long long data[3] = {}; // Value, time enabled, time running
+        if (m_fds[i] < 0 || read(m_fds[i], data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0) {
+            continue;
+        }
+        sample.values[i] = (long long)((double)data[0] * ((double)data[1] / (double)data[2]));
+        sample.valid[i] = true;
+    }
+    return sample;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    for (int& fd : m_fds) {
+        fd = -1;
+    }
+    std::snprintf(m_reason, sizeof(m_reason), "hardware counters need Linux perf_event_open");
+}
+
+PerfCounters::~PerfCounters() {}
+
+bool PerfCounters::available() const {
+    return false;
+}
+
+void PerfCounters::start() {}
+
+PerfSample PerfCounters::stop() {
+    return PerfSample();
+}
+
+#endif
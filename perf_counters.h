@@ -0,0 +1,51 @@
+#pragma once
+
+// Hardware events counted around a region of code
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    LlcMisses, // Last-level cache misses
+    BranchMisses,
+};
+
+static constexpr int PERF_EVENT_COUNT = 4;
+
+const char* perf_event_name(PerfEvent event);
+
+struct PerfSample {
+    long long values[PERF_EVENT_COUNT] = {};
+    bool valid[PERF_EVENT_COUNT] = {}; // False for events the kernel or the CPU wouldn't count
+
+    bool has(PerfEvent event) const {
+        return valid[(int)event];
+    }
+    long long get(PerfEvent event) const {
+        return values[(int)event];
+    }
+};
+
+// User-space hardware counters of this process through Linux perf_event_open, threads started after construction
+// included. Each event is opened on its own, so a missing one (no PMU in a VM or container, perf_event_paranoid,
+// a CPU without the event) only invalidates that one. On other systems nothing is ever available.
+// Counts are scaled up when the kernel had to multiplex the counters.
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // True if at least one event can be counted, otherwise unavailable_reason() says why the first one failed
+    bool available() const;
+    const char* unavailable_reason() const {
+        return m_reason;
+    }
+
+    void start();
+    PerfSample stop();
+
+private:
+    int m_fds[PERF_EVENT_COUNT];
+    char m_reason[128];
+};
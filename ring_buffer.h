@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef> // size_t
+#include <vector> // std::vector
+
+// Fixed-capacity history where a push past capacity overwrites the oldest value
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) : m_data(capacity) {}
+
+    void push(const T& value) {
+        m_data[m_head] = value;
+        m_head = (m_head + 1) % m_data.size();
+        if (m_size < m_data.size()) {
+            ++m_size;
+        }
+    }
+
+    void clear() {
+        m_head = 0;
+        m_size = 0;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+    size_t capacity() const {
+        return m_data.size();
+    }
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    // i-th oldest value
+    const T& operator[](size_t i) const {
+        return m_data[(m_head + m_data.size() - m_size + i) % m_data.size()];
+    }
+    const T& back() const {
+        return m_data[(m_head + m_data.size() - 1) % m_data.size()];
+    }
+
+    // Raw storage and the index of the oldest value in it, the way ImGui::PlotLines() takes a history
+    const T* data() const {
+        return m_data.data();
+    }
+    size_t offset() const {
+        return (m_size < m_data.size()) ? 0 : m_head;
+    }
+
+private:
+    std::vector<T> m_data;
+    size_t m_head = 0; // Next slot to write
+    size_t m_size = 0;
+};
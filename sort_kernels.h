@@ -0,0 +1,745 @@
+#pragma once
+
+#include <algorithm> // std::min(), std::rotate()
+#include <cstddef> // size_t
+#include <utility> // std::swap()
+#include <vector> // std::vector
+#include "sorting_network.h"
+
+// How Quick Sort and Merge Sort finish the ranges at or below their leaf threshold
+enum class LeafSort {
+    Insertion,
+    Network, // Compile-time sorting network, thresholds up to MAX_SMALL_NETWORK
+};
+
+static constexpr int DEFAULT_LEAF_THRESHOLD = 4;
+
+inline const char* leaf_sort_name(LeafSort leaf) {
+    return (leaf == LeafSort::Network) ? "network" : "insertion";
+}
+
+// Native (non-stepped) kernels, templated on the key type so the bench can tune the leaf stage per type.
+// They mirror the stepped algorithms: Quick Sort with a middle pivot and 3-way partition, bottom-up Merge Sort.
+
+template <typename T>
+inline void insertion_sort(T* arr, int size) {
+    for (int i = 1; i < size; ++i) {
+        const T value = arr[i];
+        int j = i;
+        for (; j > 0 && value < arr[j - 1]; --j) {
+            arr[j] = arr[j - 1];
+        }
+        arr[j] = value;
+    }
+}
+
+template <typename T>
+inline void leaf_sort(T* arr, int size, LeafSort leaf) {
+    if (leaf == LeafSort::Network && size <= MAX_SMALL_NETWORK) {
+        small_network_sort(arr, size);
+    } else {
+        insertion_sort(arr, size);
+    }
+}
+
+// Dijkstra 3-way partition around the middle element, leaving arr[lt..gt] equal to the pivot
+template <typename T>
+inline void partition_3way(T* arr, int lo, int hi, int& lt, int& gt) {
+    const T pivot = arr[lo + ((hi - lo) / 2)];
+    int i = lo;
+    lt = lo;
+    gt = hi;
+    while (i <= gt) {
+        if (arr[i] < pivot) {
+            std::swap(arr[lt++], arr[i++]);
+        } else if (pivot < arr[i]) {
+            std::swap(arr[i], arr[gt--]);
+        } else {
+            ++i;
+        }
+    }
+}
+
+// Returns the peak number of pending ranges on the explicit stack
+template <typename T>
+size_t quick_sort_3way(T* arr, int size, LeafSort leaf, int threshold) {
+    struct Range {
+        int lo;
+        int hi;
+    };
+
+    threshold = std::max(1, threshold);
+    std::vector<Range> stack;
+    stack.push_back({0, size - 1});
+    size_t stack_peak = 1;
+    while (!stack.empty()) {
+        const Range range = stack.back();
+        stack.pop_back();
+
+        const int range_size = range.hi - range.lo + 1;
+        if (range_size <= threshold) {
+            if (range_size > 1) {
+                leaf_sort(arr + range.lo, range_size, leaf);
+            }
+            continue;
+        }
+
+        int lt = 0;
+        int gt = 0;
+        partition_3way(arr, range.lo, range.hi, lt, gt);
+
+        // Smaller side on top keeps the stack logarithmic
+        const Range left = {range.lo, lt - 1};
+        const Range right = {gt + 1, range.hi};
+        if (lt - range.lo < range.hi - gt) {
+            stack.push_back(right);
+            stack.push_back(left);
+        } else {
+            stack.push_back(left);
+            stack.push_back(right);
+        }
+        stack_peak = std::max(stack_peak, stack.size());
+    }
+    return stack_peak;
+}
+
+// Merges src[left, mid) and src[mid, right) into dst[left, right)
+template <typename T>
+inline void merge_runs(const T* src, T* dst, int left, int mid, int right) {
+    int i = left;
+    int j = mid;
+    int k = left;
+    while (i < mid && j < right) {
+        dst[k++] = (src[j] < src[i]) ? src[j++] : src[i++];
+    }
+    while (i < mid) {
+        dst[k++] = src[i++];
+    }
+    while (j < right) {
+        dst[k++] = src[j++];
+    }
+}
+
+// Runs of `threshold` elements are leaf sorted, then merged into the buffer and copied back, width doubling each pass.
+// Returns the element writes of the merge passes (the leaf stage is not counted).
+template <typename T>
+long long merge_sort_bottom_up(T* arr, T* buffer, int size, LeafSort leaf, int threshold) {
+    const int width = std::max(1, threshold);
+    for (int lo = 0; lo < size; lo += width) {
+        leaf_sort(arr + lo, std::min(width, size - lo), leaf);
+    }
+
+    long long writes = 0;
+    for (int run = width; run < size; run *= 2) {
+        for (int left = 0; left < size - run; left += 2 * run) {
+            const int right = std::min(left + (2 * run), size);
+            merge_runs(arr, buffer, left, left + run, right);
+            std::copy(buffer + left, buffer + right, arr + left);
+            writes += 2LL * (right - left);
+        }
+    }
+    return writes;
+}
+
+// Same passes, but each one reads from the array it last wrote to, so nothing is copied back per pass.
+// A lone tail run is carried over to keep the destination complete, and an odd pass count costs one final copy.
+template <typename T>
+long long merge_sort_ping_pong(T* arr, T* buffer, int size, LeafSort leaf, int threshold) {
+    const int width = std::max(1, threshold);
+    for (int lo = 0; lo < size; lo += width) {
+        leaf_sort(arr + lo, std::min(width, size - lo), leaf);
+    }
+
+    long long writes = 0;
+    T* src = arr;
+    T* dst = buffer;
+    for (int run = width; run < size; run *= 2) {
+        for (int left = 0; left < size; left += 2 * run) {
+            merge_runs(src, dst, left, std::min(left + run, size), std::min(left + (2 * run), size));
+        }
+        writes += size;
+        std::swap(src, dst);
+    }
+
+    if (src != arr) {
+        std::copy(src, src + size, arr);
+        writes += size;
+    }
+    return writes;
+}
+
+// Gapped insertion sort, one pass per gap (gaps in descending order, ending with 1)
+template <typename T>
+void shell_sort(T* arr, int size, const std::vector<int>& gaps) {
+    for (int gap : gaps) {
+        for (int i = gap; i < size; ++i) {
+            const T value = arr[i];
+            int j = i;
+            for (; j >= gap && value < arr[j - gap]; j -= gap) {
+                arr[j] = arr[j - gap];
+            }
+            arr[j] = value;
+        }
+    }
+}
+
+// One compare-exchange pass per gap, then passes with gap 1 until nothing moves
+template <typename T>
+void comb_sort(T* arr, int size, const std::vector<int>& gaps) {
+    size_t gap_idx = 0;
+    while (gap_idx < gaps.size()) {
+        const int gap = gaps[gap_idx];
+        bool swapped = false;
+        for (int i = 0; i + gap < size; ++i) {
+            if (arr[i + gap] < arr[i]) {
+                std::swap(arr[i], arr[i + gap]);
+                swapped = true;
+            }
+        }
+        if (gap_idx + 1 < gaps.size()) {
+            ++gap_idx;
+        } else if (!swapped) {
+            break;
+        }
+    }
+}
+
+// Pending merge of [lo, mid) and [mid, hi)
+struct MergeFrame {
+    int lo = 0;
+    int mid = 0;
+    int hi = 0;
+};
+
+// SymMerge (Kim & Kutzner): a binary search finds the split where the middle blocks trade places, one rotation swaps
+// them and the two sides become independent merges. Stable and in place, the stack of pending merges stays O(log n).
+template <typename T>
+void sym_merge(T* arr, const MergeFrame& merge, std::vector<MergeFrame>& stack, size_t& stack_peak) {
+    stack.push_back(merge);
+    stack_peak = std::max(stack_peak, stack.size());
+    while (!stack.empty()) {
+        const MergeFrame frame = stack.back();
+        stack.pop_back();
+
+        const int half = frame.lo + ((frame.hi - frame.lo) / 2);
+        const int n = half + frame.mid;
+        int start = (frame.mid > half) ? (n - frame.hi) : frame.lo;
+        int r = (frame.mid > half) ? half : frame.mid;
+        while (start < r) {
+            const int c = start + ((r - start) / 2);
+            if (!(arr[n - 1 - c] < arr[c])) {
+                start = c + 1;
+            } else {
+                r = c;
+            }
+        }
+
+        const int end = n - start;
+        if (start < frame.mid && frame.mid < end) {
+            std::rotate(arr + start, arr + frame.mid, arr + end);
+        }
+        if (frame.lo < start && start < half) {
+            stack.push_back({frame.lo, start, half});
+        }
+        if (half < end && end < frame.hi) {
+            stack.push_back({half, end, frame.hi});
+        }
+        stack_peak = std::max(stack_peak, stack.size());
+    }
+}
+
+// Bottom-up passes of SymMerge over insertion-sorted runs. Returns the peak number of pending merges.
+template <typename T>
+size_t merge_sort_in_place(T* arr, int size, int threshold) {
+    const int width = std::max(1, threshold);
+    for (int lo = 0; lo < size; lo += width) {
+        insertion_sort(arr + lo, std::min(width, size - lo));
+    }
+
+    std::vector<MergeFrame> stack;
+    size_t stack_peak = 0;
+    for (int run = width; run < size; run *= 2) {
+        for (int left = 0; left < size - run; left += 2 * run) {
+            sym_merge(arr, {left, left + run, std::min(left + (2 * run), size)}, stack, stack_peak);
+        }
+    }
+    return stack_peak;
+}
+
+// Block merge sort with an internal buffer (Astrelin's GrailSort, the WikiSort/GrailSort class of Kim & Kutzner):
+// stable and in place with O(1) extra memory. It first gathers about 2 sqrt(n) distinct keys at the front: sqrt(n)
+// become a buffer the merges swap elements through, the rest tag the blocks of a merge so they can be reordered by
+// their first elements and still be told apart. Runs up to twice the buffer are merged through it directly, longer
+// ones as blocks of sqrt(n). Every move is a swap, so the buffer and tag keys are merely permuted and get sorted and
+// merged back in at the end. The block_merge_* helpers are its steps.
+
+// Swaps [a, a + count) with [b, b + count)
+template <typename T>
+inline void block_merge_swap_n(T* a, T* b, int count) {
+    for (int i = 0; i < count; ++i) {
+        std::swap(a[i], b[i]);
+    }
+}
+
+// Rotates [arr, arr + left) past [arr + left, arr + left + right) with block swaps
+template <typename T>
+void block_merge_rotate(T* arr, int left, int right) {
+    while (left > 0 && right > 0) {
+        if (left <= right) {
+            block_merge_swap_n(arr, arr + left, left);
+            arr += left;
+            right -= left;
+        } else {
+            block_merge_swap_n(arr + (left - right), arr + left, right);
+            left -= right;
+        }
+    }
+}
+
+// First index in [0, size) whose element isn't less than key (right: is greater than key), size if none
+template <typename T>
+int block_merge_search_left(const T* arr, int size, const T& key) {
+    int lo = 0;
+    int hi = size;
+    while (lo < hi) {
+        const int mid = lo + ((hi - lo) / 2);
+        if (arr[mid] < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+template <typename T>
+int block_merge_search_right(const T* arr, int size, const T& key) {
+    int lo = 0;
+    int hi = size;
+    while (lo < hi) {
+        const int mid = lo + ((hi - lo) / 2);
+        if (key < arr[mid]) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+// Moves the first occurrences of up to wanted distinct keys to the front, sorted, the rest keeping its order.
+// Returns how many it found.
+template <typename T>
+int block_merge_find_keys(T* arr, int size, int wanted) {
+    int found = 1;
+    int first = 0; // The keys found so far are [first, first + found), just before the element looked at
+    for (int i = 1; i < size && found < wanted; ++i) {
+        const int r = block_merge_search_left(arr + first, found, arr[i]);
+        if (r == found || arr[i] < arr[first + r]) {
+            block_merge_rotate(arr + first, found, i - (first + found));
+            first = i - found;
+            block_merge_rotate(arr + first + r, found - r, 1);
+            ++found;
+        }
+    }
+    block_merge_rotate(arr, first, found);
+    return found;
+}
+
+// Merges [arr, arr + left) and [arr + left, arr + left + right) into arr + offset (negative, a buffer of at least
+// right elements to the left), swapping the buffer to the end
+template <typename T>
+void block_merge_left(T* arr, int left, int right, int offset) {
+    int i = 0;
+    int j = left;
+    const int end = left + right;
+    while (j < end) {
+        if (i == left || arr[j] < arr[i]) {
+            std::swap(arr[offset++], arr[j++]);
+        } else {
+            std::swap(arr[offset++], arr[i++]);
+        }
+    }
+    if (offset != i) {
+        block_merge_swap_n(arr + offset, arr + i, left - i);
+    }
+}
+
+// The mirror image: the buffer of at least left elements follows at arr + left + right, the output ends there
+template <typename T>
+void block_merge_right(T* arr, int left, int right, int buffer) {
+    int out = left + right + buffer - 1;
+    int j = left + right - 1;
+    int i = left - 1;
+    while (i >= 0) {
+        if (j < left || arr[j] < arr[i]) {
+            std::swap(arr[out--], arr[i--]);
+        } else {
+            std::swap(arr[out--], arr[j--]);
+        }
+    }
+    if (j != out) {
+        while (j >= left) {
+            std::swap(arr[out--], arr[j--]);
+        }
+    }
+}
+
+// Merges the pending fragment [arr, arr + rest) of origin (0: left run, 1: right run) with the block of block_size
+// after it, through the buffer of block_size before it. Ties go to the left run. What isn't merged yet becomes the
+// fragment: the fragment's tail moved to the block's end, or the block's tail with the other origin.
+template <typename T>
+void block_merge_smart(T* arr, int& rest, int& origin, int block_size) {
+    T* out = arr - block_size;
+    T* a = arr;
+    T* a_end = arr + rest;
+    T* b = a_end;
+    T* b_end = b + block_size;
+    const bool left_fragment = (origin == 0);
+    while (a < a_end && b < b_end) {
+        if (left_fragment ? !(*b < *a) : (*a < *b)) {
+            std::swap(*out++, *a++);
+        } else {
+            std::swap(*out++, *b++);
+        }
+    }
+    if (a < a_end) {
+        rest = (int)(a_end - a);
+        while (a < a_end) {
+            std::swap(*--a_end, *--b_end);
+        }
+    } else {
+        rest = (int)(b_end - b);
+        origin = 1 - origin;
+    }
+}
+
+// Merges the sorted blocks of a run pair left to right through the buffer before them. Blocks tagged below mid_key
+// come from the left run. The last blocks (trailing) are left-run blocks past the first element of the partial
+// block of last elements, both are merged once the full blocks are done.
+template <typename T>
+void block_merge_buffers_left(const T* keys, const T& mid_key, T* arr, int blocks, int block_size, int trailing, int last) {
+    if (blocks == 0) {
+        block_merge_left(arr, trailing * block_size, last, -block_size);
+        return;
+    }
+
+    int rest = block_size;
+    int origin = (keys[0] < mid_key) ? 0 : 1;
+    int pos = block_size;
+    for (int b = 1; b < blocks; ++b, pos += block_size) {
+        const int start = pos - rest;
+        const int next_origin = (keys[b] < mid_key) ? 0 : 1;
+        if (next_origin == origin) {
+            // The fragment can't interleave with a block of its own run, so it is final
+            block_merge_swap_n(arr + start - block_size, arr + start, rest);
+            rest = block_size;
+        } else {
+            block_merge_smart(arr + start, rest, origin, block_size);
+        }
+    }
+
+    int start = pos - rest;
+    if (last != 0) {
+        if (origin != 0) {
+            block_merge_swap_n(arr + start - block_size, arr + start, rest);
+            start = pos;
+            rest = block_size * trailing;
+        } else {
+            rest += block_size * trailing;
+        }
+        block_merge_left(arr + start, rest, last, -block_size);
+    } else {
+        block_merge_swap_n(arr + start, arr + start - block_size, rest);
+    }
+}
+
+// Merges the pairs of sorted runs of length run in [arr, arr + size), the buffer of block_size right before arr. The
+// blocks of a pair are selection sorted by their first elements (ties by tag, so the left run's go first) while the
+// tags at keys follow them, then merged. The buffer ends up behind the data and is shifted back.
+template <typename T>
+void block_merge_combine(T* keys, T* arr, int size, int run, int block_size) {
+    const int pairs = size / (2 * run);
+    int leftover = size % (2 * run);
+    if (leftover <= run) {
+        size -= leftover; // A lone sorted run stays where it is
+        leftover = 0;
+    }
+
+    for (int p = 0; p <= pairs; ++p) {
+        if (p == pairs && leftover == 0) {
+            break;
+        }
+        T* pair = arr + (p * 2 * run);
+        const int blocks = ((p == pairs) ? leftover : 2 * run) / block_size;
+        insertion_sort(keys, blocks + ((p == pairs) ? 1 : 0));
+
+        int mid = run / block_size;
+        for (int u = 1; u < blocks; ++u) {
+            int min = u - 1;
+            for (int v = u; v < blocks; ++v) {
+                if (pair[v * block_size] < pair[min * block_size] ||
+                    (!(pair[min * block_size] < pair[v * block_size]) && keys[v] < keys[min])) {
+                    min = v;
+                }
+            }
+            if (min != u - 1) {
+                block_merge_swap_n(pair + (u - 1) * block_size, pair + min * block_size, block_size);
+                std::swap(keys[u - 1], keys[min]);
+                if (mid == u - 1 || mid == min) {
+                    mid ^= (u - 1) ^ min;
+                }
+            }
+        }
+
+        int trailing = 0;
+        const int last = (p == pairs) ? leftover % block_size : 0;
+        if (last != 0) {
+            while (trailing < blocks && pair[blocks * block_size] < pair[(blocks - trailing - 1) * block_size]) {
+                ++trailing;
+            }
+        }
+        block_merge_buffers_left(keys, keys[mid], pair, blocks - trailing, block_size, trailing, last);
+    }
+    for (int i = size - 1; i >= 0; --i) {
+        std::swap(arr[i], arr[i - block_size]);
+    }
+}
+
+// Sorts [arr, arr + size) into runs of 2 * buffer, the buffer right before arr. Pairs and the first levels are
+// merged left, moving the buffer to the end, the last level right, moving it back.
+template <typename T>
+void block_merge_build(T* arr, int size, int buffer) {
+    for (int m = 1; m < size; m += 2) {
+        const int u = (arr[m] < arr[m - 1]) ? 1 : 0;
+        std::swap(arr[m - 3], arr[m - 1 + u]);
+        std::swap(arr[m - 2], arr[m - u]);
+    }
+    if (size % 2 != 0) {
+        std::swap(arr[size - 1], arr[size - 3]);
+    }
+    arr -= 2;
+
+    for (int h = 2; h < buffer; h *= 2) {
+        int p = 0;
+        for (; p <= size - 2 * h; p += 2 * h) {
+            block_merge_left(arr + p, h, h, -h);
+        }
+        const int rest = size - p;
+        if (rest > h) {
+            block_merge_left(arr + p, h, rest - h, -h);
+        } else {
+            block_merge_rotate(arr + p - h, h, rest);
+        }
+        arr -= h;
+    }
+
+    const int rest = size % (2 * buffer);
+    int p = size - rest;
+    if (rest <= buffer) {
+        block_merge_rotate(arr + p, rest, buffer);
+    } else {
+        block_merge_right(arr + p, buffer, rest - buffer, buffer);
+    }
+    while (p > 0) {
+        p -= 2 * buffer;
+        block_merge_right(arr + p, buffer, buffer, buffer);
+    }
+}
+
+// Merges a short sorted [arr, arr + left) into [arr + left, arr + left + right) with binary searches and rotations,
+// O(right + left^2) moves
+template <typename T>
+void block_merge_without_buffer(T* arr, int left, int right) {
+    while (left > 0) {
+        const int h = block_merge_search_left(arr + left, right, arr[0]);
+        if (h != 0) {
+            block_merge_rotate(arr, left, h);
+            arr += h;
+            right -= h;
+        }
+        if (right == 0) {
+            break;
+        }
+        do {
+            ++arr;
+            --left;
+        } while (left > 0 && !(arr[left] < arr[0]));
+    }
+}
+
+static constexpr int BLOCK_MERGE_MIN_SIZE = 16; // Below this it is an insertion sort
+
+// Block size (a power of two, about sqrt(size)) and the distinct keys the block merge needs: the buffer plus a tag
+// per block
+inline int block_merge_block_size(int size) {
+    int block = 1;
+    while (block * block < size) {
+        block *= 2;
+    }
+    return block;
+}
+
+inline int block_merge_keys_wanted(int size) {
+    const int block = block_merge_block_size(size);
+    return block + ((size - 1) / block) + 1;
+}
+
+// Returns false when there are fewer distinct keys than the buffer and tags need. The keys found are gathered at
+// the front by then (in a stable way), for the caller to finish with rotation merges.
+template <typename T>
+bool block_merge_sort(T* arr, int size) {
+    if (size < BLOCK_MERGE_MIN_SIZE) {
+        insertion_sort(arr, size);
+        return true;
+    }
+
+    const int block = block_merge_block_size(size);
+    const int wanted = block_merge_keys_wanted(size);
+    if (block_merge_find_keys(arr, size, wanted) < wanted) {
+        return false;
+    }
+
+    const int start = wanted; // Tags, then the buffer, then the data
+    block_merge_build(arr + start, size - start, block);
+    for (int run = 2 * block; size - start > run; run *= 2) {
+        block_merge_combine(arr, arr + start, size - start, run, block);
+    }
+
+    insertion_sort(arr, start);
+    block_merge_without_buffer(arr, start, size - start);
+    return true;
+}
+
+#if defined(__GNUC__)
+#define VSORT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define VSORT_PREFETCH(addr) ((void)(addr))
+#endif
+
+// Sifts value from root down a D-ary max-heap of arr[0, size). Top-down compares it against the larger child at every
+// level (D comparisons), Floyd's bottom-up walks the larger children down to a leaf (D - 1 per level) and climbs back,
+// which pays off because a value taken from the bottom usually belongs near the bottom again. With prefetch on, the
+// grandchildren are requested while the children are compared, so the next level is in cache once it is reached.
+template <int D, typename T>
+inline void heap_sift(T* arr, int root, T value, int size, bool bottom_up, bool prefetch, long long& comparisons) {
+    static constexpr int LINE_ELEMENTS = (64 / sizeof(T)) > 0 ? (int)(64 / sizeof(T)) : 1;
+
+    int hole = root;
+    while (true) {
+        const int first = (D * hole) + 1;
+        if (first >= size) {
+            break;
+        }
+
+        if (prefetch) {
+            const int grandchild = (D * first) + 1;
+            for (int k = 0; k < D * D && grandchild + k < size; k += LINE_ELEMENTS) {
+                VSORT_PREFETCH(arr + grandchild + k);
+            }
+        }
+
+        const int last = std::min(first + D, size);
+        int best = first;
+        for (int child = first + 1; child < last; ++child) {
+            ++comparisons;
+            if (arr[best] < arr[child]) {
+                best = child;
+            }
+        }
+
+        if (!bottom_up) {
+            ++comparisons;
+            if (!(value < arr[best])) {
+                break;
+            }
+        }
+        arr[hole] = arr[best];
+        hole = best;
+    }
+
+    if (bottom_up) {
+        while (hole > root) {
+            const int parent = (hole - 1) / D;
+            ++comparisons;
+            if (!(arr[parent] < value)) {
+                break;
+            }
+            arr[hole] = arr[parent];
+            hole = parent;
+        }
+    }
+    arr[hole] = value;
+}
+
+// Returns the number of key comparisons
+template <int D, typename T>
+long long heap_sort_dary(T* arr, int size, bool bottom_up, bool prefetch) {
+    long long comparisons = 0;
+    if (size < 2) {
+        return comparisons;
+    }
+
+    for (int i = (size - 2) / D; i >= 0; --i) {
+        heap_sift<D>(arr, i, arr[i], size, bottom_up, prefetch, comparisons);
+    }
+    for (int end = size - 1; end > 0; --end) {
+        const T value = arr[end];
+        arr[end] = arr[0];
+        heap_sift<D>(arr, 0, value, end, bottom_up, prefetch, comparisons);
+    }
+    return comparisons;
+}
+
+// Heap Sort with a runtime arity of 2, 4 or 8
+template <typename T>
+long long heap_sort(T* arr, int size, int arity, bool bottom_up, bool prefetch) {
+    switch (arity) {
+        case 8:
+            return heap_sort_dary<8>(arr, size, bottom_up, prefetch);
+        case 4:
+            return heap_sort_dary<4>(arr, size, bottom_up, prefetch);
+        default:
+            return heap_sort_dary<2>(arr, size, bottom_up, prefetch);
+    }
+}
+
+// Cycle Sort: every element is written straight to its final position (its rank among the rest), so each one moves
+// at most once and the write count is the minimum possible. Quadratic comparisons pay for that. Returns the writes.
+template <typename T>
+long long cycle_sort(T* arr, int size) {
+    long long writes = 0;
+    for (int start = 0; start < size - 1; ++start) {
+        T item = arr[start];
+        int pos = start;
+        for (int i = start + 1; i < size; ++i) {
+            if (arr[i] < item) {
+                ++pos;
+            }
+        }
+        if (pos == start) {
+            continue;
+        }
+
+        // Equal keys go after the ones already placed, then the displaced element is carried around the cycle
+        while (!(item < arr[pos]) && !(arr[pos] < item)) {
+            ++pos;
+        }
+        std::swap(item, arr[pos]);
+        ++writes;
+        while (pos != start) {
+            pos = start;
+            for (int i = start + 1; i < size; ++i) {
+                if (arr[i] < item) {
+                    ++pos;
+                }
+            }
+            while (!(item < arr[pos]) && !(arr[pos] < item)) {
+                ++pos;
+            }
+            std::swap(item, arr[pos]);
+            ++writes;
+        }
+    }
+    return writes;
+}
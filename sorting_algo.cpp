@@ -1,5 +1,170 @@
 #include <algorithm> // std::swap()
+#include <climits> // INT_MAX, INT_MIN
+#include <cstdio> // std::snprintf()
+#include <cstring> // std::strcmp()
+#include <mutex> // std::mutex, std::lock_guard
+#include <random> // std::mt19937
+#include <thread> // std::thread
+#include <utility> // std::pair
 #include "sorting_algo.h"
+#include "sorting_network.h"
+
+namespace {
+
+// Runs fn(worker) once per worker on its own thread, the calling thread acting as worker 0
+template <typename Fn>
+void run_workers(int count, const Fn& fn) {
+    std::vector<std::thread> threads;
+    threads.reserve(count > 1 ? count - 1 : 0);
+    for (int worker = 1; worker < count; ++worker) {
+        threads.emplace_back(fn, worker);
+    }
+    fn(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+int clamp_leaf_threshold(LeafSort leaf, int threshold) {
+    threshold = std::max(1, threshold);
+    return (leaf == LeafSort::Network) ? std::min(threshold, MAX_SMALL_NETWORK) : threshold;
+}
+
+// Shared by Quick Sort and Merge Sort. The leaf kind comes first so a tuned threshold is clamped against the right kind.
+std::vector<AlgoParam> leaf_params(LeafSort leaf, int threshold) {
+    return {
+        {"network_leaf", (leaf == LeafSort::Network) ? 1.0 : 0.0, 0.0, 1.0, 1.0},
+        {"leaf_threshold", (double)threshold, 2.0, (double)MAX_SMALL_NETWORK, 2.0},
+    };
+}
+
+bool set_leaf_param(const char* name, double value, LeafSort& leaf, int& threshold) {
+    if (std::strcmp(name, "network_leaf") == 0) {
+        leaf = (value != 0.0) ? LeafSort::Network : LeafSort::Insertion;
+    } else if (std::strcmp(name, "leaf_threshold") == 0) {
+        threshold = (int)(value + 0.5);
+    } else {
+        return false;
+    }
+    threshold = clamp_leaf_threshold(leaf, threshold);
+    return true;
+}
+
+// Depth of the splitter tree for a power-of-two bucket count
+int splitter_tree_levels(int buckets) {
+    int levels = 0;
+    while ((1 << levels) < buckets) {
+        ++levels;
+    }
+    return levels;
+}
+
+// Lays the sorted splitters out as an implicit search tree, the children of node j at 2j and 2j + 1
+void build_splitter_tree(const std::vector<int>& splitters, int lo, int hi, int node, std::vector<int>& tree) {
+    if (lo >= hi) {
+        return;
+    }
+
+    const int mid = lo + ((hi - lo) / 2);
+    tree[node] = splitters[mid];
+    build_splitter_tree(splitters, lo, mid, 2 * node, tree);
+    build_splitter_tree(splitters, mid + 1, hi, (2 * node) + 1, tree);
+}
+
+// Sorts a random sample of oversampling * buckets - 1 elements and keeps evenly spaced ones as the buckets - 1
+// splitters, so the bucket sizes stay close to size / buckets. splitters gets them in order plus a copy of the last
+// one (see classify_equal()). Returns the comparisons spent sorting the sample.
+long long pick_splitters(const int* arr, int size, int buckets, int oversampling, std::vector<int>& splitters,
+    std::vector<int>& tree) {
+    std::mt19937 rng((unsigned int)size);
+    std::uniform_int_distribution<int> index(0, size - 1);
+    std::vector<int> sample((oversampling * buckets) - 1);
+    for (int& value : sample) {
+        value = arr[index(rng)];
+    }
+
+    long long compares = 0;
+    std::sort(sample.begin(), sample.end(), [&compares](int a, int b) {
+        ++compares;
+        return a < b;
+    });
+
+    splitters.resize(buckets - 1);
+    for (int i = 0; i < buckets - 1; ++i) {
+        splitters[i] = sample[(((size_t)i + 1) * sample.size()) / buckets];
+    }
+    tree.assign(buckets, 0);
+    build_splitter_tree(splitters, 0, buckets - 1, 1, tree);
+    splitters.push_back(splitters.empty() ? 0 : splitters.back());
+    return compares;
+}
+
+// Bucket of value, i.e. the number of splitters below it. The comparison result becomes the next child's offset,
+// so the walk has no branch on the keys to mispredict.
+inline int classify(const int* tree, int levels, int value) {
+    int node = 1;
+    for (int level = 0; level < levels; ++level) {
+        node = (2 * node) + (int)(tree[node] < value);
+    }
+    return node - (1 << levels);
+}
+
+// Bucket 2b + 1 of classify()'s bucket b holds the keys equal to its upper splitter, 2b the rest. A key only lands
+// in the last bucket when it is above every splitter, so the padded copy of the last one never matches there.
+// Repeated splitters make equal keys pile up in one equality bucket, which is already sorted.
+inline int classify_equal(const int* tree, const int* splitters, int levels, int value) {
+    const int b = classify(tree, levels, value);
+    return (2 * b) + (int)(splitters[b] == value);
+}
+
+} // namespace
+
+/* SORTING ALGO BASE IMPLEMENTATION */
+void SortingAlgo::sort(std::vector<int>& arr) {
+    reset((int)arr.size());
+    while (!step(arr).done) {}
+}
+
+const std::vector<SortRegion>& SortingAlgo::regions() const {
+    static const std::vector<SortRegion> no_regions;
+    return no_regions;
+}
+
+std::vector<AlgoParam> SortingAlgo::params() const {
+    return {};
+}
+
+bool SortingAlgo::set_param(const char* name, double value) {
+    (void)name;
+    (void)value;
+    return false;
+}
+
+size_t SortingAlgo::aux_memory_bytes() const {
+    return 0;
+}
+
+const char* SortingAlgo::phase() const {
+    return "sort";
+}
+
+SortRunTotals run_steps(SortingAlgo& algo, std::vector<int>& arr) {
+    SortRunTotals totals;
+    algo.reset((int)arr.size());
+    while (true) {
+        const SortStepResult step_result = algo.step(arr);
+        if (step_result.compared) {
+            totals.compares += std::max(1, step_result.compare_count);
+        }
+        if (step_result.swapped) {
+            totals.swaps += std::max(1, step_result.swap_count);
+        }
+        totals.writes += step_result.write_count;
+        if (step_result.done) {
+            return totals;
+        }
+    }
+}
 
 /* BUBBLE SORT IMPLEMENTATION */
 const char* BubbleSort::name() const {
@@ -33,9 +198,12 @@ SortStepResult BubbleSort::step(std::vector<int>& arr) {
     result.hi1 = m_j;
     result.hi2 = m_j + 1;
     result.compared = true;
+    count_compare(m_j, m_j + 1);
     if (arr[m_j] > arr[m_j + 1]) {
         std::swap(arr[m_j], arr[m_j + 1]);
+        count_swap(m_j, m_j + 1);
         result.swapped = true;
+        result.write_count = 2;
         m_swapped_in_pass = true;
     }
     ++m_j;
@@ -89,6 +257,7 @@ SortStepResult SelectionSort::step(std::vector<int>& arr) {
         result.hi1 = m_min_idx;
         result.hi2 = m_j;
         result.compared = true;
+        count_compare(m_j, m_min_idx);
         if (arr[m_j] < arr[m_min_idx]) {
             m_min_idx = m_j;
         }
@@ -107,7 +276,10 @@ SortStepResult SelectionSort::step(std::vector<int>& arr) {
     result.hi2 = m_min_idx;
     if (m_min_idx != m_i) {
         std::swap(arr[m_i], arr[m_min_idx]);
+        count_compare(m_i, m_min_idx);
+        count_swap(m_i, m_min_idx);
         result.swapped = true;
+        result.write_count = 2;
     }
 
     ++m_i;
@@ -123,6 +295,105 @@ SortStepResult SelectionSort::step(std::vector<int>& arr) {
     return result;
 }
 
+/* CYCLE SORT IMPLEMENTATION */
+const char* CycleSort::name() const {
+    return "Cycle Sort";
+}
+
+void CycleSort::reset(int size) {
+    m_size = size;
+    m_start = 0;
+    m_item = 0;
+    m_pos = 0;
+    m_i = 0;
+    m_stage = 0;
+    m_in_cycle = false;
+    m_done = (size <= 1);
+}
+
+SortStepResult CycleSort::step(std::vector<int>& arr) {
+    SortStepResult result;
+
+    if (m_done || m_size <= 1 || (int)arr.size() < m_size) {
+        result.done = true;
+        m_done = true;
+        return result;
+    }
+
+    while (true) {
+        if (m_stage == 0) { // Pick up the element that starts the next cycle
+            if (m_start >= m_size - 1) {
+                m_done = true;
+                result.done = true;
+                return result;
+            }
+
+            m_item = arr[m_start];
+            count_read(m_start);
+            m_pos = m_start;
+            m_i = m_start + 1;
+            m_in_cycle = false;
+            m_stage = 1;
+        }
+
+        if (m_stage == 1) { // Its final position is the number of smaller elements after the start
+            if (m_i < m_size) {
+                result.hi1 = m_i;
+                result.hi2 = m_pos;
+                result.compared = true;
+                count_read(m_i);
+                if (arr[m_i] < m_item) {
+                    ++m_pos;
+                }
+                ++m_i;
+                return result;
+            }
+
+            if (!m_in_cycle && m_pos == m_start) { // Already in place, nothing to write
+                ++m_start;
+                m_stage = 0;
+                continue;
+            }
+            m_stage = 2;
+        }
+
+        if (m_stage == 2) { // Equal keys go after the ones already placed
+            result.hi1 = m_pos;
+            result.compared = true;
+            count_read(m_pos);
+            if (m_item == arr[m_pos]) {
+                ++m_pos;
+            } else {
+                m_stage = 3;
+            }
+            return result;
+        }
+
+        // Drop the item into place and carry on with the element it displaced, until the cycle closes at the start
+        std::swap(m_item, arr[m_pos]);
+        count_write(m_pos);
+        result.hi1 = m_pos;
+        result.hi2 = m_pos;
+        result.swapped = true;
+        result.write_count = 1;
+        if (m_pos == m_start) {
+            ++m_start;
+            m_stage = 0;
+        } else {
+            m_pos = m_start;
+            m_i = m_start + 1;
+            m_in_cycle = true;
+            m_stage = 1;
+        }
+        return result;
+    }
+}
+
+void CycleSort::sort(std::vector<int>& arr) {
+    cycle_sort(arr.data(), (int)arr.size());
+    m_done = true;
+}
+
 /* INSERTION SORT IMPLEMENTATION */
 const char* InsertionSort::name() const {
     return "Insertion Sort";
@@ -159,9 +430,12 @@ SortStepResult InsertionSort::step(std::vector<int>& arr) {
     result.hi1 = m_j - 1;
     result.hi2 = m_j;
     result.compared = true;
+    count_compare(m_j - 1, m_j);
     if (arr[m_j - 1] > arr[m_j]) {
         std::swap(arr[m_j - 1], arr[m_j]);
+        count_swap(m_j - 1, m_j);
         result.swapped = true;
+        result.write_count = 2;
         --m_j;
 
         if (m_j == 0) {
@@ -211,9 +485,12 @@ SortStepResult CocktailSort::step(std::vector<int>& arr) {
         result.hi1 = m_j;
         result.hi2 = m_j + 1;
         result.compared = true;
+        count_compare(m_j, m_j + 1);
         if (arr[m_j] > arr[m_j + 1]) {
             std::swap(arr[m_j], arr[m_j + 1]);
+            count_swap(m_j, m_j + 1);
             result.swapped = true;
+            result.write_count = 2;
             m_swapped_in_pass = true;
         }
         ++m_j;
@@ -235,9 +512,12 @@ SortStepResult CocktailSort::step(std::vector<int>& arr) {
         result.hi1 = m_j - 1;
         result.hi2 = m_j;
         result.compared = true;
+        count_compare(m_j - 1, m_j);
         if (arr[m_j - 1] > arr[m_j]) {
             std::swap(arr[m_j - 1], arr[m_j]);
+            count_swap(m_j - 1, m_j);
             result.swapped = true;
+            result.write_count = 2;
             m_swapped_in_pass = true;
         }
         --m_j;
@@ -259,22 +539,37 @@ SortStepResult CocktailSort::step(std::vector<int>& arr) {
 }
 
 /* COMB SORT IMPLEMENTATION */
+CombSort::CombSort(GapSequence sequence) : m_gap_engine(sequence) {}
+
 const char* CombSort::name() const {
-    return "Comb Sort (1.3)";
+    char label[64];
+    if (m_gap_engine.sequence() == GapSequence::Shrink) {
+        std::snprintf(label, sizeof(label), "Comb Sort (%.3g)", m_gap_engine.shrink());
+    } else {
+        std::snprintf(label, sizeof(label), "Comb Sort (%s)", gap_sequence_name(m_gap_engine.sequence()));
+    }
+    m_name = label;
+    return m_name.c_str();
+}
+
+std::vector<AlgoParam> CombSort::params() const {
+    return {{"shrink", m_gap_engine.shrink(), 1.1, 1.6, 0.05}};
 }
 
-// Shrinks the gap by a factor of 1.3 and ensures it never goes below 1
-int CombSort::next_gap(int gap) {
-    gap = (gap * 10) / 13;
-    if (gap < 1) {
-        return 1;
+bool CombSort::set_param(const char* name, double value) {
+    if (std::strcmp(name, "shrink") != 0 || value <= 1.0) {
+        return false;
     }
-    return gap;
+
+    m_gap_engine.set_shrink(value);
+    return true;
 }
 
 void CombSort::reset(int size) {
     m_size = size;
-    m_gap = next_gap(size);
+    m_gaps = m_gap_engine.gaps(size);
+    m_gap_idx = 0;
+    m_gap = m_gaps.empty() ? 1 : m_gaps.front();
     m_i = 0;
     m_swapped_in_pass = false;
     m_done = (size <= 1);
@@ -296,7 +591,11 @@ SortStepResult CombSort::step(std::vector<int>& arr) {
             return result;
         }
 
-        m_gap = next_gap(m_gap);
+        // The last gap is always 1, repeated until a pass makes no swap
+        if (m_gap_idx + 1 < (int)m_gaps.size()) {
+            ++m_gap_idx;
+        }
+        m_gap = m_gaps[m_gap_idx];
         m_i = 0;
         m_swapped_in_pass = false;
     }
@@ -305,9 +604,12 @@ SortStepResult CombSort::step(std::vector<int>& arr) {
     result.hi1 = m_i;
     result.hi2 = m_i + m_gap;
     result.compared = true;
+    count_compare(m_i, m_i + m_gap);
     if (arr[m_i] > arr[m_i + m_gap]) {
         std::swap(arr[m_i], arr[m_i + m_gap]);
+        count_swap(m_i, m_i + m_gap);
         result.swapped = true;
+        result.write_count = 2;
         m_swapped_in_pass = true;
     }
     ++m_i;
@@ -315,46 +617,50 @@ SortStepResult CombSort::step(std::vector<int>& arr) {
     return result;
 }
 
+void CombSort::sort(std::vector<int>& arr) {
+    comb_sort(arr.data(), (int)arr.size(), m_gap_engine.gaps((int)arr.size()));
+    m_done = true;
+}
+
 /* SHELL SORT IMPLEMENTATION */
+ShellSort::ShellSort(GapSequence sequence) : m_gap_engine(sequence) {}
+
 const char* ShellSort::name() const {
-    return "Shell Sort (Ciura + 2.25)";
+    char label[64];
+    if (m_gap_engine.sequence() == GapSequence::Ciura) {
+        std::snprintf(label, sizeof(label), "Shell Sort (Ciura + %.3g)", m_gap_engine.growth());
+    } else {
+        std::snprintf(label, sizeof(label), "Shell Sort (%s)", gap_sequence_name(m_gap_engine.sequence()));
+    }
+    m_name = label;
+    return m_name.c_str();
+}
+
+std::vector<AlgoParam> ShellSort::params() const {
+    return {{"gap_growth", m_gap_engine.growth(), 1.8, 3.2, 0.1}};
+}
+
+bool ShellSort::set_param(const char* name, double value) {
+    if (std::strcmp(name, "gap_growth") != 0 || value <= 1.0) {
+        return false;
+    }
+
+    m_gap_engine.set_growth(value);
+    return true;
 }
 
 void ShellSort::reset(int size) {
     m_size = size;
-    m_gaps.clear();
+    m_gaps = m_gap_engine.gaps(size);
     m_gap_idx = 0;
     m_i = 0;
     m_j = 0;
-    m_done = (size <= 1);
+    m_done = (size <= 1 || m_gaps.empty());
 
     if (m_done) {
         return;
     }
 
-    std::vector<int> ciura = {1, 4, 10, 23, 57, 132, 301, 701};
-    int last_gap = ciura.back();
-    while (last_gap < size) {
-        int next = (last_gap * 9) / 4;
-        if (next <= last_gap) {
-            next = last_gap + 1;
-        }
-        ciura.push_back(next);
-        last_gap = next;
-    }
-
-    for (int index = (int)ciura.size() - 1; index >= 0; --index) {
-        if (ciura[index] < size) {
-            m_gaps.push_back(ciura[index]);
-        }
-    }
-
-    if (m_gaps.empty()) {
-        m_done = true;
-        return;
-    }
-
-    m_gap_idx = 0;
     m_i = m_gaps[m_gap_idx];
     m_j = m_i;
 }
@@ -389,10 +695,13 @@ SortStepResult ShellSort::step(std::vector<int>& arr) {
     result.hi1 = m_j - gap;
     result.hi2 = m_j;
     result.compared = true;
+    count_compare(m_j - gap, m_j);
 
     if (arr[m_j - gap] > arr[m_j]) {
         std::swap(arr[m_j - gap], arr[m_j]);
+        count_swap(m_j - gap, m_j);
         result.swapped = true;
+        result.write_count = 2;
         m_j -= gap;
 
         if (m_j < gap) {
@@ -412,20 +721,45 @@ SortStepResult ShellSort::step(std::vector<int>& arr) {
     return result;
 }
 
+void ShellSort::sort(std::vector<int>& arr) {
+    shell_sort(arr.data(), (int)arr.size(), m_gap_engine.gaps((int)arr.size()));
+    m_done = true;
+}
+
 /* QUICK SORT IMPLEMENTATION */
+QuickSort::QuickSort(LeafSort leaf, int leaf_threshold) {
+    set_leaf(leaf, leaf_threshold);
+}
+
 const char* QuickSort::name() const {
-    return "Quick Sort (Mid P + 3-way)";
+    return (m_leaf == LeafSort::Network) ? "Quick Sort (Mid P + 3-way, network leaf)" : "Quick Sort (Mid P + 3-way)";
+}
+
+void QuickSort::set_leaf(LeafSort leaf, int leaf_threshold) {
+    m_leaf = leaf;
+    m_leaf_threshold = clamp_leaf_threshold(leaf, leaf_threshold);
+}
+
+std::vector<AlgoParam> QuickSort::params() const {
+    return leaf_params(m_leaf, m_leaf_threshold);
+}
+
+bool QuickSort::set_param(const char* name, double value) {
+    return set_leaf_param(name, value, m_leaf, m_leaf_threshold);
 }
 
 void QuickSort::reset(int size) {
     m_size = size;
     m_stack.clear();
+    m_stack_peak = 0;
     m_has_active_partition = false;
     m_in_insertion = false;
+    m_net = nullptr;
     m_done = (size <= 1);
 
     if (!m_done) {
         m_stack.push_back({0, size - 1});
+        m_stack_peak = 1;
     }
 }
 
@@ -439,6 +773,27 @@ SortStepResult QuickSort::step(std::vector<int>& arr) {
     }
 
     while (true) {
+        if (m_in_insertion && m_net != nullptr) {
+            if (m_net_idx >= m_net_count) {
+                m_in_insertion = false;
+                m_net = nullptr;
+                continue;
+            }
+
+            const Comparator& comparator = m_net[m_net_idx++];
+            result.hi1 = m_ins_lo + comparator.lo;
+            result.hi2 = m_ins_lo + comparator.hi;
+            result.compared = true;
+            count_compare(result.hi1, result.hi2);
+            if (arr[result.hi1] > arr[result.hi2]) {
+                std::swap(arr[result.hi1], arr[result.hi2]);
+                count_swap(result.hi1, result.hi2);
+                result.swapped = true;
+                result.write_count = 2;
+            }
+            return result;
+        }
+
         if (m_in_insertion) {
             if (m_ins_i > m_ins_hi) {
                 m_in_insertion = false;
@@ -454,9 +809,12 @@ SortStepResult QuickSort::step(std::vector<int>& arr) {
             result.hi1 = m_ins_j - 1;
             result.hi2 = m_ins_j;
             result.compared = true;
+            count_compare(m_ins_j - 1, m_ins_j);
             if (arr[m_ins_j - 1] > arr[m_ins_j]) {
                 std::swap(arr[m_ins_j - 1], arr[m_ins_j]);
+                count_swap(m_ins_j - 1, m_ins_j);
                 result.swapped = true;
+                result.write_count = 2;
                 --m_ins_j;
             } else {
                 ++m_ins_i;
@@ -480,12 +838,16 @@ SortStepResult QuickSort::step(std::vector<int>& arr) {
             }
 
             const int range_size = range.hi - range.lo + 1;
-            if (range_size <= INSERTION_SORT_THRESHOLD) {
+            if (range_size <= m_leaf_threshold) {
                 m_in_insertion = true;
                 m_ins_lo = range.lo;
                 m_ins_hi = range.hi;
                 m_ins_i = m_ins_lo + 1;
                 m_ins_j = m_ins_i;
+                if (m_leaf == LeafSort::Network) {
+                    m_net = small_network_comparators(range_size, m_net_count);
+                    m_net_idx = 0;
+                }
                 continue;
             }
 
@@ -494,6 +856,7 @@ SortStepResult QuickSort::step(std::vector<int>& arr) {
 
             const int mid = m_lo + ((m_hi - m_lo) / 2);
             m_pivot = arr[mid];
+            count_read(mid);
             m_lt = m_lo;
             m_i = m_lo;
             m_gt = m_hi;
@@ -505,18 +868,25 @@ SortStepResult QuickSort::step(std::vector<int>& arr) {
             result.hi1 = m_i;
             result.hi2 = m_gt;
             result.compared = true;
+            count_read(m_i);
 
             if (arr[m_i] < m_pivot) {
                 if (m_lt != m_i) {
                     std::swap(arr[m_lt], arr[m_i]);
+                    count_read(m_lt);
+                    count_swap(m_lt, m_i);
                     result.swapped = true;
+                    result.write_count = 2;
                 }
                 ++m_lt;
                 ++m_i;
             } else if (arr[m_i] > m_pivot) {
                 if (m_i != m_gt) {
                     std::swap(arr[m_i], arr[m_gt]);
+                    count_read(m_gt);
+                    count_swap(m_i, m_gt);
                     result.swapped = true;
+                    result.write_count = 2;
                 }
                 --m_gt;
             } else {
@@ -550,12 +920,26 @@ SortStepResult QuickSort::step(std::vector<int>& arr) {
                     m_stack.push_back({right_lo, right_hi});
                 }
             }
+            m_stack_peak = std::max(m_stack_peak, m_stack.size());
         }
 
         m_has_active_partition = false;
     }
 }
 
+const char* QuickSort::phase() const {
+    return m_in_insertion ? "leaf sort" : "partition";
+}
+
+void QuickSort::sort(std::vector<int>& arr) {
+    m_stack_peak = quick_sort_3way(arr.data(), (int)arr.size(), m_leaf, m_leaf_threshold);
+    m_done = true;
+}
+
+size_t QuickSort::aux_memory_bytes() const {
+    return m_stack_peak * sizeof(Range);
+}
+
 /* HEAP SORT IMPLEMENTATION */
 const char* HeapSort::name() const {
     return "Heap Sort";
@@ -611,7 +995,10 @@ SortStepResult HeapSort::step(std::vector<int>& arr) {
             result.hi2 = m_extract_end;
             if (m_extract_end != 0) {
                 std::swap(arr[0], arr[m_extract_end]);
+                count_compare(0, m_extract_end);
+                count_swap(0, m_extract_end);
                 result.swapped = true;
+                result.write_count = 2;
             }
 
             if (m_extract_end - 1 > 0) {
@@ -660,6 +1047,7 @@ SortStepResult HeapSort::step(std::vector<int>& arr) {
             result.hi1 = m_sift_left;
             result.hi2 = m_sift_right;
             result.compared = true;
+            count_compare(m_sift_left, m_sift_right);
             if (arr[m_sift_left] < arr[m_sift_right]) {
                 m_sift_child = m_sift_right;
             }
@@ -670,9 +1058,12 @@ SortStepResult HeapSort::step(std::vector<int>& arr) {
         result.hi1 = m_sift_root;
         result.hi2 = m_sift_child;
         result.compared = true;
+        count_compare(m_sift_root, m_sift_child);
         if (arr[m_sift_root] < arr[m_sift_child]) {
             std::swap(arr[m_sift_root], arr[m_sift_child]);
+            count_swap(m_sift_root, m_sift_child);
             result.swapped = true;
+            result.write_count = 2;
             m_sift_root = m_sift_child;
             m_sift_stage = 0;
         } else {
@@ -691,37 +1082,54 @@ SortStepResult HeapSort::step(std::vector<int>& arr) {
     }
 }
 
-/* MERGE SORT IMPLEMENTATION */
-const char* MergeSort::name() const {
-    return "Merge Sort";
+const char* HeapSort::phase() const {
+    return m_building_heap ? "build heap" : "extract";
 }
 
-void MergeSort::reset(int size) {
-    m_size = size;
-    m_buffer.assign(size, 0);
+void HeapSort::sort(std::vector<int>& arr) {
+    heap_sort(arr.data(), (int)arr.size(), 2, false, false);
+    m_done = true;
+}
 
-    m_width = std::max(1, INSERTION_SORT_THRESHOLD);
-    m_left = 0;
+/* D-ARY HEAP SORT IMPLEMENTATION */
+DaryHeapSort::DaryHeapSort(int arity, bool bottom_up) : m_bottom_up(bottom_up) {
+    m_arity = (arity >= 8) ? 8 : ((arity >= 4) ? 4 : 2);
 
-    m_in_pre_insertion = (m_width > 1 && size > 1);
-    m_run_lo = 0;
-    m_run_hi = std::min(m_width - 1, size - 1);
-    m_ins_i = m_run_lo + 1;
-    m_ins_j = m_ins_i;
+    char label[64];
+    std::snprintf(label, sizeof(label), "Heap Sort (%d-ary%s)", m_arity, m_bottom_up ? ", bottom-up" : "");
+    m_name = label;
+}
 
-    m_merge_active = false;
-    m_copying_back = false;
-    m_mid = 0;
-    m_right = 0;
-    m_i = 0;
-    m_j = 0;
-    m_k = 0;
-    m_copy_idx = 0;
+const char* DaryHeapSort::name() const {
+    return m_name.c_str();
+}
 
+void DaryHeapSort::reset(int size) {
+    m_size = size;
+    m_building_heap = true;
+    m_build_index = (size - 2) / m_arity;
+    m_extract_end = size - 1;
+    m_sift_active = false;
+    m_sift_stage = 0;
     m_done = (size <= 1);
 }
 
-SortStepResult MergeSort::step(std::vector<int>& arr) {
+// Moves on to the next sift, returns true once the array is sorted
+bool DaryHeapSort::finish_sift() {
+    m_sift_active = false;
+    if (m_building_heap) {
+        --m_build_index;
+        return false;
+    }
+
+    --m_extract_end;
+    if (m_extract_end <= 0) {
+        m_done = true;
+    }
+    return m_done;
+}
+
+SortStepResult DaryHeapSort::step(std::vector<int>& arr) {
     SortStepResult result;
 
     if (m_done || m_size <= 1 || (int)arr.size() < m_size) {
@@ -731,60 +1139,336 @@ SortStepResult MergeSort::step(std::vector<int>& arr) {
     }
 
     while (true) {
-        if (m_in_pre_insertion) {
-            if (m_run_lo >= m_size) {
-                m_in_pre_insertion = false;
-                continue;
-            }
-
-            if (m_ins_i > m_run_hi) {
-                m_run_lo = m_run_hi + 1;
-                if (m_run_lo >= m_size) {
-                    m_in_pre_insertion = false;
+        if (!m_sift_active) {
+            if (m_building_heap) {
+                if (m_build_index < 0) {
+                    m_building_heap = false;
+                    m_extract_end = m_size - 1;
                     continue;
                 }
 
-                m_run_hi = std::min(m_run_lo + m_width - 1, m_size - 1);
-                m_ins_i = m_run_lo + 1;
-                m_ins_j = m_ins_i;
-                continue;
-            }
-
-            if (m_ins_j <= m_run_lo) {
-                ++m_ins_i;
-                m_ins_j = m_ins_i;
-                continue;
-            }
+                m_sift_root = m_build_index;
+                m_sift_end = m_size - 1;
+            } else {
+                if (m_extract_end <= 0) {
+                    m_done = true;
+                    result.done = true;
+                    return result;
+                }
 
-            result.hi1 = m_ins_j - 1;
-            result.hi2 = m_ins_j;
-            result.compared = true;
-            if (arr[m_ins_j - 1] > arr[m_ins_j]) {
-                std::swap(arr[m_ins_j - 1], arr[m_ins_j]);
+                std::swap(arr[0], arr[m_extract_end]);
+                count_compare(0, m_extract_end);
+                count_swap(0, m_extract_end);
+                result.hi1 = 0;
+                result.hi2 = m_extract_end;
                 result.swapped = true;
-                --m_ins_j;
-            } else {
-                ++m_ins_i;
-                m_ins_j = m_ins_i;
+                result.write_count = 2;
+                m_sift_root = 0;
+                m_sift_end = m_extract_end - 1;
             }
-            return result;
-        }
 
-        if (!m_merge_active) {
-            if (m_width >= m_size) {
-                m_done = true;
-                result.done = true;
+            m_hole = m_sift_root;
+            m_sift_stage = 0;
+            m_sift_active = true;
+            if (result.swapped) {
                 return result;
             }
+            continue;
+        }
 
-            if (m_left >= m_size - m_width) {
-                m_width *= 2;
-                m_left = 0;
+        if (m_sift_stage == 0) {
+            const int first = (m_arity * m_hole) + 1;
+            if (first > m_sift_end) {
+                if (m_bottom_up) {
+                    m_sift_stage = 3;
+                } else if (finish_sift()) {
+                    result.done = true;
+                    return result;
+                }
                 continue;
             }
 
-            m_mid = m_left + m_width - 1;
-            m_right = std::min(m_left + (2 * m_width) - 1, m_size - 1);
+            m_last_child = std::min(first + m_arity - 1, m_sift_end);
+            m_best = first;
+            m_child = first + 1;
+            m_sift_stage = 1;
+        }
+
+        if (m_sift_stage == 1) {
+            if (m_child <= m_last_child) {
+                result.hi1 = m_best;
+                result.hi2 = m_child;
+                result.compared = true;
+                count_compare(m_best, m_child);
+                if (arr[m_best] < arr[m_child]) {
+                    m_best = m_child;
+                }
+                ++m_child;
+                return result;
+            }
+
+            // Bottom-up walks down to a leaf without looking at the value
+            if (m_bottom_up) {
+                std::swap(arr[m_hole], arr[m_best]);
+                count_read(m_hole);
+                count_swap(m_hole, m_best);
+                result.hi1 = m_hole;
+                result.hi2 = m_best;
+                result.swapped = true;
+                result.write_count = 2;
+                m_hole = m_best;
+                m_sift_stage = 0;
+                return result;
+            }
+            m_sift_stage = 2;
+        }
+
+        if (m_sift_stage == 2) {
+            result.hi1 = m_hole;
+            result.hi2 = m_best;
+            result.compared = true;
+            count_compare(m_hole, m_best);
+            if (arr[m_hole] < arr[m_best]) {
+                std::swap(arr[m_hole], arr[m_best]);
+                count_swap(m_hole, m_best);
+                result.swapped = true;
+                result.write_count = 2;
+                m_hole = m_best;
+                m_sift_stage = 0;
+            } else {
+                result.done = finish_sift();
+            }
+            return result;
+        }
+
+        // Climb back while the parent is smaller than the sifted value
+        if (m_hole <= m_sift_root) {
+            if (finish_sift()) {
+                result.done = true;
+                return result;
+            }
+            continue;
+        }
+
+        const int parent = (m_hole - 1) / m_arity;
+        result.hi1 = parent;
+        result.hi2 = m_hole;
+        result.compared = true;
+        count_compare(parent, m_hole);
+        if (arr[parent] < arr[m_hole]) {
+            std::swap(arr[parent], arr[m_hole]);
+            count_swap(parent, m_hole);
+            result.swapped = true;
+            result.write_count = 2;
+            m_hole = parent;
+        } else {
+            result.done = finish_sift();
+        }
+        return result;
+    }
+}
+
+const char* DaryHeapSort::phase() const {
+    return m_building_heap ? "build heap" : "extract";
+}
+
+void DaryHeapSort::sort(std::vector<int>& arr) {
+    heap_sort(arr.data(), (int)arr.size(), m_arity, m_bottom_up, true);
+    m_done = true;
+}
+
+/* MERGE SORT IMPLEMENTATION */
+MergeSort::MergeSort(LeafSort leaf, int leaf_threshold, bool ping_pong) : m_ping_pong(ping_pong) {
+    set_leaf(leaf, leaf_threshold);
+}
+
+const char* MergeSort::name() const {
+    if (m_ping_pong) {
+        return (m_leaf == LeafSort::Network) ? "Merge Sort (ping-pong, network leaf, unstable)" : "Merge Sort (ping-pong)";
+    }
+    // Network leaves exchange equal keys across the run, only the merges keep their order
+    return (m_leaf == LeafSort::Network) ? "Merge Sort (network leaf, unstable)" : "Merge Sort";
+}
+
+void MergeSort::set_leaf(LeafSort leaf, int leaf_threshold) {
+    m_leaf = leaf;
+    m_leaf_threshold = clamp_leaf_threshold(leaf, leaf_threshold);
+}
+
+std::vector<AlgoParam> MergeSort::params() const {
+    return leaf_params(m_leaf, m_leaf_threshold);
+}
+
+bool MergeSort::set_param(const char* name, double value) {
+    return set_leaf_param(name, value, m_leaf, m_leaf_threshold);
+}
+
+void MergeSort::start_run() {
+    m_run_hi = std::min(m_run_lo + m_width - 1, m_size - 1);
+    m_ins_i = m_run_lo + 1;
+    m_ins_j = m_ins_i;
+    m_net = nullptr;
+    if (m_leaf == LeafSort::Network) {
+        m_net = small_network_comparators(m_run_hi - m_run_lo + 1, m_net_count);
+        m_net_idx = 0;
+    }
+}
+
+void MergeSort::reset(int size) {
+    m_size = size;
+    m_buffer.assign(size, 0);
+
+    m_width = m_leaf_threshold;
+    m_left = 0;
+
+    m_in_pre_insertion = (m_width > 1 && size > 1);
+    m_run_lo = 0;
+    start_run();
+
+    m_merge_active = false;
+    m_copying_back = false;
+    m_mid = 0;
+    m_right = 0;
+    m_i = 0;
+    m_j = 0;
+    m_k = 0;
+    m_copy_idx = 0;
+    m_in_buffer = false;
+    m_final_copy = false;
+
+    m_done = (size <= 1);
+}
+
+void MergeSort::count_source_read(int i) const {
+    if (m_in_buffer) {
+        count_buffer_read(i);
+    } else {
+        count_read(i);
+    }
+}
+
+void MergeSort::count_dest_write(int i) const {
+    if (m_in_buffer) {
+        count_write(i);
+    } else {
+        count_buffer_write(i);
+    }
+}
+
+SortStepResult MergeSort::step(std::vector<int>& arr) {
+    SortStepResult result;
+
+    if (m_done || m_size <= 1 || (int)arr.size() < m_size) {
+        result.done = true;
+        m_done = true;
+        return result;
+    }
+
+    while (true) {
+        if (m_in_pre_insertion) {
+            if (m_run_lo >= m_size) {
+                m_in_pre_insertion = false;
+                continue;
+            }
+
+            const bool run_done = (m_net != nullptr) ? (m_net_idx >= m_net_count) : (m_ins_i > m_run_hi);
+            if (run_done) {
+                m_run_lo = m_run_hi + 1;
+                if (m_run_lo >= m_size) {
+                    m_in_pre_insertion = false;
+                    continue;
+                }
+
+                start_run();
+                continue;
+            }
+
+            if (m_net != nullptr) {
+                const Comparator& comparator = m_net[m_net_idx++];
+                result.hi1 = m_run_lo + comparator.lo;
+                result.hi2 = m_run_lo + comparator.hi;
+                result.compared = true;
+                count_compare(result.hi1, result.hi2);
+                if (arr[result.hi1] > arr[result.hi2]) {
+                    std::swap(arr[result.hi1], arr[result.hi2]);
+                    count_swap(result.hi1, result.hi2);
+                    result.swapped = true;
+                    result.write_count = 2;
+                }
+                return result;
+            }
+
+            if (m_ins_j <= m_run_lo) {
+                ++m_ins_i;
+                m_ins_j = m_ins_i;
+                continue;
+            }
+
+            result.hi1 = m_ins_j - 1;
+            result.hi2 = m_ins_j;
+            result.compared = true;
+            count_compare(m_ins_j - 1, m_ins_j);
+            if (arr[m_ins_j - 1] > arr[m_ins_j]) {
+                std::swap(arr[m_ins_j - 1], arr[m_ins_j]);
+                count_swap(m_ins_j - 1, m_ins_j);
+                result.swapped = true;
+                result.write_count = 2;
+                --m_ins_j;
+            } else {
+                ++m_ins_i;
+                m_ins_j = m_ins_i;
+            }
+            return result;
+        }
+
+        if (m_final_copy) {
+            arr[m_copy_idx] = m_buffer[m_copy_idx];
+            count_buffer_read(m_copy_idx);
+            count_write(m_copy_idx);
+            result.hi1 = m_copy_idx;
+            result.hi2 = m_copy_idx;
+            result.swapped = true;
+            ++result.write_count;
+            ++m_copy_idx;
+
+            if (m_copy_idx >= m_size) {
+                m_done = true;
+                result.done = true;
+            }
+            return result;
+        }
+
+        if (!m_merge_active) {
+            if (m_width >= m_size) {
+                // After an odd number of ping-pong passes the sorted keys are in the buffer, copied back once
+                if (m_in_buffer) {
+                    m_in_buffer = false;
+                    m_final_copy = true;
+                    m_copy_idx = 0;
+                    continue;
+                }
+                m_done = true;
+                result.done = true;
+                return result;
+            }
+
+            if (m_ping_pong && m_left >= m_size) {
+                // The pass wrote every run to the other side, which the next pass reads
+                m_in_buffer = !m_in_buffer;
+                m_width *= 2;
+                m_left = 0;
+                continue;
+            }
+
+            if (!m_ping_pong && m_left >= m_size - m_width) {
+                m_width *= 2;
+                m_left = 0;
+                continue;
+            }
+
+            // A lone tail run merges with an empty right half, which carries it over to the buffer
+            m_mid = std::min(m_left + m_width - 1, m_size - 1);
+            m_right = std::min(m_left + (2 * m_width) - 1, m_size - 1);
             m_i = m_left;
             m_j = m_mid + 1;
             m_k = m_left;
@@ -795,41 +1479,62 @@ SortStepResult MergeSort::step(std::vector<int>& arr) {
         }
 
         if (!m_copying_back) {
+            // Only ping-pong passes alternate, the copy-back merges always go from the array to the buffer
+            const std::vector<int>& src = m_in_buffer ? m_buffer : arr;
+            std::vector<int>& dst = m_in_buffer ? arr : m_buffer;
             if (m_i <= m_mid && m_j <= m_right) {
                 result.hi1 = m_i;
                 result.hi2 = m_j;
                 result.compared = true;
-                if (arr[m_i] <= arr[m_j]) {
-                    m_buffer[m_k] = arr[m_i];
+                count_source_read(m_i);
+                count_source_read(m_j);
+                count_dest_write(m_k);
+                if (src[m_i] <= src[m_j]) {
+                    dst[m_k] = src[m_i];
                     ++m_i;
                 } else {
-                    m_buffer[m_k] = arr[m_j];
+                    dst[m_k] = src[m_j];
                     ++m_j;
                 }
                 ++m_k;
+                ++result.write_count;
                 return result;
             }
 
+            result.write_count += (m_mid - m_i + 1) + (m_right - m_j + 1);
             while (m_i <= m_mid) {
-                m_buffer[m_k] = arr[m_i];
+                dst[m_k] = src[m_i];
+                count_source_read(m_i);
+                count_dest_write(m_k);
                 ++m_i;
                 ++m_k;
             }
             while (m_j <= m_right) {
-                m_buffer[m_k] = arr[m_j];
+                dst[m_k] = src[m_j];
+                count_source_read(m_j);
+                count_dest_write(m_k);
                 ++m_j;
                 ++m_k;
             }
 
+            if (m_ping_pong) {
+                m_merge_active = false;
+                m_left += 2 * m_width;
+                continue;
+            }
+
             m_copying_back = true;
             continue;
         }
 
         if (m_copy_idx <= m_right) {
             arr[m_copy_idx] = m_buffer[m_copy_idx];
+            count_buffer_read(m_copy_idx);
+            count_write(m_copy_idx);
             result.hi1 = m_copy_idx;
             result.hi2 = m_copy_idx;
             result.swapped = true;
+            ++result.write_count;
             ++m_copy_idx;
 
             if (m_copy_idx > m_right) {
@@ -845,3 +1550,2232 @@ SortStepResult MergeSort::step(std::vector<int>& arr) {
     }
 }
 
+const char* MergeSort::phase() const {
+    if (m_in_pre_insertion) {
+        return "pre-insertion";
+    }
+    return (m_copying_back || m_final_copy) ? "copy back" : "merge";
+}
+
+void MergeSort::sort(std::vector<int>& arr) {
+    m_buffer.resize(arr.size());
+    if (m_ping_pong) {
+        merge_sort_ping_pong(arr.data(), m_buffer.data(), (int)arr.size(), m_leaf, m_leaf_threshold);
+    } else {
+        merge_sort_bottom_up(arr.data(), m_buffer.data(), (int)arr.size(), m_leaf, m_leaf_threshold);
+    }
+    m_done = true;
+}
+
+size_t MergeSort::aux_memory_bytes() const {
+    return m_buffer.size() * sizeof(int);
+}
+
+/* IN-PLACE MERGE SORT IMPLEMENTATION */
+const char* InPlaceMergeSort::name() const {
+    return "In-Place Merge Sort (SymMerge)";
+}
+
+void InPlaceMergeSort::reset(int size) {
+    m_size = size;
+    m_width = DEFAULT_LEAF_THRESHOLD;
+    m_left = 0;
+
+    m_in_insertion = (m_width > 1 && size > 1);
+    m_run_lo = 0;
+    m_run_hi = std::min(m_width - 1, size - 1);
+    m_ins_i = m_run_lo + 1;
+    m_ins_j = m_ins_i;
+
+    m_stack.clear();
+    m_stack_peak = 0;
+    m_stage = 0;
+    m_done = (size <= 1);
+}
+
+void InPlaceMergeSort::push_merge(int lo, int mid, int hi) {
+    m_stack.push_back({lo, mid, hi});
+    m_stack_peak = std::max(m_stack_peak, m_stack.size());
+}
+
+// Sets up the binary search for the split point of arr[lo, mid) and arr[mid, hi) around their combined middle
+void InPlaceMergeSort::begin_merge(const MergeFrame& frame) {
+    m_frame = frame;
+    m_half = frame.lo + ((frame.hi - frame.lo) / 2);
+    m_search_n = m_half + frame.mid;
+    m_search_lo = (frame.mid > m_half) ? (m_search_n - frame.hi) : frame.lo;
+    m_search_hi = (frame.mid > m_half) ? m_half : frame.mid;
+    m_stage = 1;
+}
+
+// Both sides of the rotated blocks are merged independently
+void InPlaceMergeSort::end_merge() {
+    const int start = m_search_lo;
+    if (m_frame.lo < start && start < m_half) {
+        push_merge(m_frame.lo, start, m_half);
+    }
+    if (m_half < m_end && m_end < m_frame.hi) {
+        push_merge(m_half, m_end, m_frame.hi);
+    }
+    m_stage = 0;
+}
+
+SortStepResult InPlaceMergeSort::step(std::vector<int>& arr) {
+    SortStepResult result;
+
+    if (m_done || m_size <= 1 || (int)arr.size() < m_size) {
+        result.done = true;
+        m_done = true;
+        return result;
+    }
+
+    while (true) {
+        if (m_in_insertion) {
+            if (m_ins_i > m_run_hi) {
+                m_run_lo = m_run_hi + 1;
+                if (m_run_lo >= m_size) {
+                    m_in_insertion = false;
+                    continue;
+                }
+
+                m_run_hi = std::min(m_run_lo + m_width - 1, m_size - 1);
+                m_ins_i = m_run_lo + 1;
+                m_ins_j = m_ins_i;
+                continue;
+            }
+
+            if (m_ins_j <= m_run_lo) {
+                ++m_ins_i;
+                m_ins_j = m_ins_i;
+                continue;
+            }
+
+            result.hi1 = m_ins_j - 1;
+            result.hi2 = m_ins_j;
+            result.compared = true;
+            count_compare(m_ins_j - 1, m_ins_j);
+            if (arr[m_ins_j - 1] > arr[m_ins_j]) {
+                std::swap(arr[m_ins_j - 1], arr[m_ins_j]);
+                count_swap(m_ins_j - 1, m_ins_j);
+                result.swapped = true;
+                result.write_count = 2;
+                --m_ins_j;
+            } else {
+                ++m_ins_i;
+                m_ins_j = m_ins_i;
+            }
+            return result;
+        }
+
+        if (m_stage == 1) {
+            if (m_search_lo < m_search_hi) {
+                const int c = m_search_lo + ((m_search_hi - m_search_lo) / 2);
+                const int p = m_search_n - 1 - c;
+                result.hi1 = c;
+                result.hi2 = p;
+                result.compared = true;
+                count_compare(p, c);
+                if (!(arr[p] < arr[c])) {
+                    m_search_lo = c + 1;
+                } else {
+                    m_search_hi = c;
+                }
+                return result;
+            }
+
+            // Rotating arr[start, end) left by mid - start swaps the blocks that are on the wrong sides
+            m_end = m_search_n - m_search_lo;
+            if (m_search_lo < m_frame.mid && m_frame.mid < m_end) {
+                m_stage = 2;
+                m_rev_stage = 0;
+                m_rev_lo = m_search_lo;
+                m_rev_hi = m_frame.mid - 1;
+            } else {
+                end_merge();
+            }
+            continue;
+        }
+
+        if (m_stage == 2) {
+            if (m_rev_lo < m_rev_hi) {
+                std::swap(arr[m_rev_lo], arr[m_rev_hi]);
+                count_compare(m_rev_lo, m_rev_hi);
+                count_swap(m_rev_lo, m_rev_hi);
+                result.hi1 = m_rev_lo;
+                result.hi2 = m_rev_hi;
+                result.swapped = true;
+                result.write_count = 2;
+                ++m_rev_lo;
+                --m_rev_hi;
+                return result;
+            }
+
+            // Three reversals: the left block, the right block, then both
+            ++m_rev_stage;
+            if (m_rev_stage == 1) {
+                m_rev_lo = m_frame.mid;
+                m_rev_hi = m_end - 1;
+            } else if (m_rev_stage == 2) {
+                m_rev_lo = m_search_lo;
+                m_rev_hi = m_end - 1;
+            } else {
+                end_merge();
+            }
+            continue;
+        }
+
+        if (!m_stack.empty()) {
+            const MergeFrame frame = m_stack.back();
+            m_stack.pop_back();
+            begin_merge(frame);
+            continue;
+        }
+
+        // Next pair of the bottom-up pass
+        if (m_width >= m_size) {
+            m_done = true;
+            result.done = true;
+            return result;
+        }
+
+        if (m_left >= m_size - m_width) {
+            m_width *= 2;
+            m_left = 0;
+            continue;
+        }
+
+        push_merge(m_left, m_left + m_width, std::min(m_left + (2 * m_width), m_size));
+        m_left += 2 * m_width;
+    }
+}
+
+const char* InPlaceMergeSort::phase() const {
+    if (m_in_insertion) {
+        return "pre-insertion";
+    }
+    return (m_stage == 2) ? "rotate" : "split search";
+}
+
+void InPlaceMergeSort::sort(std::vector<int>& arr) {
+    m_stack_peak = merge_sort_in_place(arr.data(), (int)arr.size(), DEFAULT_LEAF_THRESHOLD);
+    m_done = true;
+}
+
+size_t InPlaceMergeSort::aux_memory_bytes() const {
+    return m_stack_peak * sizeof(MergeFrame);
+}
+
+/* BLOCK MERGE SORT IMPLEMENTATION */
+const char* BlockMergeSort::name() const {
+    return "Block Merge Sort (internal buffer)";
+}
+
+void BlockMergeSort::reset(int size) {
+    m_size = size;
+    m_stage = 0;
+    m_block = block_merge_block_size(size);
+    m_wanted = block_merge_keys_wanted(size);
+    m_run = 0;
+    m_depth = 0;
+    m_done = (size <= 1);
+    if (m_done) {
+        return;
+    }
+
+    // Short arrays are only insertion sorted, like the native kernel does
+    if (size < BLOCK_MERGE_MIN_SIZE) {
+        call_insertion(0, size);
+        m_stage = 3;
+    } else {
+        call_find_keys(size, m_wanted);
+    }
+}
+
+void BlockMergeSort::call(Routine routine) {
+    m_calls[m_depth++] = routine;
+}
+
+void BlockMergeSort::call_swap_n(int a, int b, int count) {
+    m_swap_n = {a, b, count, 0};
+    call(Routine::SwapN);
+}
+
+void BlockMergeSort::call_rotate(int lo, int left, int right) {
+    m_rotate = {lo, left, right};
+    call(Routine::Rotate);
+}
+
+void BlockMergeSort::call_search(int lo, int size, int key, bool right) {
+    m_search = {lo, 0, size, key, right};
+    call(Routine::Search);
+}
+
+void BlockMergeSort::call_insertion(int lo, int size) {
+    m_insertion = {lo, lo + size, lo + 1, lo + 1};
+    call(Routine::Insertion);
+}
+
+void BlockMergeSort::call_merge_left(int lo, int left, int right, int offset) {
+    m_merge = {lo + offset, lo, lo + left, lo + left, lo + left + right, 0};
+    call(Routine::MergeLeft);
+}
+
+// The right merge walks down: i and j are the last unmerged elements of the runs, left_end the right run's start
+void BlockMergeSort::call_merge_right(int lo, int left, int right, int buffer) {
+    m_merge = {lo + left + right + buffer - 1, lo + left - 1, lo + left, lo + left + right - 1, lo, 0};
+    call(Routine::MergeRight);
+}
+
+// Merges the pending fragment of m_buffers at lo with the block after it
+void BlockMergeSort::call_smart(int lo, int block_size) {
+    m_smart.out = lo - block_size;
+    m_smart.a = lo;
+    m_smart.a_end = lo + m_buffers.rest;
+    m_smart.b = m_smart.a_end;
+    m_smart.b_end = m_smart.b + block_size;
+    m_smart.left_fragment = (m_buffers.origin == 0);
+    m_smart.stage = 0;
+    call(Routine::Smart);
+}
+
+void BlockMergeSort::call_buffers_left(int mid_key, int lo, int blocks, int block_size, int trailing, int last) {
+    m_buffers = BuffersState();
+    m_buffers.mid_key = mid_key;
+    m_buffers.lo = lo;
+    m_buffers.blocks = blocks;
+    m_buffers.block_size = block_size;
+    m_buffers.trailing = trailing;
+    m_buffers.last = last;
+    call(Routine::BuffersLeft);
+}
+
+void BlockMergeSort::call_combine(int lo, int size, int run, int block_size) {
+    m_combine = CombineState();
+    m_combine.lo = lo;
+    m_combine.size = size;
+    m_combine.run = run;
+    m_combine.block_size = block_size;
+    m_combine.pairs = size / (2 * run);
+    m_combine.leftover = size % (2 * run);
+    if (m_combine.leftover <= run) {
+        m_combine.size -= m_combine.leftover;
+        m_combine.leftover = 0;
+    }
+    call(Routine::Combine);
+}
+
+void BlockMergeSort::call_build(int lo, int size, int buffer) {
+    m_build = BuildState();
+    m_build.lo = lo;
+    m_build.size = size;
+    m_build.buffer = buffer;
+    m_build.m = 1;
+    call(Routine::Build);
+}
+
+void BlockMergeSort::call_find_keys(int size, int wanted) {
+    m_find_keys = FindKeysState();
+    m_find_keys.size = size;
+    m_find_keys.wanted = wanted;
+    m_find_keys.found = 1;
+    m_find_keys.i = 1;
+    call(Routine::FindKeys);
+}
+
+void BlockMergeSort::call_without_buffer(int lo, int left, int right) {
+    m_without_buffer = {lo, left, right, 0};
+    call(Routine::WithoutBuffer);
+}
+
+void BlockMergeSort::compare_step(int i, int j, SortStepResult& result) const {
+    result.hi1 = i;
+    result.hi2 = j;
+    result.compared = true;
+    ++result.compare_count;
+    count_compare(i, j);
+}
+
+void BlockMergeSort::swap_step(std::vector<int>& arr, int i, int j, SortStepResult& result) const {
+    std::swap(arr[i], arr[j]);
+    count_compare(i, j);
+    count_swap(i, j);
+    result.hi1 = i;
+    result.hi2 = j;
+    result.swapped = true;
+    ++result.swap_count;
+    result.write_count += 2;
+}
+
+bool BlockMergeSort::step_swap_n(std::vector<int>& arr, SortStepResult& result) {
+    SwapNState& s = m_swap_n;
+    if (s.i >= s.count) {
+        --m_depth;
+        return false;
+    }
+    swap_step(arr, s.a + s.i, s.b + s.i, result);
+    ++s.i;
+    return true;
+}
+
+// The block swap for the next part is set up right away, the rotation resumes after it
+bool BlockMergeSort::step_rotate() {
+    RotateState& s = m_rotate;
+    if (s.left <= 0 || s.right <= 0) {
+        --m_depth;
+        return false;
+    }
+    if (s.left <= s.right) {
+        call_swap_n(s.lo, s.lo + s.left, s.left);
+        s.lo += s.left;
+        s.right -= s.left;
+    } else {
+        call_swap_n(s.lo + (s.left - s.right), s.lo + s.left, s.right);
+        s.left -= s.right;
+    }
+    return false;
+}
+
+bool BlockMergeSort::step_search(const std::vector<int>& arr, SortStepResult& result) {
+    SearchState& s = m_search;
+    if (s.low >= s.high) {
+        m_search_result = s.low;
+        --m_depth;
+        return false;
+    }
+    const int mid = s.low + ((s.high - s.low) / 2);
+    compare_step(s.lo + mid, s.key, result);
+    const bool go_right = s.right ? !(arr[s.key] < arr[s.lo + mid]) : (arr[s.lo + mid] < arr[s.key]);
+    if (go_right) {
+        s.low = mid + 1;
+    } else {
+        s.high = mid;
+    }
+    return true;
+}
+
+bool BlockMergeSort::step_insertion(std::vector<int>& arr, SortStepResult& result) {
+    InsertionState& s = m_insertion;
+    if (s.i >= s.end) {
+        --m_depth;
+        return false;
+    }
+    if (s.j <= s.lo) {
+        ++s.i;
+        s.j = s.i;
+        return false;
+    }
+    compare_step(s.j - 1, s.j, result);
+    if (arr[s.j] < arr[s.j - 1]) {
+        swap_step(arr, s.j - 1, s.j, result);
+        --s.j;
+    } else {
+        ++s.i;
+        s.j = s.i;
+    }
+    return true;
+}
+
+// Merges through the buffer at out, the unmerged rest of the left run is moved down to the output at the end
+bool BlockMergeSort::step_merge_left(std::vector<int>& arr, SortStepResult& result) {
+    MergeState& s = m_merge;
+    if (s.j < s.end) {
+        bool take_right = (s.i == s.left_end);
+        if (!take_right) {
+            compare_step(s.i, s.j, result);
+            take_right = arr[s.j] < arr[s.i];
+        }
+        swap_step(arr, s.out++, take_right ? s.j++ : s.i++, result);
+        return true;
+    }
+    --m_depth;
+    if (s.out != s.i) {
+        call_swap_n(s.out, s.i, s.left_end - s.i);
+    }
+    return false;
+}
+
+bool BlockMergeSort::step_merge_right(std::vector<int>& arr, SortStepResult& result) {
+    MergeState& s = m_merge;
+    if (s.stage == 0) {
+        if (s.i >= s.end) {
+            bool take_left = (s.j < s.left_end);
+            if (!take_left) {
+                compare_step(s.i, s.j, result);
+                take_left = arr[s.j] < arr[s.i];
+            }
+            swap_step(arr, s.out--, take_left ? s.i-- : s.j--, result);
+            return true;
+        }
+        if (s.j == s.out) {
+            --m_depth;
+            return false;
+        }
+        s.stage = 1;
+    }
+    if (s.j >= s.left_end) {
+        swap_step(arr, s.out--, s.j--, result);
+        return true;
+    }
+    --m_depth;
+    return false;
+}
+
+bool BlockMergeSort::step_smart(std::vector<int>& arr, SortStepResult& result) {
+    SmartState& s = m_smart;
+    if (s.stage == 0) {
+        if (s.a < s.a_end && s.b < s.b_end) {
+            compare_step(s.a, s.b, result);
+            const bool take_fragment = s.left_fragment ? !(arr[s.b] < arr[s.a]) : (arr[s.a] < arr[s.b]);
+            swap_step(arr, s.out++, take_fragment ? s.a++ : s.b++, result);
+            return true;
+        }
+        if (s.a < s.a_end) {
+            m_buffers.rest = s.a_end - s.a;
+            s.stage = 1;
+        } else {
+            m_buffers.rest = s.b_end - s.b;
+            m_buffers.origin = 1 - m_buffers.origin;
+            --m_depth;
+            return false;
+        }
+    }
+    if (s.a < s.a_end) {
+        swap_step(arr, --s.a_end, --s.b_end, result);
+        return true;
+    }
+    --m_depth;
+    return false;
+}
+
+bool BlockMergeSort::step_buffers_left(const std::vector<int>& arr, SortStepResult& result) {
+    BuffersState& s = m_buffers;
+    switch (s.pc) {
+    case 0: // First block
+        if (s.blocks == 0) {
+            --m_depth;
+            call_merge_left(s.lo, s.trailing * s.block_size, s.last, -s.block_size);
+            return false;
+        }
+        compare_step(0, s.mid_key, result);
+        s.origin = (arr[0] < arr[s.mid_key]) ? 0 : 1;
+        s.rest = s.block_size;
+        s.pos = s.block_size;
+        s.b = 1;
+        s.pc = 1;
+        return true;
+    case 1: { // Every next block either finalizes the fragment (same run) or is merged with it
+        if (s.b >= s.blocks) {
+            s.pc = 2;
+            return false;
+        }
+        const int start = s.lo + s.pos - s.rest;
+        compare_step(s.b, s.mid_key, result);
+        const int next_origin = (arr[s.b] < arr[s.mid_key]) ? 0 : 1;
+        if (next_origin == s.origin) {
+            call_swap_n(start - s.block_size, start, s.rest);
+            s.rest = s.block_size;
+        } else {
+            call_smart(start, s.block_size);
+        }
+        ++s.b;
+        s.pos += s.block_size;
+        return true;
+    }
+    case 2: // The fragment and the trailing left blocks meet the partial last block
+        s.start = s.lo + s.pos - s.rest;
+        if (s.last == 0) {
+            --m_depth;
+            call_swap_n(s.start - s.block_size, s.start, s.rest);
+            return false;
+        }
+        if (s.origin != 0) {
+            call_swap_n(s.start - s.block_size, s.start, s.rest);
+            s.start = s.lo + s.pos;
+            s.rest = s.block_size * s.trailing;
+        } else {
+            s.rest += s.block_size * s.trailing;
+        }
+        s.pc = 3;
+        return false;
+    default:
+        --m_depth;
+        call_merge_left(s.start, s.rest, s.last, -s.block_size);
+        return false;
+    }
+}
+
+bool BlockMergeSort::step_combine(std::vector<int>& arr, SortStepResult& result) {
+    CombineState& s = m_combine;
+    switch (s.pc) {
+    case 0: { // Next pair of runs: sort the tags, then selection sort the blocks
+        if (s.p > s.pairs || (s.p == s.pairs && s.leftover == 0)) {
+            s.i = s.size - 1;
+            s.pc = 5;
+            return false;
+        }
+        const bool partial = (s.p == s.pairs);
+        s.pair = s.lo + (s.p * 2 * s.run);
+        s.blocks = (partial ? s.leftover : 2 * s.run) / s.block_size;
+        s.last = partial ? s.leftover % s.block_size : 0;
+        s.mid = s.run / s.block_size;
+        s.u = 1;
+        s.pc = 1;
+        call_insertion(0, s.blocks + (partial ? 1 : 0));
+        return false;
+    }
+    case 1:
+        if (s.u < s.blocks) {
+            s.min = s.u - 1;
+            s.v = s.u;
+            s.pc = 2;
+        } else {
+            s.trailing = 0;
+            s.pc = (s.last != 0) ? 3 : 4;
+        }
+        return false;
+    case 2: { // Smallest first element from block u - 1 on, ties to the smaller tag
+        if (s.v < s.blocks) {
+            const int first_v = s.pair + s.v * s.block_size;
+            const int first_min = s.pair + s.min * s.block_size;
+            compare_step(first_v, first_min, result);
+            if (arr[first_v] < arr[first_min]) {
+                s.min = s.v;
+            } else if (!(arr[first_min] < arr[first_v])) {
+                compare_step(s.v, s.min, result);
+                if (arr[s.v] < arr[s.min]) {
+                    s.min = s.v;
+                }
+            }
+            ++s.v;
+            return true;
+        }
+        const int target = s.u - 1;
+        ++s.u;
+        s.pc = 1;
+        if (s.min == target) {
+            return false;
+        }
+        swap_step(arr, target, s.min, result);
+        if (s.mid == target || s.mid == s.min) {
+            s.mid ^= target ^ s.min;
+        }
+        call_swap_n(s.pair + target * s.block_size, s.pair + s.min * s.block_size, s.block_size);
+        return true;
+    }
+    case 3: { // Left blocks past the partial last block's first element stay behind the full-block merge
+        if (s.trailing < s.blocks) {
+            const int first_last = s.pair + s.blocks * s.block_size;
+            const int first_block = s.pair + (s.blocks - s.trailing - 1) * s.block_size;
+            compare_step(first_last, first_block, result);
+            if (arr[first_last] < arr[first_block]) {
+                ++s.trailing;
+            } else {
+                s.pc = 4;
+            }
+            return true;
+        }
+        s.pc = 4;
+        return false;
+    }
+    case 4:
+        call_buffers_left(s.mid, s.pair, s.blocks - s.trailing, s.block_size, s.trailing, s.last);
+        ++s.p;
+        s.pc = 0;
+        return false;
+    default: // The merges moved the buffer behind the data, bring it back to the front
+        if (s.i >= 0) {
+            swap_step(arr, s.lo + s.i, s.lo + s.i - s.block_size, result);
+            --s.i;
+            return true;
+        }
+        --m_depth;
+        return false;
+    }
+}
+
+bool BlockMergeSort::step_build(std::vector<int>& arr, SortStepResult& result) {
+    BuildState& s = m_build;
+    switch (s.pc) {
+    case 0: // Sorted pairs, written two to the left
+        if (s.m < s.size) {
+            compare_step(s.lo + s.m - 1, s.lo + s.m, result);
+            s.u = (arr[s.lo + s.m] < arr[s.lo + s.m - 1]) ? 1 : 0;
+            swap_step(arr, s.lo + s.m - 3, s.lo + s.m - 1 + s.u, result);
+            s.pc = 1;
+            return true;
+        }
+        s.pc = 2;
+        if (s.size % 2 != 0) {
+            swap_step(arr, s.lo + s.size - 1, s.lo + s.size - 3, result);
+            return true;
+        }
+        return false;
+    case 1:
+        swap_step(arr, s.lo + s.m - 2, s.lo + s.m - s.u, result);
+        s.m += 2;
+        s.pc = 0;
+        return true;
+    case 2:
+        s.cur = s.lo - 2;
+        s.h = 2;
+        s.pc = 3;
+        return false;
+    case 3: // Next level merged to the left
+        if (s.h < s.buffer) {
+            s.p = 0;
+            s.pc = 4;
+        } else {
+            const int rest = s.size % (2 * s.buffer);
+            s.p = s.size - rest;
+            if (rest <= s.buffer) {
+                call_rotate(s.cur + s.p, rest, s.buffer);
+            } else {
+                call_merge_right(s.cur + s.p, s.buffer, rest - s.buffer, s.buffer);
+            }
+            s.pc = 5;
+        }
+        return false;
+    case 4: {
+        if (s.p <= s.size - 2 * s.h) {
+            call_merge_left(s.cur + s.p, s.h, s.h, -s.h);
+            s.p += 2 * s.h;
+            return false;
+        }
+        const int rest = s.size - s.p;
+        if (rest > s.h) {
+            call_merge_left(s.cur + s.p, s.h, rest - s.h, -s.h);
+        } else {
+            call_rotate(s.cur + s.p - s.h, s.h, rest);
+        }
+        s.cur -= s.h;
+        s.h *= 2;
+        s.pc = 3;
+        return false;
+    }
+    default: // The last level is merged to the right, which moves the buffer back in front
+        if (s.p > 0) {
+            s.p -= 2 * s.buffer;
+            call_merge_right(s.cur + s.p, s.buffer, s.buffer, s.buffer);
+            return false;
+        }
+        --m_depth;
+        return false;
+    }
+}
+
+bool BlockMergeSort::step_find_keys(const std::vector<int>& arr, SortStepResult& result) {
+    FindKeysState& s = m_find_keys;
+    switch (s.pc) {
+    case 0: // Look the next element up among the keys found so far
+        if (s.i < s.size && s.found < s.wanted) {
+            call_search(s.first, s.found, s.i, false);
+            s.pc = 1;
+            return false;
+        }
+        --m_depth;
+        call_rotate(0, s.first, s.found);
+        return false;
+    case 1:
+        s.r = m_search_result;
+        s.pc = 2;
+        if (s.r == s.found) {
+            s.is_new = true;
+            return false;
+        }
+        compare_step(s.i, s.first + s.r, result);
+        s.is_new = arr[s.i] < arr[s.first + s.r];
+        return true;
+    case 2: // A new key: the keys move up to it and it is rotated into place
+        if (!s.is_new) {
+            ++s.i;
+            s.pc = 0;
+            return false;
+        }
+        call_rotate(s.first, s.found, s.i - (s.first + s.found));
+        s.first = s.i - s.found;
+        s.pc = 3;
+        return false;
+    default:
+        call_rotate(s.first + s.r, s.found - s.r, 1);
+        ++s.found;
+        ++s.i;
+        s.pc = 0;
+        return false;
+    }
+}
+
+bool BlockMergeSort::step_without_buffer(const std::vector<int>& arr, SortStepResult& result) {
+    WithoutBufferState& s = m_without_buffer;
+    switch (s.pc) {
+    case 0:
+        if (s.left <= 0) {
+            --m_depth;
+            return false;
+        }
+        call_search(s.lo + s.left, s.right, s.lo, false);
+        s.pc = 1;
+        return false;
+    case 1: {
+        const int h = m_search_result;
+        if (h != 0) {
+            call_rotate(s.lo, s.left, h);
+            s.lo += h;
+            s.right -= h;
+        }
+        s.pc = 2;
+        return false;
+    }
+    case 2:
+        if (s.right == 0) {
+            --m_depth;
+            return false;
+        }
+        ++s.lo;
+        --s.left;
+        s.pc = 3;
+        return false;
+    default: // Skip the keys that are already in place
+        if (s.left <= 0) {
+            s.pc = 0;
+            return false;
+        }
+        compare_step(s.lo + s.left, s.lo, result);
+        if (!(arr[s.lo + s.left] < arr[s.lo])) {
+            ++s.lo;
+            --s.left;
+        } else {
+            s.pc = 0;
+        }
+        return true;
+    }
+}
+
+SortStepResult BlockMergeSort::step(std::vector<int>& arr) {
+    SortStepResult result;
+
+    if (m_done || m_size <= 1 || (int)arr.size() < m_size) {
+        result.done = true;
+        m_done = true;
+        return result;
+    }
+
+    if (m_stage == 5) {
+        result = m_fallback.step(arr);
+        m_done = result.done;
+        return result;
+    }
+
+    while (true) {
+        if (m_depth > 0) {
+            bool stepped = false;
+            switch (m_calls[m_depth - 1]) {
+            case Routine::SwapN:
+                stepped = step_swap_n(arr, result);
+                break;
+            case Routine::Rotate:
+                stepped = step_rotate();
+                break;
+            case Routine::Search:
+                stepped = step_search(arr, result);
+                break;
+            case Routine::Insertion:
+                stepped = step_insertion(arr, result);
+                break;
+            case Routine::MergeLeft:
+                stepped = step_merge_left(arr, result);
+                break;
+            case Routine::MergeRight:
+                stepped = step_merge_right(arr, result);
+                break;
+            case Routine::Smart:
+                stepped = step_smart(arr, result);
+                break;
+            case Routine::BuffersLeft:
+                stepped = step_buffers_left(arr, result);
+                break;
+            case Routine::Combine:
+                stepped = step_combine(arr, result);
+                break;
+            case Routine::Build:
+                stepped = step_build(arr, result);
+                break;
+            case Routine::FindKeys:
+                stepped = step_find_keys(arr, result);
+                break;
+            case Routine::WithoutBuffer:
+                stepped = step_without_buffer(arr, result);
+                break;
+            }
+            if (stepped) {
+                return result;
+            }
+            continue;
+        }
+
+        // The top level, once the previous phase's routine returned
+        if (m_stage == 0) {
+            if (m_find_keys.found < m_wanted) {
+                // Too few distinct keys for the buffer and the tags, the keys found stay in front (stably)
+                m_stage = 5;
+                m_fallback.set_access_counters(m_access);
+                m_fallback.reset(m_size);
+                result = m_fallback.step(arr);
+                m_done = result.done;
+                return result;
+            }
+            call_build(m_wanted, m_size - m_wanted, m_block);
+            m_run = 2 * m_block;
+            m_stage = 1;
+            continue;
+        }
+        if (m_stage <= 2) {
+            if (m_size - m_wanted > m_run) {
+                call_combine(m_wanted, m_size - m_wanted, m_run, m_block);
+                m_run *= 2;
+                m_stage = 2;
+                continue;
+            }
+            // The keys are distinct, so sorting them can't break stability, then they merge back in
+            call_insertion(0, m_wanted);
+            m_stage = 3;
+            continue;
+        }
+        if (m_stage == 3 && m_size >= BLOCK_MERGE_MIN_SIZE) {
+            call_without_buffer(0, m_wanted, m_size - m_wanted);
+            m_stage = 4;
+            continue;
+        }
+
+        m_done = true;
+        result.done = true;
+        return result;
+    }
+}
+
+const char* BlockMergeSort::phase() const {
+    switch (m_stage) {
+    case 0:
+        return "collect keys";
+    case 1:
+        return "build runs";
+    case 2:
+        return "block merge";
+    case 3:
+    case 4:
+        return "merge keys";
+    default:
+        return m_fallback.phase();
+    }
+}
+
+void BlockMergeSort::sort(std::vector<int>& arr) {
+    m_stage = 4;
+    if (!block_merge_sort(arr.data(), (int)arr.size())) {
+        m_stage = 5;
+        m_fallback.sort(arr);
+    }
+    m_done = true;
+}
+
+// Only the SymMerge fallback has a stack, the block merge itself keeps a fixed set of indexes
+size_t BlockMergeSort::aux_memory_bytes() const {
+    return (m_stage == 5) ? m_fallback.aux_memory_bytes() : 0;
+}
+
+/* COUNTING SORT IMPLEMENTATION */
+bool counting_range_fits(long long key_range, int size) {
+    return key_range <= std::max(COUNTING_MIN_RANGE, COUNTING_RANGE_PER_KEY * size);
+}
+
+CountingSort::CountingSort(bool stable) : m_stable(stable) {
+    if (stable) {
+        m_fallback = std::make_unique<MergeSort>();
+    } else {
+        m_fallback = std::make_unique<HeapSort>();
+    }
+}
+
+size_t CountingSort::aux_memory_bytes() const {
+    if (m_use_fallback) {
+        return m_fallback->aux_memory_bytes();
+    }
+    return (m_counts.size() + m_buffer.size()) * sizeof(int);
+}
+
+const char* CountingSort::name() const {
+    return m_stable ? "Counting Sort (stable)" : "Counting Sort";
+}
+
+void CountingSort::reset(int size) {
+    m_size = size;
+    m_counts.clear();
+    m_buffer.clear();
+    m_stage = 0;
+    m_i = 0;
+    m_min = INT_MAX;
+    m_max = INT_MIN;
+    m_bucket = 0;
+    m_use_fallback = false;
+    m_done = (size <= 1);
+}
+
+SortStepResult CountingSort::step(std::vector<int>& arr) {
+    SortStepResult result;
+
+    if (m_done || m_size <= 1 || (int)arr.size() < m_size) {
+        result.done = true;
+        m_done = true;
+        return result;
+    }
+
+    // Counting sort never compares two elements, so steps only read (scan/count) or write (write back/copy back)
+    while (true) {
+        if (m_stage == 0) { // Detect the key range in a single pass
+            if (m_i < m_size) {
+                result.hi1 = m_i;
+                count_read(m_i);
+                m_min = std::min(m_min, arr[m_i]);
+                m_max = std::max(m_max, arr[m_i]);
+                ++m_i;
+                return result;
+            }
+
+            // A histogram of a wide key range (e.g. full-range ints) wouldn't fit in memory
+            if (!counting_range_fits((long long)m_max - m_min + 1, m_size)) {
+                m_use_fallback = true;
+                m_fallback->set_access_counters(m_access);
+                m_fallback->reset(m_size);
+                m_stage = 4;
+                continue;
+            }
+
+            m_counts.assign((size_t)((long long)m_max - m_min + 1), 0);
+            m_i = 0;
+            m_stage = 1;
+            continue;
+        }
+
+        if (m_stage == 4) {
+            result = m_fallback->step(arr);
+            m_done = result.done;
+            return result;
+        }
+
+        if (m_stage == 1) { // Histogram of the keys
+            if (m_i < m_size) {
+                result.hi1 = m_i;
+                count_read(m_i);
+                count_buffer_read(arr[m_i] - m_min);
+                count_buffer_write(arr[m_i] - m_min);
+                ++m_counts[arr[m_i] - m_min];
+                result.write_count = 1; // The histogram is a buffer too
+                ++m_i;
+                return result;
+            }
+
+            // The stable variant turns the counts into starting offsets for the scatter
+            if (m_stable) {
+                int offset = 0;
+                for (int& count : m_counts) {
+                    const int bucket_count = count;
+                    count = offset;
+                    offset += bucket_count;
+                }
+                m_buffer.assign(m_size, 0);
+            }
+            m_i = 0;
+            m_bucket = 0;
+            m_stage = 2;
+            continue;
+        }
+
+        if (m_stage == 2 && !m_stable) { // Rewrite the keys bucket by bucket
+            while (m_counts[m_bucket] == 0) {
+                count_buffer_read(m_bucket);
+                ++m_bucket;
+            }
+
+            arr[m_i] = m_min + m_bucket;
+            --m_counts[m_bucket];
+            count_write(m_i);
+            count_buffer_read(m_bucket);
+            count_buffer_write(m_bucket);
+            result.hi1 = m_i;
+            result.hi2 = m_i;
+            result.swapped = true;
+            result.write_count = 2; // The key and its bucket's count
+            ++m_i;
+
+            if (m_i >= m_size) {
+                m_done = true;
+                result.done = true;
+            }
+            return result;
+        }
+
+        if (m_stage == 2) { // Stable scatter into the buffer, in input order
+            if (m_i < m_size) {
+                result.hi1 = m_i;
+                count_read(m_i);
+                count_buffer_write(m_counts[arr[m_i] - m_min]);
+                m_buffer[m_counts[arr[m_i] - m_min]++] = arr[m_i];
+                result.write_count = 1;
+                ++m_i;
+                return result;
+            }
+
+            m_i = 0;
+            m_stage = 3;
+            continue;
+        }
+
+        // Copy the buffer back into the array
+        arr[m_i] = m_buffer[m_i];
+        count_buffer_read(m_i);
+        count_write(m_i);
+        result.hi1 = m_i;
+        result.hi2 = m_i;
+        result.swapped = true;
+        result.write_count = 1;
+        ++m_i;
+
+        if (m_i >= m_size) {
+            m_done = true;
+            result.done = true;
+        }
+        return result;
+    }
+}
+
+const char* CountingSort::phase() const {
+    switch (m_stage) {
+    case 4:
+        return m_fallback->phase();
+    case 0:
+        return "range scan";
+    case 1:
+        return "count";
+    case 2:
+        return m_stable ? "scatter" : "write back";
+    default:
+        return "copy back";
+    }
+}
+
+void CountingSort::sort(std::vector<int>& arr) {
+    const int size = (int)arr.size();
+    m_counts.clear();
+    m_buffer.clear();
+    m_use_fallback = false;
+    m_done = true;
+    if (size <= 1) {
+        return;
+    }
+
+    const auto range = std::minmax_element(arr.begin(), arr.end());
+    const int min_key = *range.first;
+    const long long key_range = (long long)*range.second - min_key + 1;
+    if (!counting_range_fits(key_range, size)) {
+        m_use_fallback = true;
+        m_fallback->sort(arr);
+        return;
+    }
+
+    m_counts.assign((size_t)key_range, 0);
+    for (int i = 0; i < size; ++i) {
+        ++m_counts[arr[i] - min_key];
+    }
+
+    if (!m_stable) {
+        int i = 0;
+        for (int bucket = 0; bucket < (int)key_range; ++bucket) {
+            for (int count = m_counts[bucket]; count > 0; --count) {
+                arr[i++] = min_key + bucket;
+            }
+        }
+        return;
+    }
+
+    int offset = 0;
+    for (int& count : m_counts) {
+        const int bucket_count = count;
+        count = offset;
+        offset += bucket_count;
+    }
+    m_buffer.resize(size);
+    for (int i = 0; i < size; ++i) {
+        m_buffer[m_counts[arr[i] - min_key]++] = arr[i];
+    }
+    std::copy(m_buffer.begin(), m_buffer.end(), arr.begin());
+}
+
+void counting_sort_stable(std::vector<int>& keys, std::vector<int>& values) {
+    const int size = (int)std::min(keys.size(), values.size());
+    if (size <= 1) {
+        return;
+    }
+
+    const auto range = std::minmax_element(keys.begin(), keys.begin() + size);
+    const int min_key = *range.first;
+    const long long key_range = (long long)*range.second - min_key + 1;
+    if (!counting_range_fits(key_range, size)) {
+        std::vector<std::pair<int, int>> pairs(size);
+        for (int i = 0; i < size; ++i) {
+            pairs[i] = {keys[i], values[i]};
+        }
+        std::stable_sort(pairs.begin(), pairs.end(),
+            [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; });
+        for (int i = 0; i < size; ++i) {
+            keys[i] = pairs[i].first;
+            values[i] = pairs[i].second;
+        }
+        return;
+    }
+
+    std::vector<int> offsets((size_t)key_range, 0);
+    for (int i = 0; i < size; ++i) {
+        ++offsets[keys[i] - min_key];
+    }
+
+    int offset = 0;
+    for (int& count : offsets) {
+        const int bucket_count = count;
+        count = offset;
+        offset += bucket_count;
+    }
+
+    std::vector<int> sorted_keys(size);
+    std::vector<int> sorted_values(size);
+    for (int i = 0; i < size; ++i) {
+        const int dest = offsets[keys[i] - min_key]++;
+        sorted_keys[dest] = keys[i];
+        sorted_values[dest] = values[i];
+    }
+
+    std::copy(sorted_keys.begin(), sorted_keys.end(), keys.begin());
+    std::copy(sorted_values.begin(), sorted_values.end(), values.begin());
+}
+
+/* PARALLEL MERGE SORT IMPLEMENTATION */
+ParallelMergeSort::ParallelMergeSort(int threads) {
+    set_threads(threads);
+}
+
+const char* ParallelMergeSort::name() const {
+    return "Parallel Merge Sort";
+}
+
+void ParallelMergeSort::set_threads(int threads) {
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    m_threads = std::max(1, threads);
+}
+
+// Number of elements taken from a among the first k outputs of the stable merge of a and b
+int ParallelMergeSort::co_rank(int k, const int* a, int a_size, const int* b, int b_size) {
+    int lo = std::max(0, k - b_size);
+    int hi = std::min(k, a_size);
+    while (lo < hi) {
+        const int i = lo + ((hi - lo) / 2);
+        const int j = k - i;
+        if (j > 0 && a[i] <= b[j - 1]) { // a[i] still belongs in front of b[j - 1]
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+// Co-ranks the part of merge pair `pair` whose output falls into [out_lo, out_hi)
+ParallelMergeSort::MergeSegment ParallelMergeSort::level_segment(const int* src, const std::vector<int>& runs, int pair, int out_lo, int out_hi) {
+    const int last = (int)runs.size() - 1;
+    const int lo = runs[2 * pair];
+    const int mid = runs[std::min((2 * pair) + 1, last)];
+    const int hi = runs[std::min((2 * pair) + 2, last)];
+    const int start = std::max(out_lo, lo) - lo;
+    const int end = std::max(start, std::min(out_hi, hi) - lo);
+
+    const int start_i = co_rank(start, src + lo, mid - lo, src + mid, hi - mid);
+    const int end_i = co_rank(end, src + lo, mid - lo, src + mid, hi - mid);
+
+    MergeSegment seg;
+    seg.a_lo = lo + start_i;
+    seg.a_hi = lo + end_i;
+    seg.b_lo = mid + (start - start_i);
+    seg.b_hi = mid + (end - end_i);
+    seg.out = lo + start;
+    return seg;
+}
+
+// Produces dst[out_lo, out_hi) of one merge level, whichever merge pairs that slice crosses
+void ParallelMergeSort::merge_slice(const int* src, int* dst, const std::vector<int>& runs, int out_lo, int out_hi) {
+    if (out_lo >= out_hi) {
+        return;
+    }
+
+    const int last = (int)runs.size() - 1;
+    int pair = (int)(std::upper_bound(runs.begin(), runs.end(), out_lo) - runs.begin() - 1) / 2;
+    for (; (2 * pair) < last && runs[2 * pair] < out_hi; ++pair) {
+        const MergeSegment seg = level_segment(src, runs, pair, out_lo, out_hi);
+        int i = seg.a_lo;
+        int j = seg.b_lo;
+        int k = seg.out;
+        while (i < seg.a_hi && j < seg.b_hi) {
+            dst[k++] = (src[j] < src[i]) ? src[j++] : src[i++];
+        }
+        while (i < seg.a_hi) {
+            dst[k++] = src[i++];
+        }
+        while (j < seg.b_hi) {
+            dst[k++] = src[j++];
+        }
+    }
+}
+
+// Run boundaries of the next level: every merge pair becomes a single run
+void ParallelMergeSort::halve_runs(std::vector<int>& runs) {
+    const int end = runs.back();
+    int count = 0;
+    for (int i = 0; i < (int)runs.size(); i += 2) {
+        runs[count++] = runs[i];
+    }
+    if (runs[count - 1] != end) {
+        runs[count++] = end;
+    }
+    runs.resize(count);
+}
+
+void ParallelMergeSort::reset(int size) {
+    m_size = size;
+    m_buffer.assign(size, 0);
+    m_runs.resize(std::max(0, size + 1));
+    for (int i = 0; i <= size; ++i) {
+        m_runs[i] = i;
+    }
+    m_next_worker = 0;
+    m_copying_back = false;
+    m_regions.clear();
+    m_aux_bytes = (m_buffer.size() + m_runs.size()) * sizeof(int);
+    m_done = (size <= 1);
+
+    if (!m_done) {
+        start_level();
+    }
+}
+
+// Splits the output of the current level evenly between the simulated workers. Co-ranking needs the array,
+// so each worker only positions itself before its first merge pair and step() co-ranks on its first turn.
+void ParallelMergeSort::start_level() {
+    for (int w = 0; w < STEPPED_WORKERS; ++w) {
+        Worker& worker = m_workers[w];
+        worker.out_lo = (m_size * w) / STEPPED_WORKERS;
+        worker.out_hi = (m_size * (w + 1)) / STEPPED_WORKERS;
+        worker.pair = ((int)(std::upper_bound(m_runs.begin(), m_runs.end(), worker.out_lo) - m_runs.begin() - 1) / 2) - 1;
+        worker.seg = MergeSegment();
+        worker.k = worker.out_lo;
+        worker.busy = (worker.out_lo < worker.out_hi);
+    }
+}
+
+// Each busy worker owns what is left of its current merge segment plus the rest of its output slice
+void ParallelMergeSort::update_regions() {
+    m_regions.clear();
+    const int last = (int)m_runs.size() - 1;
+    for (int w = 0; w < STEPPED_WORKERS; ++w) {
+        const Worker& worker = m_workers[w];
+        if (!worker.busy) {
+            continue;
+        }
+
+        if (m_copying_back) {
+            m_regions.push_back({worker.k, worker.out_hi - 1, w});
+            continue;
+        }
+
+        if (worker.seg.a_lo < worker.seg.a_hi) {
+            m_regions.push_back({worker.seg.a_lo, worker.seg.a_hi - 1, w});
+        }
+        if (worker.seg.b_lo < worker.seg.b_hi) {
+            m_regions.push_back({worker.seg.b_lo, worker.seg.b_hi - 1, w});
+        }
+
+        const int next_pair_lo = m_runs[std::min(2 * (worker.pair + 1), last)];
+        const int rest_lo = std::max(next_pair_lo, worker.out_lo);
+        if (rest_lo < worker.out_hi) {
+            m_regions.push_back({rest_lo, worker.out_hi - 1, w});
+        }
+    }
+}
+
+size_t ParallelMergeSort::aux_memory_bytes() const {
+    return m_aux_bytes;
+}
+
+const std::vector<SortRegion>& ParallelMergeSort::regions() const {
+    return m_regions;
+}
+
+SortStepResult ParallelMergeSort::step(std::vector<int>& arr) {
+    SortStepResult result;
+
+    if (m_done || m_size <= 1 || (int)arr.size() < m_size) {
+        result.done = true;
+        m_done = true;
+        m_regions.clear();
+        return result;
+    }
+
+    while (true) {
+        // Workers take turns, one step each
+        int w = -1;
+        for (int attempt = 0; attempt < STEPPED_WORKERS; ++attempt) {
+            const int candidate = (m_next_worker + attempt) % STEPPED_WORKERS;
+            if (m_workers[candidate].busy) {
+                w = candidate;
+                break;
+            }
+        }
+
+        // Every worker finished the current phase (merge into the buffer, then copy back)
+        if (w < 0) {
+            if (!m_copying_back) {
+                m_copying_back = true;
+                for (Worker& worker : m_workers) {
+                    worker.k = worker.out_lo;
+                    worker.busy = (worker.out_lo < worker.out_hi);
+                }
+                continue;
+            }
+
+            m_copying_back = false;
+            halve_runs(m_runs);
+            if (m_runs.size() <= 2) {
+                m_done = true;
+                result.done = true;
+                m_regions.clear();
+                return result;
+            }
+            start_level();
+            continue;
+        }
+
+        m_next_worker = (w + 1) % STEPPED_WORKERS;
+        Worker& worker = m_workers[w];
+
+        if (m_copying_back) {
+            arr[worker.k] = m_buffer[worker.k];
+            count_buffer_read(worker.k);
+            count_write(worker.k);
+            result.hi1 = worker.k;
+            result.hi2 = worker.k;
+            result.swapped = true;
+            ++result.write_count;
+            ++worker.k;
+            worker.busy = (worker.k < worker.out_hi);
+            update_regions();
+            return result;
+        }
+
+        MergeSegment& seg = worker.seg;
+        if (seg.a_lo < seg.a_hi && seg.b_lo < seg.b_hi) {
+            result.hi1 = seg.a_lo;
+            result.hi2 = seg.b_lo;
+            result.compared = true;
+            count_compare(seg.a_lo, seg.b_lo);
+            count_buffer_write(worker.k);
+            if (arr[seg.b_lo] < arr[seg.a_lo]) {
+                m_buffer[worker.k++] = arr[seg.b_lo++];
+            } else {
+                m_buffer[worker.k++] = arr[seg.a_lo++];
+            }
+            ++result.write_count;
+            update_regions();
+            return result;
+        }
+
+        result.write_count += (seg.a_hi - seg.a_lo) + (seg.b_hi - seg.b_lo);
+        while (seg.a_lo < seg.a_hi) {
+            count_read(seg.a_lo);
+            count_buffer_write(worker.k);
+            m_buffer[worker.k++] = arr[seg.a_lo++];
+        }
+        while (seg.b_lo < seg.b_hi) {
+            count_read(seg.b_lo);
+            count_buffer_write(worker.k);
+            m_buffer[worker.k++] = arr[seg.b_lo++];
+        }
+
+        // Move on to the next merge pair overlapping this worker's slice
+        ++worker.pair;
+        const int last = (int)m_runs.size() - 1;
+        if ((2 * worker.pair) >= last || m_runs[2 * worker.pair] >= worker.out_hi) {
+            worker.busy = false;
+            continue;
+        }
+        seg = level_segment(arr.data(), m_runs, worker.pair, worker.out_lo, worker.out_hi);
+        worker.k = seg.out;
+    }
+}
+
+const char* ParallelMergeSort::phase() const {
+    return m_copying_back ? "copy back" : "merge";
+}
+
+void ParallelMergeSort::sort(std::vector<int>& arr) {
+    const int size = (int)arr.size();
+    if (size <= 1) {
+        return;
+    }
+
+    // Leaf chunks are sorted on their own threads, but never so small that spawning a thread costs more than sorting
+    const int workers = std::max(1, std::min(m_threads, size / MIN_CHUNK_SIZE));
+    std::vector<int> runs(workers + 1);
+    for (int w = 0; w <= workers; ++w) {
+        runs[w] = (int)(((long long)size * w) / workers);
+    }
+
+    run_workers(workers, [&](int worker) {
+        std::stable_sort(arr.begin() + runs[worker], arr.begin() + runs[worker + 1]);
+    });
+
+    // Merge levels ping-pong between the array and the buffer, every worker producing an equal output slice
+    std::vector<int> buffer(size);
+    m_aux_bytes = (buffer.size() + runs.size()) * sizeof(int);
+    int* src = arr.data();
+    int* dst = buffer.data();
+    while (runs.size() > 2) {
+        run_workers(workers, [&](int worker) {
+            const int out_lo = (int)(((long long)size * worker) / workers);
+            const int out_hi = (int)(((long long)size * (worker + 1)) / workers);
+            merge_slice(src, dst, runs, out_lo, out_hi);
+        });
+        halve_runs(runs);
+        std::swap(src, dst);
+    }
+
+    if (src != arr.data()) {
+        run_workers(workers, [&](int worker) {
+            const int out_lo = (int)(((long long)size * worker) / workers);
+            const int out_hi = (int)(((long long)size * (worker + 1)) / workers);
+            std::copy(buffer.begin() + out_lo, buffer.begin() + out_hi, arr.begin() + out_lo);
+        });
+    }
+}
+
+/* PARALLEL QUICK SORT IMPLEMENTATION */
+struct ParallelQuickSort::WorkDeque {
+    std::mutex mutex;
+    std::deque<Range> ranges;
+};
+
+ParallelQuickSort::ParallelQuickSort(int threads, bool work_stealing) : m_work_stealing(work_stealing) {
+    set_threads(threads);
+}
+
+const char* ParallelQuickSort::name() const {
+    return m_work_stealing ? "Parallel Quick Sort (work stealing)" : "Parallel Quick Sort (fork/join)";
+}
+
+void ParallelQuickSort::set_threads(int threads) {
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    m_threads = std::max(1, threads);
+}
+
+void ParallelQuickSort::reset(int size) {
+    m_size = size;
+    for (Worker& worker : m_workers) {
+        worker = Worker();
+    }
+    m_next_worker = 0;
+    m_regions.clear();
+    m_done = (size <= 1);
+
+    if (!m_done) {
+        m_workers[0].deque.push_back({0, size - 1});
+    }
+}
+
+// Own sequential ranges first, then the back of the own deque, then the front of the other workers' deques
+bool ParallelQuickSort::take_work(int w, const std::vector<int>& arr) {
+    Worker& worker = m_workers[w];
+    Range range;
+    if (!worker.local.empty()) {
+        range = worker.local.back();
+        worker.local.pop_back();
+    } else if (!worker.deque.empty()) {
+        range = worker.deque.back();
+        worker.deque.pop_back();
+    } else {
+        bool stolen = false;
+        for (int attempt = 1; attempt < STEPPED_WORKERS && !stolen; ++attempt) {
+            Worker& victim = m_workers[(w + attempt) % STEPPED_WORKERS];
+            if (!victim.deque.empty()) {
+                range = victim.deque.front();
+                victim.deque.pop_front();
+                stolen = true;
+            }
+        }
+        if (!stolen) {
+            return false;
+        }
+    }
+
+    if (range.hi - range.lo + 1 <= INSERTION_SORT_THRESHOLD) {
+        worker.inserting = true;
+        worker.ins_lo = range.lo;
+        worker.ins_hi = range.hi;
+        worker.ins_i = range.lo + 1;
+        worker.ins_j = worker.ins_i;
+        return true;
+    }
+
+    worker.partitioning = true;
+    worker.lo = range.lo;
+    worker.hi = range.hi;
+    worker.pivot = arr[range.lo + ((range.hi - range.lo) / 2)];
+    count_read(range.lo + ((range.hi - range.lo) / 2));
+    worker.lt = range.lo;
+    worker.i = range.lo;
+    worker.gt = range.hi;
+    return true;
+}
+
+void ParallelQuickSort::update_regions() {
+    m_regions.clear();
+    for (int w = 0; w < STEPPED_WORKERS; ++w) {
+        const Worker& worker = m_workers[w];
+        if (worker.partitioning) {
+            m_regions.push_back({worker.lo, worker.hi, w});
+        } else if (worker.inserting) {
+            m_regions.push_back({worker.ins_lo, worker.ins_hi, w});
+        }
+    }
+}
+
+const std::vector<SortRegion>& ParallelQuickSort::regions() const {
+    return m_regions;
+}
+
+// step() always simulates the work-stealing scheduler with STEPPED_WORKERS workers taking turns
+SortStepResult ParallelQuickSort::step(std::vector<int>& arr) {
+    SortStepResult result;
+
+    if (m_done || m_size <= 1 || (int)arr.size() < m_size) {
+        result.done = true;
+        m_done = true;
+        m_regions.clear();
+        return result;
+    }
+
+    while (true) {
+        int w = -1;
+        for (int attempt = 0; attempt < STEPPED_WORKERS; ++attempt) {
+            const int candidate = (m_next_worker + attempt) % STEPPED_WORKERS;
+            const Worker& worker = m_workers[candidate];
+            if (worker.partitioning || worker.inserting || take_work(candidate, arr)) {
+                w = candidate;
+                break;
+            }
+        }
+
+        // No worker has or can steal any work left
+        if (w < 0) {
+            m_done = true;
+            result.done = true;
+            m_regions.clear();
+            return result;
+        }
+
+        m_next_worker = (w + 1) % STEPPED_WORKERS;
+        Worker& worker = m_workers[w];
+
+        if (worker.inserting) {
+            if (worker.ins_i > worker.ins_hi) {
+                worker.inserting = false;
+                continue;
+            }
+
+            if (worker.ins_j <= worker.ins_lo) {
+                ++worker.ins_i;
+                worker.ins_j = worker.ins_i;
+                continue;
+            }
+
+            result.hi1 = worker.ins_j - 1;
+            result.hi2 = worker.ins_j;
+            result.compared = true;
+            count_compare(worker.ins_j - 1, worker.ins_j);
+            if (arr[worker.ins_j - 1] > arr[worker.ins_j]) {
+                std::swap(arr[worker.ins_j - 1], arr[worker.ins_j]);
+                count_swap(worker.ins_j - 1, worker.ins_j);
+                result.swapped = true;
+                result.write_count = 2;
+                --worker.ins_j;
+            } else {
+                ++worker.ins_i;
+                worker.ins_j = worker.ins_i;
+            }
+            update_regions();
+            return result;
+        }
+
+        if (worker.i <= worker.gt) {
+            result.hi1 = worker.i;
+            result.hi2 = worker.gt;
+            result.compared = true;
+            count_read(worker.i);
+
+            if (arr[worker.i] < worker.pivot) {
+                if (worker.lt != worker.i) {
+                    std::swap(arr[worker.lt], arr[worker.i]);
+                    count_read(worker.lt);
+                    count_swap(worker.lt, worker.i);
+                    result.swapped = true;
+                    result.write_count = 2;
+                }
+                ++worker.lt;
+                ++worker.i;
+            } else if (arr[worker.i] > worker.pivot) {
+                if (worker.i != worker.gt) {
+                    std::swap(arr[worker.i], arr[worker.gt]);
+                    count_read(worker.gt);
+                    count_swap(worker.i, worker.gt);
+                    result.swapped = true;
+                    result.write_count = 2;
+                }
+                --worker.gt;
+            } else {
+                ++worker.i;
+            }
+
+            update_regions();
+            return result;
+        }
+
+        // Partition finished: big sides become stealable, small ones stay with this worker
+        const Range sides[2] = {{worker.lo, worker.lt - 1}, {worker.gt + 1, worker.hi}};
+        for (const Range& side : sides) {
+            const int side_size = side.hi - side.lo + 1;
+            if (side_size > STEPPED_SEQUENTIAL_CUTOFF) {
+                worker.deque.push_back(side);
+            } else if (side_size > 1) {
+                worker.local.push_back(side);
+            }
+        }
+        worker.partitioning = false;
+    }
+}
+
+// Same partition and sequential kernel as QuickSort::sort()
+void ParallelQuickSort::partition(int* arr, int lo, int hi, int& lt, int& gt) {
+    partition_3way(arr, lo, hi, lt, gt);
+}
+
+void ParallelQuickSort::sort_sequential(int* arr, int lo, int hi) {
+    quick_sort_3way(arr + lo, hi - lo + 1, LeafSort::Insertion, INSERTION_SORT_THRESHOLD);
+}
+
+// Baseline: partition, hand one side to a new thread and halve the thread budget until it runs out
+void ParallelQuickSort::sort_fork_join(int* arr, int lo, int hi, int threads) {
+    if (threads <= 1 || hi - lo + 1 <= SEQUENTIAL_CUTOFF) {
+        sort_sequential(arr, lo, hi);
+        return;
+    }
+
+    int lt = 0;
+    int gt = 0;
+    partition(arr, lo, hi, lt, gt);
+    std::thread left_thread(sort_fork_join, arr, lo, lt - 1, threads / 2);
+    sort_fork_join(arr, gt + 1, hi, threads - (threads / 2));
+    left_thread.join();
+}
+
+// `pending` counts the ranges that are queued or being worked on, so workers stop once it drops to zero
+void ParallelQuickSort::run_stealing_worker(int worker, int* arr, std::vector<WorkDeque>& deques, std::atomic<int>& pending) {
+    const int count = (int)deques.size();
+    while (true) {
+        Range range;
+        bool found = false;
+        for (int attempt = 0; attempt < count && !found; ++attempt) {
+            WorkDeque& deque = deques[(worker + attempt) % count];
+            std::lock_guard<std::mutex> lock(deque.mutex);
+            if (!deque.ranges.empty()) {
+                if (attempt == 0) {
+                    range = deque.ranges.back();
+                    deque.ranges.pop_back();
+                } else {
+                    range = deque.ranges.front();
+                    deque.ranges.pop_front();
+                }
+                found = true;
+            }
+        }
+
+        if (!found) {
+            if (pending.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Keep splitting: the bigger side goes to the own deque for thieves, this worker carries on with the smaller one
+        while (range.hi - range.lo + 1 > SEQUENTIAL_CUTOFF) {
+            int lt = 0;
+            int gt = 0;
+            partition(arr, range.lo, range.hi, lt, gt);
+
+            Range smaller = {range.lo, lt - 1};
+            Range bigger = {gt + 1, range.hi};
+            if (smaller.hi - smaller.lo > bigger.hi - bigger.lo) {
+                std::swap(smaller, bigger);
+            }
+
+            if (bigger.hi > bigger.lo) {
+                pending.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(deques[worker].mutex);
+                deques[worker].ranges.push_back(bigger);
+            }
+            range = smaller;
+        }
+
+        sort_sequential(arr, range.lo, range.hi);
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void ParallelQuickSort::sort(std::vector<int>& arr) {
+    const int size = (int)arr.size();
+    if (size <= 1) {
+        return;
+    }
+
+    if (!m_work_stealing) {
+        sort_fork_join(arr.data(), 0, size - 1, m_threads);
+        return;
+    }
+
+    std::vector<WorkDeque> deques(m_threads);
+    std::atomic<int> pending(1);
+    deques[0].ranges.push_back({0, size - 1});
+    run_workers(m_threads, [&](int worker) {
+        run_stealing_worker(worker, arr.data(), deques, pending);
+    });
+}
+
+/* PARALLEL SAMPLE SORT IMPLEMENTATION */
+ParallelSampleSort::ParallelSampleSort(int threads) {
+    set_threads(threads);
+}
+
+const char* ParallelSampleSort::name() const {
+    return "Parallel Sample Sort";
+}
+
+void ParallelSampleSort::set_threads(int threads) {
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    m_threads = std::max(1, threads);
+}
+
+size_t ParallelSampleSort::aux_memory_bytes() const {
+    return m_aux_bytes;
+}
+
+const std::vector<SortRegion>& ParallelSampleSort::regions() const {
+    return m_regions;
+}
+
+void ParallelSampleSort::reset(int size) {
+    m_size = size;
+    m_stage = 0;
+    m_i = 0;
+    m_tree.clear();
+    m_oracle.clear();
+    m_buffer.clear();
+    for (Bucket& bucket : m_buckets) {
+        bucket = Bucket();
+    }
+    m_next_bucket = 0;
+    m_regions.clear();
+    m_aux_bytes = 0;
+    m_done = (size <= 1);
+}
+
+// Buckets already copied back while copying, the unfinished ones while sorting
+void ParallelSampleSort::update_regions() {
+    m_regions.clear();
+    for (int b = 0; b < STEPPED_BUCKETS; ++b) {
+        const Bucket& bucket = m_buckets[b];
+        if (m_stage == 2 && bucket.lo < m_i) {
+            m_regions.push_back({bucket.lo, std::min(bucket.hi, m_i) - 1, b});
+        } else if (m_stage == 3 && bucket.i < bucket.hi) {
+            m_regions.push_back({bucket.lo, bucket.hi - 1, b});
+        }
+    }
+}
+
+SortStepResult ParallelSampleSort::step(std::vector<int>& arr) {
+    SortStepResult result;
+
+    if (m_done || m_size <= 1 || (int)arr.size() < m_size) {
+        result.done = true;
+        m_done = true;
+        m_regions.clear();
+        return result;
+    }
+
+    const int levels = splitter_tree_levels(STEPPED_BUCKETS);
+    while (true) {
+        if (m_stage == 0) { // Pick the splitters from a sorted sample
+            std::vector<int> splitters;
+            const long long compares = pick_splitters(arr.data(), m_size, STEPPED_BUCKETS, OVERSAMPLING, splitters, m_tree);
+            m_oracle.assign(m_size, 0);
+            m_aux_bytes = (m_tree.size() * sizeof(int)) + m_oracle.size();
+            result.compared = (compares > 0);
+            result.compare_count = (int)compares;
+            m_i = 0;
+            m_stage = 1;
+            return result;
+        }
+
+        if (m_stage == 1) { // Classify one element, one comparison per tree level
+            if (m_i < m_size) {
+                m_oracle[m_i] = (unsigned char)classify(m_tree.data(), levels, arr[m_i]);
+                count_read(m_i);
+                result.hi1 = m_i;
+                result.compared = true;
+                result.compare_count = levels;
+                ++m_i;
+                return result;
+            }
+
+            // Scatter into the buffer bucket by bucket, in input order
+            int counts[STEPPED_BUCKETS] = {};
+            for (int i = 0; i < m_size; ++i) {
+                ++counts[m_oracle[i]];
+            }
+            int offset = 0;
+            for (int b = 0; b < STEPPED_BUCKETS; ++b) {
+                m_buckets[b].lo = offset;
+                m_buckets[b].hi = offset + counts[b];
+                counts[b] = offset;
+                offset = m_buckets[b].hi;
+            }
+            m_buffer.assign(m_size, 0);
+            for (int i = 0; i < m_size; ++i) {
+                count_read(i);
+                count_buffer_write(counts[m_oracle[i]]);
+                m_buffer[counts[m_oracle[i]]++] = arr[i];
+            }
+            result.write_count += m_size;
+            m_aux_bytes += m_buffer.size() * sizeof(int);
+            m_i = 0;
+            m_stage = 2;
+            continue;
+        }
+
+        if (m_stage == 2) { // Copy the buckets back into the array
+            arr[m_i] = m_buffer[m_i];
+            count_buffer_read(m_i);
+            count_write(m_i);
+            result.hi1 = m_i;
+            result.hi2 = m_i;
+            result.swapped = true;
+            ++result.write_count;
+            ++m_i;
+
+            if (m_i >= m_size) {
+                for (Bucket& bucket : m_buckets) {
+                    bucket.i = bucket.lo + 1;
+                    bucket.j = bucket.i;
+                }
+                m_stage = 3;
+            }
+            update_regions();
+            return result;
+        }
+
+        // Every bucket is insertion sorted by its own worker, the workers taking turns
+        int b = -1;
+        for (int attempt = 0; attempt < STEPPED_BUCKETS; ++attempt) {
+            const int candidate = (m_next_bucket + attempt) % STEPPED_BUCKETS;
+            if (m_buckets[candidate].i < m_buckets[candidate].hi) {
+                b = candidate;
+                break;
+            }
+        }
+        if (b < 0) {
+            m_done = true;
+            result.done = true;
+            m_regions.clear();
+            return result;
+        }
+
+        m_next_bucket = (b + 1) % STEPPED_BUCKETS;
+        Bucket& bucket = m_buckets[b];
+        if (bucket.j <= bucket.lo) {
+            ++bucket.i;
+            bucket.j = bucket.i;
+            continue;
+        }
+
+        result.hi1 = bucket.j - 1;
+        result.hi2 = bucket.j;
+        result.compared = true;
+        count_compare(bucket.j - 1, bucket.j);
+        if (arr[bucket.j - 1] > arr[bucket.j]) {
+            std::swap(arr[bucket.j - 1], arr[bucket.j]);
+            count_swap(bucket.j - 1, bucket.j);
+            result.swapped = true;
+            result.write_count = 2;
+            --bucket.j;
+        } else {
+            ++bucket.i;
+            bucket.j = bucket.i;
+        }
+        update_regions();
+        return result;
+    }
+}
+
+const char* ParallelSampleSort::phase() const {
+    static const char* const PHASES[] = {"sample", "classify", "copy back", "sort buckets"};
+    return PHASES[m_stage];
+}
+
+void ParallelSampleSort::sort(std::vector<int>& arr) {
+    const int size = (int)arr.size();
+    m_aux_bytes = 0;
+    if (m_threads <= 1 || size < SEQUENTIAL_CUTOFF) {
+        std::sort(arr.begin(), arr.end());
+        return;
+    }
+
+    // Several splitter buckets per thread so one big bucket doesn't leave the others idle, each with its equality
+    // bucket next to it
+    int splitter_buckets = 1;
+    while (splitter_buckets < m_threads * BUCKETS_PER_THREAD && splitter_buckets < MAX_BUCKETS / 2) {
+        splitter_buckets *= 2;
+    }
+    const int buckets = 2 * splitter_buckets;
+    const int levels = splitter_tree_levels(splitter_buckets);
+    std::vector<int> splitters;
+    std::vector<int> tree;
+    pick_splitters(arr.data(), size, splitter_buckets, OVERSAMPLING, splitters, tree);
+
+    // Every worker classifies its slice and counts its share of each bucket
+    const int workers = m_threads;
+    std::vector<unsigned char> oracle(size);
+    std::vector<int> offsets((size_t)workers * buckets, 0);
+    run_workers(workers, [&](int worker) {
+        const int lo = (int)(((long long)size * worker) / workers);
+        const int hi = (int)(((long long)size * (worker + 1)) / workers);
+        int* counts = &offsets[(size_t)worker * buckets];
+        for (int i = lo; i < hi; ++i) {
+            const int b = classify_equal(tree.data(), splitters.data(), levels, arr[i]);
+            oracle[i] = (unsigned char)b;
+            ++counts[b];
+        }
+    });
+
+    // Bucket-major prefix sum, so each worker's run of a bucket follows the runs of the workers before it
+    std::vector<int> bucket_lo(buckets + 1);
+    int offset = 0;
+    for (int b = 0; b < buckets; ++b) {
+        bucket_lo[b] = offset;
+        for (int w = 0; w < workers; ++w) {
+            const int count = offsets[((size_t)w * buckets) + b];
+            offsets[((size_t)w * buckets) + b] = offset;
+            offset += count;
+        }
+    }
+    bucket_lo[buckets] = size;
+
+    std::vector<int> buffer(size);
+    run_workers(workers, [&](int worker) {
+        const int lo = (int)(((long long)size * worker) / workers);
+        const int hi = (int)(((long long)size * (worker + 1)) / workers);
+        int* next = &offsets[(size_t)worker * buckets];
+        for (int i = lo; i < hi; ++i) {
+            buffer[next[oracle[i]]++] = arr[i];
+        }
+    });
+
+    // Buckets are handed out one at a time, sorted in the buffer and copied back by the same worker. Equality buckets
+    // hold a single key and are only copied.
+    std::atomic<int> next_bucket(0);
+    run_workers(workers, [&](int worker) {
+        (void)worker;
+        for (int b = next_bucket.fetch_add(1); b < buckets; b = next_bucket.fetch_add(1)) {
+            if (b % 2 == 0) {
+                std::sort(buffer.begin() + bucket_lo[b], buffer.begin() + bucket_lo[b + 1]);
+            }
+            std::copy(buffer.begin() + bucket_lo[b], buffer.begin() + bucket_lo[b + 1], arr.begin() + bucket_lo[b]);
+        }
+    });
+
+    m_aux_bytes = (buffer.size() * sizeof(int)) + oracle.size() +
+        ((offsets.size() + bucket_lo.size() + tree.size() + splitters.size()) * sizeof(int));
+}
+
+/* SORTING NETWORK IMPLEMENTATION */
+void NetworkSort::reset(int size) {
+    m_size = size;
+    m_layers.clear();
+    m_layer = 0;
+    m_regions.clear();
+    m_done = (size <= 1);
+
+    if (!m_done) {
+        build_layers(size, m_layers);
+    }
+}
+
+SortStepResult NetworkSort::step(std::vector<int>& arr) {
+    SortStepResult result;
+
+    if (m_done || m_size <= 1 || (int)arr.size() < m_size || m_layer >= (int)m_layers.size()) {
+        result.done = true;
+        m_done = true;
+        m_regions.clear();
+        return result;
+    }
+
+    // The kernels don't count exchanges, so compare against a copy taken before the layer
+    const Layer& layer = m_layers[m_layer];
+    m_before.assign(arr.begin(), arr.begin() + m_size);
+    const int comparators = apply_layer(arr.data(), m_size, layer);
+    // Reads are counted for the whole array, which every bitonic layer goes through (odd-even layers skip a few)
+    int moved = 0;
+    for (int i = 0; i < m_size; ++i) {
+        if (comparators > 0) {
+            count_read(i);
+        }
+        if (arr[i] != m_before[i]) {
+            count_write(i);
+            ++moved;
+        }
+    }
+
+    result.compared = (comparators > 0);
+    result.compare_count = comparators;
+    result.swap_count = moved / 2;
+    result.swapped = (result.swap_count > 0);
+    result.write_count = moved;
+
+    // Alternate colors for the blocks the layer worked on
+    m_regions.clear();
+    for (int lo = 0; lo < m_size; lo += layer.block) {
+        m_regions.push_back({lo, std::min(lo + layer.block, m_size) - 1, (lo / layer.block) % 2});
+    }
+
+    ++m_layer;
+    if (m_layer >= (int)m_layers.size()) {
+        m_done = true;
+        result.done = true;
+    }
+    return result;
+}
+
+void NetworkSort::release_step_state() {
+    m_before.clear();
+    m_layers.clear();
+    m_regions.clear();
+}
+
+// The pre-layer copy only exists for counting swaps in the stepped form
+size_t NetworkSort::aux_memory_bytes() const {
+    return (m_before.size() * sizeof(int)) + (m_layers.size() * sizeof(Layer));
+}
+
+const std::vector<SortRegion>& NetworkSort::regions() const {
+    return m_regions;
+}
+
+/* BITONIC SORT IMPLEMENTATION */
+const char* BitonicSort::name() const {
+    return "Bitonic Sort (network)";
+}
+
+// a is the half size (mirror layer, b = 0) or the stride (half-cleaner layer, b = 1)
+void BitonicSort::build_layers(int size, std::vector<Layer>& layers) const {
+    for (int half = 1; half < size; half *= 2) {
+        layers.push_back({half, 0, 2 * half});
+        for (int stride = half / 2; stride >= 1; stride /= 2) {
+            layers.push_back({stride, 1, 2 * stride});
+        }
+    }
+}
+
+int BitonicSort::apply_layer(int* arr, int size, const Layer& layer) const {
+    if (layer.b == 0) {
+        return bitonic_mirror_layer(arr, size, layer.a);
+    }
+    return bitonic_half_cleaner_layer(arr, size, layer.a);
+}
+
+void BitonicSort::sort(std::vector<int>& arr) {
+    release_step_state();
+    bitonic_sort(arr.data(), (int)arr.size());
+}
+
+/* ODD-EVEN MERGE SORT IMPLEMENTATION */
+const char* OddEvenMergeSort::name() const {
+    return "Odd-Even Merge Sort (network)";
+}
+
+// a is the run size p being merged, b the comparator distance k
+void OddEvenMergeSort::build_layers(int size, std::vector<Layer>& layers) const {
+    for (int p = 1; p < size; p *= 2) {
+        for (int k = p; k >= 1; k /= 2) {
+            layers.push_back({p, k, 2 * p});
+        }
+    }
+}
+
+int OddEvenMergeSort::apply_layer(int* arr, int size, const Layer& layer) const {
+    return odd_even_merge_layer(arr, size, layer.a, layer.b);
+}
+
+void OddEvenMergeSort::sort(std::vector<int>& arr) {
+    release_step_state();
+    odd_even_merge_sort(arr.data(), (int)arr.size());
+}
+
+/* ALGORITHM LIST */
+std::vector<std::unique_ptr<SortingAlgo>> make_algorithms() {
+    std::vector<std::unique_ptr<SortingAlgo>> algorithms;
+    algorithms.emplace_back(std::make_unique<BubbleSort>());
+    algorithms.emplace_back(std::make_unique<SelectionSort>());
+    algorithms.emplace_back(std::make_unique<CycleSort>());
+    algorithms.emplace_back(std::make_unique<InsertionSort>());
+    algorithms.emplace_back(std::make_unique<CocktailSort>());
+    algorithms.emplace_back(std::make_unique<CombSort>());
+    algorithms.emplace_back(std::make_unique<ShellSort>());
+    algorithms.emplace_back(std::make_unique<ShellSort>(GapSequence::Tokuda));
+    algorithms.emplace_back(std::make_unique<ShellSort>(GapSequence::Pratt));
+    algorithms.emplace_back(std::make_unique<QuickSort>());
+    algorithms.emplace_back(std::make_unique<QuickSort>(LeafSort::Network, 16));
+    algorithms.emplace_back(std::make_unique<HeapSort>());
+    algorithms.emplace_back(std::make_unique<DaryHeapSort>(2, true));
+    algorithms.emplace_back(std::make_unique<DaryHeapSort>(4, true));
+    algorithms.emplace_back(std::make_unique<MergeSort>());
+    algorithms.emplace_back(std::make_unique<MergeSort>(LeafSort::Network, 16));
+    algorithms.emplace_back(std::make_unique<MergeSort>(LeafSort::Insertion, DEFAULT_LEAF_THRESHOLD, true));
+    algorithms.emplace_back(std::make_unique<InPlaceMergeSort>());
+    algorithms.emplace_back(std::make_unique<BlockMergeSort>());
+    algorithms.emplace_back(std::make_unique<CountingSort>());
+    algorithms.emplace_back(std::make_unique<CountingSort>(true));
+    algorithms.emplace_back(std::make_unique<ParallelMergeSort>());
+    algorithms.emplace_back(std::make_unique<ParallelQuickSort>());
+    algorithms.emplace_back(std::make_unique<ParallelSampleSort>());
+    algorithms.emplace_back(std::make_unique<BitonicSort>());
+    algorithms.emplace_back(std::make_unique<OddEvenMergeSort>());
+    return algorithms;
+}
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <atomic> // std::atomic
+#include <cstddef> // size_t
+#include <deque> // std::deque
+#include <memory> // std::unique_ptr
 #include <string> // std::string
 #include <vector> // std::vector
+#include "access_counters.h"
+#include "gap_sequence.h"
+#include "sort_kernels.h"
 
 // Simple class for returning the state of a single step of the sorting algorithm back to the caller
 struct SortStepResult {
@@ -10,6 +17,25 @@ struct SortStepResult {
     bool compared = false;
     bool swapped = false;
     bool done = false;
+    int compare_count = 0; // Steps that batch many operations (e.g. a whole network layer) report how many here
+    int swap_count = 0;
+    int write_count = 0; // Element writes into the array or a buffer (a swap is two, a move or a placement one)
+};
+
+// Inclusive range of the array a worker is currently busy with, so the caller can color each thread's work
+struct SortRegion {
+    int lo = 0;
+    int hi = -1;
+    int worker = 0;
+};
+
+// Runtime parameter of an algorithm, with the range and step the autotuner sweeps
+struct AlgoParam {
+    const char* name = "";
+    double value = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double step = 1.0;
 };
 
 // Base class for sorting algorithms. Each algorithm should inherit from this and implement the name(), reset() and step() methods.
@@ -22,14 +48,77 @@ public:
     virtual void reset(int size) = 0;
     virtual SortStepResult step(std::vector<int>& arr) = 0;
 
+    // Sorts the whole array in one go. The default drives step() until done, algorithms with a native kernel override it.
+    virtual void sort(std::vector<int>& arr);
+
+    // Regions owned by the (possibly simulated) workers after the last step, empty for sequential algorithms
+    virtual const std::vector<SortRegion>& regions() const;
+
+    // Tunable parameters (empty by default). set_param() returns false for unknown names and takes effect on the next reset().
+    virtual std::vector<AlgoParam> params() const;
+    virtual bool set_param(const char* name, double value);
+
+    // High-water mark in bytes of the buffers and explicit stacks used since the last reset() or sort(), 0 for O(1) state
+    virtual size_t aux_memory_bytes() const;
+
+    // What the algorithm is busy with as of the last step (e.g. building the heap or extracting), for tracing. One phase by default.
+    virtual const char* phase() const;
+
     bool is_done() const {
         return m_done;
     }
 
+    // From now on step() adds every element it reads or writes to counters, nullptr to stop. sort() isn't counted.
+    void set_access_counters(AccessCounters* counters) {
+        m_access = counters;
+    }
+
 protected:
+    // One branch when no counters are attached, so the steps can report every access
+    void count_read(int i) const {
+        if (m_access != nullptr) {
+            m_access->read(i);
+        }
+    }
+    void count_write(int i) const {
+        if (m_access != nullptr) {
+            m_access->write(i);
+        }
+    }
+    void count_compare(int i, int j) const {
+        count_read(i);
+        count_read(j);
+    }
+    // Writes of a swap, whose reads were counted by the compare before it
+    void count_swap(int i, int j) const {
+        count_write(i);
+        count_write(j);
+    }
+    void count_buffer_read(int i) const {
+        if (m_access != nullptr) {
+            m_access->buffer_read(i);
+        }
+    }
+    void count_buffer_write(int i) const {
+        if (m_access != nullptr) {
+            m_access->buffer_write(i);
+        }
+    }
+
     bool m_done = false;
+    AccessCounters* m_access = nullptr;
+};
+
+// Operation counts of a whole stepped run, tallied the way the GUI counts them
+struct SortRunTotals {
+    long long compares = 0;
+    long long swaps = 0;
+    long long writes = 0;
 };
 
+// Resets algo and steps it over arr until done
+SortRunTotals run_steps(SortingAlgo& algo, std::vector<int>& arr);
+
 // Class for Bubble Sort algorithm
 class BubbleSort : public SortingAlgo {
 public:
@@ -61,6 +150,24 @@ private:
     bool m_ready_to_swap = false;
 };
 
+// Class for Cycle Sort algorithm, which writes every element once, straight into its final position
+class CycleSort : public SortingAlgo {
+public:
+    const char* name() const override;
+
+    void reset(int size) override;
+    SortStepResult step(std::vector<int>& arr) override;
+    void sort(std::vector<int>& arr) override;
+
+private:
+    int m_size = 0;
+    int m_start = 0; // Where the current cycle began
+    int m_item = 0; // Element carried around the cycle
+    int m_pos = 0;
+    int m_i = 0;
+    int m_stage = 0; // 0: pick up the next item, 1: rank it, 2: skip equal keys, 3: write it
+    bool m_in_cycle = false;
+};
 
 // Class for Insertion Sort algorithm
 class InsertionSort : public SortingAlgo {
@@ -96,43 +203,81 @@ private:
 // Class for Comb Sort algorithm
 class CombSort : public SortingAlgo {
 public:
+    // The classic rule divides the gap by the shrink factor, any other sequence is walked down to 1
+    explicit CombSort(GapSequence sequence = GapSequence::Shrink);
+
     const char* name() const override;
 
     void reset(int size) override;
     SortStepResult step(std::vector<int>& arr) override;
+    void sort(std::vector<int>& arr) override;
+
+    std::vector<AlgoParam> params() const override;
+    bool set_param(const char* name, double value) override;
+
+    GapSequenceEngine& gap_engine() {
+        return m_gap_engine;
+    }
 
 private:
-    static int next_gap(int gap);
+    GapSequenceEngine m_gap_engine;
 
     int m_size = 0;
+    std::vector<int> m_gaps; // A copy, the engine drops its cached lists whenever a setting changes
+    int m_gap_idx = 0;
     int m_gap = 1;
     int m_i = 0;
     bool m_swapped_in_pass = false;
+    mutable std::string m_name;
 };
 
 // Class for Shell Sort algorithm
 class ShellSort : public SortingAlgo {
 public:
+    explicit ShellSort(GapSequence sequence = GapSequence::Ciura);
+
     const char* name() const override;
 
     void reset(int size) override;
     SortStepResult step(std::vector<int>& arr) override;
+    void sort(std::vector<int>& arr) override;
+
+    std::vector<AlgoParam> params() const override;
+    bool set_param(const char* name, double value) override;
+
+    GapSequenceEngine& gap_engine() {
+        return m_gap_engine;
+    }
 
 private:
+    GapSequenceEngine m_gap_engine;
+
     int m_size = 0;
-    std::vector<int> m_gaps;
+    std::vector<int> m_gaps; // A copy, the engine drops its cached lists whenever a setting changes
     int m_gap_idx = 0;
     int m_i = 0;
     int m_j = 0;
+    mutable std::string m_name;
 };
 
-// Class for Quick Sort algorithm
+// Class for Quick Sort algorithm (ranges up to the leaf threshold are finished by the leaf stage)
 class QuickSort : public SortingAlgo {
 public:
+    explicit QuickSort(LeafSort leaf = LeafSort::Insertion, int leaf_threshold = DEFAULT_LEAF_THRESHOLD);
+
     const char* name() const override;
 
     void reset(int size) override;
     SortStepResult step(std::vector<int>& arr) override;
+    const char* phase() const override;
+    void sort(std::vector<int>& arr) override;
+    size_t aux_memory_bytes() const override;
+
+    // Network leaves are capped at MAX_SMALL_NETWORK, takes effect on the next reset()
+    void set_leaf(LeafSort leaf, int leaf_threshold);
+
+    std::vector<AlgoParam> params() const override;
+    bool set_param(const char* name, double value) override;
 
 private:
     struct Range {
@@ -140,10 +285,12 @@ private:
         int hi = 0;
     };
 
-    static constexpr int INSERTION_SORT_THRESHOLD = 4;
+    LeafSort m_leaf = LeafSort::Insertion;
+    int m_leaf_threshold = DEFAULT_LEAF_THRESHOLD;
 
     int m_size = 0;
     std::vector<Range> m_stack;
+    size_t m_stack_peak = 0;
 
     bool m_has_active_partition = false;
     int m_lo = 0;
@@ -158,6 +305,10 @@ private:
     int m_ins_hi = 0;
     int m_ins_i = 0;
     int m_ins_j = 0;
+
+    const Comparator* m_net = nullptr; // Network leaf, one comparator per step
+    int m_net_count = 0;
+    int m_net_idx = 0;
 };
 
 // Class for Heap Sort algorithm
@@ -167,6 +318,8 @@ public:
 
     void reset(int size) override;
     SortStepResult step(std::vector<int>& arr) override;
+    const char* phase() const override;
+    void sort(std::vector<int>& arr) override;
 
 private:
     int m_size = 0;
@@ -184,16 +337,70 @@ private:
     int m_sift_stage = 0;
 };
 
-// Class for Merge Sort algorithm
+// Class for Heap Sort on a d-ary heap (2, 4 or 8 children per node, fewer levels and more children per cache line) with
+// an optional Floyd bottom-up sift. The stepped form moves the sifted value with swaps, the native one with a hole.
+class DaryHeapSort : public SortingAlgo {
+public:
+    explicit DaryHeapSort(int arity = 4, bool bottom_up = true); // Other arities round down to 2, 4 or 8
+
+    const char* name() const override;
+
+    void reset(int size) override;
+    SortStepResult step(std::vector<int>& arr) override;
+    const char* phase() const override;
+    void sort(std::vector<int>& arr) override;
+
+private:
+    bool finish_sift();
+
+    int m_arity = 4;
+    bool m_bottom_up = true;
+    std::string m_name;
+
+    int m_size = 0;
+    bool m_building_heap = true;
+    int m_build_index = 0;
+    int m_extract_end = 0;
+
+    bool m_sift_active = false;
+    int m_sift_root = 0;
+    int m_sift_end = 0; // Last index of the heap
+    int m_sift_stage = 0; // 0: next level, 1: scan the children, 2: value against the largest child, 3: climb back up
+    int m_hole = 0;
+    int m_last_child = 0;
+    int m_best = 0;
+    int m_child = 0;
+};
+
+// Class for Merge Sort algorithm (runs of the leaf threshold are sorted by the leaf stage before merging).
+// The ping-pong variant merges back and forth between the array and the buffer instead of copying every merge back.
+// Stable with insertion leaves only: network leaves don't keep equal keys in order, so that configuration is unstable.
 class MergeSort : public SortingAlgo {
 public:
+    explicit MergeSort(LeafSort leaf = LeafSort::Insertion, int leaf_threshold = DEFAULT_LEAF_THRESHOLD, bool ping_pong = false);
+
     const char* name() const override;
 
     void reset(int size) override;
     SortStepResult step(std::vector<int>& arr) override;
+    const char* phase() const override;
+    void sort(std::vector<int>& arr) override;
+    size_t aux_memory_bytes() const override;
+
+    // Network leaves are capped at MAX_SMALL_NETWORK, takes effect on the next reset()
+    void set_leaf(LeafSort leaf, int leaf_threshold);
+
+    std::vector<AlgoParam> params() const override;
+    bool set_param(const char* name, double value) override;
 
 private:
-    static constexpr int INSERTION_SORT_THRESHOLD = 4;
+    void start_run();
+    void count_source_read(int i) const;
+    void count_dest_write(int i) const;
+
+    LeafSort m_leaf = LeafSort::Insertion;
+    int m_leaf_threshold = DEFAULT_LEAF_THRESHOLD;
+    bool m_ping_pong = false;
 
     int m_size = 0;
     std::vector<int> m_buffer;
@@ -206,6 +413,9 @@ private:
     int m_run_hi = 0;
     int m_ins_i = 0;
     int m_ins_j = 0;
+    const Comparator* m_net = nullptr;
+    int m_net_count = 0;
+    int m_net_idx = 0;
 
     bool m_merge_active = false;
     bool m_copying_back = false;
@@ -215,4 +425,528 @@ private:
     int m_j = 0;
     int m_k = 0;
     int m_copy_idx = 0;
-};
\ No newline at end of file
+    bool m_in_buffer = false; // Ping-pong: the current pass merges from the buffer into the array
+    bool m_final_copy = false;
+};
+
+// Class for in-place stable Merge Sort on rotations, the baseline of BlockMergeSort: the same bottom-up passes, but
+// every merge is a SymMerge (binary search for the split, one rotation done as three reversals, then the two halves
+// as independent merges on a stack). No buffer is allocated, but it keeps an O(log n) stack of pending merges and
+// moves O(n log^2 n) elements.
+class InPlaceMergeSort : public SortingAlgo {
+public:
+    const char* name() const override;
+
+    void reset(int size) override;
+    SortStepResult step(std::vector<int>& arr) override;
+    const char* phase() const override;
+    void sort(std::vector<int>& arr) override;
+    size_t aux_memory_bytes() const override;
+
+private:
+    void push_merge(int lo, int mid, int hi);
+    void begin_merge(const MergeFrame& frame);
+    void end_merge();
+
+    int m_size = 0;
+    int m_width = 1;
+    int m_left = 0;
+
+    bool m_in_insertion = false;
+    int m_run_lo = 0;
+    int m_run_hi = 0;
+    int m_ins_i = 0;
+    int m_ins_j = 0;
+
+    std::vector<MergeFrame> m_stack;
+    size_t m_stack_peak = 0;
+
+    int m_stage = 0; // 0: next merge, 1: binary search for the split, 2: rotation
+    MergeFrame m_frame;
+    int m_half = 0;
+    int m_search_lo = 0;
+    int m_search_hi = 0;
+    int m_search_n = 0;
+    int m_end = 0;
+    int m_rev_stage = 0;
+    int m_rev_lo = 0;
+    int m_rev_hi = 0;
+};
+
+// Histogram buckets counting sort allows for n keys: COUNTING_RANGE_PER_KEY per key, at least COUNTING_MIN_RANGE
+static constexpr long long COUNTING_RANGE_PER_KEY = 16;
+static constexpr long long COUNTING_MIN_RANGE = 1 << 16;
+
+// Whether a key range (max - min + 1) is small enough to count n keys, wider ones fall back to a comparison sort
+bool counting_range_fits(long long key_range, int size);
+
+// Class for block merge sort with an internal buffer (GrailSort, see block_merge_sort()): stable and in place with
+// O(1) extra memory and O(n log n) compares and moves. Inputs with too few distinct keys for the buffer and the
+// block tags are sorted by SymMerge (InPlaceMergeSort) instead.
+class BlockMergeSort : public SortingAlgo {
+public:
+    const char* name() const override;
+
+    void reset(int size) override;
+    SortStepResult step(std::vector<int>& arr) override;
+    const char* phase() const override;
+    void sort(std::vector<int>& arr) override;
+    size_t aux_memory_bytes() const override;
+
+private:
+    // The kernel's routines, resumed one compare or swap per step. None is recursive, so each keeps a single state
+    // and the calls fit a small fixed stack.
+    enum class Routine {
+        SwapN,
+        Rotate,
+        Search,
+        Insertion,
+        MergeLeft,
+        MergeRight,
+        Smart,
+        BuffersLeft,
+        Combine,
+        Build,
+        FindKeys,
+        WithoutBuffer,
+    };
+
+    static constexpr int MAX_CALL_DEPTH = 8;
+
+    struct SwapNState {
+        int a = 0;
+        int b = 0;
+        int count = 0;
+        int i = 0;
+    };
+
+    struct RotateState {
+        int lo = 0;
+        int left = 0;
+        int right = 0;
+    };
+
+    struct SearchState {
+        int lo = 0;
+        int low = 0;
+        int high = 0;
+        int key = 0;
+        bool right = false; // First element greater than the key instead of the first not less
+    };
+
+    struct InsertionState {
+        int lo = 0;
+        int end = 0;
+        int i = 0;
+        int j = 0;
+    };
+
+    struct MergeState {
+        int out = 0;
+        int i = 0;
+        int left_end = 0;
+        int j = 0;
+        int end = 0;
+        int stage = 0; // Right merges: 0 merging, 1 moving the rest of the right run
+    };
+
+    struct SmartState {
+        int out = 0;
+        int a = 0;
+        int a_end = 0;
+        int b = 0;
+        int b_end = 0;
+        bool left_fragment = false;
+        int stage = 0; // 0: merging, 1: moving the rest of the fragment behind the block
+    };
+
+    struct BuffersState {
+        int mid_key = 0;
+        int lo = 0;
+        int blocks = 0;
+        int block_size = 0;
+        int trailing = 0;
+        int last = 0;
+        int rest = 0;
+        int origin = 0;
+        int pos = 0;
+        int b = 0;
+        int start = 0;
+        int pc = 0;
+    };
+
+    struct CombineState {
+        int lo = 0;
+        int size = 0;
+        int run = 0;
+        int block_size = 0;
+        int pairs = 0;
+        int leftover = 0;
+        int p = 0;
+        int pair = 0;
+        int blocks = 0;
+        int mid = 0;
+        int u = 0;
+        int v = 0;
+        int min = 0;
+        int trailing = 0;
+        int last = 0;
+        int i = 0;
+        int pc = 0;
+    };
+
+    struct BuildState {
+        int lo = 0;
+        int size = 0;
+        int buffer = 0;
+        int m = 0;
+        int u = 0;
+        int cur = 0;
+        int h = 0;
+        int p = 0;
+        int pc = 0;
+    };
+
+    struct FindKeysState {
+        int size = 0;
+        int wanted = 0;
+        int found = 0;
+        int first = 0;
+        int i = 0;
+        int r = 0;
+        bool is_new = false;
+        int pc = 0;
+    };
+
+    struct WithoutBufferState {
+        int lo = 0;
+        int left = 0;
+        int right = 0;
+        int pc = 0;
+    };
+
+    void call(Routine routine);
+    void call_swap_n(int a, int b, int count);
+    void call_rotate(int lo, int left, int right);
+    void call_search(int lo, int size, int key, bool right);
+    void call_insertion(int lo, int size);
+    void call_merge_left(int lo, int left, int right, int offset);
+    void call_merge_right(int lo, int left, int right, int buffer);
+    void call_smart(int lo, int block_size);
+    void call_buffers_left(int mid_key, int lo, int blocks, int block_size, int trailing, int last);
+    void call_combine(int lo, int size, int run, int block_size);
+    void call_build(int lo, int size, int buffer);
+    void call_find_keys(int size, int wanted);
+    void call_without_buffer(int lo, int left, int right);
+
+    void compare_step(int i, int j, SortStepResult& result) const;
+    void swap_step(std::vector<int>& arr, int i, int j, SortStepResult& result) const;
+
+    // Each performs one compare or swap and returns true, or returns false after calling, returning or moving on
+    bool step_swap_n(std::vector<int>& arr, SortStepResult& result);
+    bool step_rotate();
+    bool step_search(const std::vector<int>& arr, SortStepResult& result);
+    bool step_insertion(std::vector<int>& arr, SortStepResult& result);
+    bool step_merge_left(std::vector<int>& arr, SortStepResult& result);
+    bool step_merge_right(std::vector<int>& arr, SortStepResult& result);
+    bool step_smart(std::vector<int>& arr, SortStepResult& result);
+    bool step_buffers_left(const std::vector<int>& arr, SortStepResult& result);
+    bool step_combine(std::vector<int>& arr, SortStepResult& result);
+    bool step_build(std::vector<int>& arr, SortStepResult& result);
+    bool step_find_keys(const std::vector<int>& arr, SortStepResult& result);
+    bool step_without_buffer(const std::vector<int>& arr, SortStepResult& result);
+
+    int m_size = 0;
+    int m_stage = 0; // 0: collect keys, 1: build runs, 2: block merges, 3: merge the keys back, 4: done, 5: fallback
+    int m_block = 0;
+    int m_wanted = 0;
+    int m_run = 0;
+    InPlaceMergeSort m_fallback;
+
+    Routine m_calls[MAX_CALL_DEPTH] = {};
+    int m_depth = 0;
+    int m_search_result = 0;
+
+    SwapNState m_swap_n;
+    RotateState m_rotate;
+    SearchState m_search;
+    InsertionState m_insertion;
+    MergeState m_merge;
+    SmartState m_smart;
+    BuffersState m_buffers;
+    CombineState m_combine;
+    BuildState m_build;
+    FindKeysState m_find_keys;
+    WithoutBufferState m_without_buffer;
+};
+
+// Class for Counting Sort algorithm (the stable variant scatters into a buffer instead of rewriting the keys).
+// Key ranges over counting_range_fits() are sorted by Heap Sort (stable: Merge Sort) instead, after the range scan.
+class CountingSort : public SortingAlgo {
+public:
+    explicit CountingSort(bool stable = false);
+
+    const char* name() const override;
+
+    void reset(int size) override;
+    SortStepResult step(std::vector<int>& arr) override;
+    const char* phase() const override;
+    void sort(std::vector<int>& arr) override;
+    size_t aux_memory_bytes() const override;
+
+private:
+    bool m_stable = false;
+    int m_size = 0;
+    std::vector<int> m_counts;
+    std::vector<int> m_buffer;
+    std::unique_ptr<SortingAlgo> m_fallback;
+    bool m_use_fallback = false;
+
+    int m_stage = 0; // 0: range scan, 1: counting, 2: write back (stable: scatter), 3: stable copy back, 4: fallback
+    int m_i = 0;
+    int m_min = 0;
+    int m_max = 0;
+    int m_bucket = 0;
+};
+
+// Stable counting sort of keys carrying a payload along (values[i] belongs to keys[i]), O(n + k) for a key range k.
+// Ranges over counting_range_fits() are sorted by std::stable_sort on the pairs instead.
+void counting_sort_stable(std::vector<int>& keys, std::vector<int>& values);
+
+// Class for Parallel Merge Sort algorithm. Each merge level splits its output evenly between the workers and
+// co-ranks (merge path) the inputs, so even the final merges run in parallel. step() simulates STEPPED_WORKERS
+// workers round-robin, sort() runs the leaf chunks and the merge levels on real threads.
+class ParallelMergeSort : public SortingAlgo {
+public:
+    explicit ParallelMergeSort(int threads = 0); // 0 uses the hardware concurrency
+
+    const char* name() const override;
+
+    void reset(int size) override;
+    SortStepResult step(std::vector<int>& arr) override;
+    const char* phase() const override;
+    void sort(std::vector<int>& arr) override;
+    const std::vector<SortRegion>& regions() const override;
+    size_t aux_memory_bytes() const override;
+
+    void set_threads(int threads);
+    int threads() const {
+        return m_threads;
+    }
+
+private:
+    // Part of one merge pair that a worker produces: src[a_lo, a_hi) and src[b_lo, b_hi) merge into dst[out, ...)
+    struct MergeSegment {
+        int a_lo = 0;
+        int a_hi = 0;
+        int b_lo = 0;
+        int b_hi = 0;
+        int out = 0;
+    };
+
+    struct Worker {
+        int out_lo = 0;
+        int out_hi = 0;
+        int pair = 0;
+        int k = 0;
+        MergeSegment seg;
+        bool busy = false;
+    };
+
+    static constexpr int STEPPED_WORKERS = 4;
+    static constexpr int MIN_CHUNK_SIZE = 4096;
+
+    static int co_rank(int k, const int* a, int a_size, const int* b, int b_size);
+    static MergeSegment level_segment(const int* src, const std::vector<int>& runs, int pair, int out_lo, int out_hi);
+    static void merge_slice(const int* src, int* dst, const std::vector<int>& runs, int out_lo, int out_hi);
+    static void halve_runs(std::vector<int>& runs);
+
+    void start_level();
+    void update_regions();
+
+    int m_threads = 1;
+    int m_size = 0;
+    std::vector<int> m_buffer;
+    std::vector<int> m_runs;
+    Worker m_workers[STEPPED_WORKERS];
+    int m_next_worker = 0;
+    bool m_copying_back = false;
+    std::vector<SortRegion> m_regions;
+    size_t m_aux_bytes = 0;
+};
+
+// Class for Parallel Quick Sort algorithm on a work-stealing scheduler. Every worker owns a deque of pending ranges,
+// works LIFO at its back and steals the oldest (largest) ranges from the front of the other deques when it runs dry.
+// Ranges below a cutoff are sorted sequentially by their owner. Fork/join (static split) is kept as a baseline.
+class ParallelQuickSort : public SortingAlgo {
+public:
+    explicit ParallelQuickSort(int threads = 0, bool work_stealing = true); // 0 threads uses the hardware concurrency
+
+    const char* name() const override;
+
+    void reset(int size) override;
+    SortStepResult step(std::vector<int>& arr) override;
+    void sort(std::vector<int>& arr) override;
+    const std::vector<SortRegion>& regions() const override;
+
+    void set_threads(int threads);
+    int threads() const {
+        return m_threads;
+    }
+
+private:
+    struct Range {
+        int lo = 0;
+        int hi = 0;
+    };
+
+    struct WorkDeque;
+
+    struct Worker {
+        std::deque<Range> deque; // Stealable ranges
+        std::vector<Range> local; // Ranges under the cutoff, sorted sequentially by this worker
+
+        bool partitioning = false;
+        int lo = 0;
+        int hi = 0;
+        int lt = 0;
+        int i = 0;
+        int gt = 0;
+        int pivot = 0;
+
+        bool inserting = false;
+        int ins_lo = 0;
+        int ins_hi = 0;
+        int ins_i = 0;
+        int ins_j = 0;
+    };
+
+    static constexpr int INSERTION_SORT_THRESHOLD = 4;
+    static constexpr int STEPPED_WORKERS = 4;
+    static constexpr int STEPPED_SEQUENTIAL_CUTOFF = 32;
+    static constexpr int SEQUENTIAL_CUTOFF = 8192;
+
+    static void partition(int* arr, int lo, int hi, int& lt, int& gt);
+    static void sort_sequential(int* arr, int lo, int hi);
+    static void sort_fork_join(int* arr, int lo, int hi, int threads);
+    static void run_stealing_worker(int worker, int* arr, std::vector<WorkDeque>& deques, std::atomic<int>& pending);
+
+    bool take_work(int w, const std::vector<int>& arr);
+    void update_regions();
+
+    int m_threads = 1;
+    bool m_work_stealing = true;
+    int m_size = 0;
+    Worker m_workers[STEPPED_WORKERS];
+    int m_next_worker = 0;
+    std::vector<SortRegion> m_regions;
+};
+
+// Class for Parallel Sample Sort algorithm. A random oversample picks k - 1 splitters (k = BUCKETS_PER_THREAD times
+// the thread count, rounded up to a power of two), every thread classifies its slice of the input with a branchless
+// walk down the implicit splitter tree and scatters it into per-thread runs of the buckets, then the buckets are
+// sorted in parallel. Keys equal to a splitter go to an equality bucket that needs no sorting, so repeated keys don't
+// pile into one bucket sorted by one thread. step() shows the classification one element at a time and
+// STEPPED_BUCKETS workers insertion sorting their buckets round-robin.
+class ParallelSampleSort : public SortingAlgo {
+public:
+    explicit ParallelSampleSort(int threads = 0); // 0 uses the hardware concurrency
+
+    const char* name() const override;
+
+    void reset(int size) override;
+    SortStepResult step(std::vector<int>& arr) override;
+    const char* phase() const override;
+    void sort(std::vector<int>& arr) override;
+    const std::vector<SortRegion>& regions() const override;
+    size_t aux_memory_bytes() const override;
+
+    void set_threads(int threads);
+    int threads() const {
+        return m_threads;
+    }
+
+private:
+    struct Bucket {
+        int lo = 0;
+        int hi = 0; // Exclusive
+        int i = 0; // Insertion sort position
+        int j = 0;
+    };
+
+    static constexpr int OVERSAMPLING = 32; // Sample elements per bucket
+    static constexpr int MAX_BUCKETS = 256; // Bucket indexes are stored in a byte per element, equality buckets included
+    static constexpr int BUCKETS_PER_THREAD = 8;
+    static constexpr int STEPPED_BUCKETS = 4;
+    static constexpr int SEQUENTIAL_CUTOFF = 1 << 14;
+
+    void update_regions();
+
+    int m_threads = 1;
+    int m_size = 0;
+    int m_stage = 0; // 0: sample, 1: classify, 2: copy the buckets back, 3: sort the buckets
+    int m_i = 0;
+    std::vector<int> m_tree; // Splitters in implicit tree order, the root at index 1
+    std::vector<unsigned char> m_oracle; // Bucket of every element
+    std::vector<int> m_buffer;
+    Bucket m_buckets[STEPPED_BUCKETS];
+    int m_next_bucket = 0;
+    std::vector<SortRegion> m_regions;
+    size_t m_aux_bytes = 0;
+};
+
+// Base class for sorting networks: every step applies one whole comparator layer with the vectorized kernels
+class NetworkSort : public SortingAlgo {
+public:
+    void reset(int size) override;
+    SortStepResult step(std::vector<int>& arr) override;
+    const std::vector<SortRegion>& regions() const override;
+    size_t aux_memory_bytes() const override;
+
+protected:
+    // One comparator layer: a and b are the network's own parameters, block is the size of the blocks it works on
+    struct Layer {
+        int a = 0;
+        int b = 0;
+        int block = 0;
+    };
+
+    virtual void build_layers(int size, std::vector<Layer>& layers) const = 0;
+    virtual int apply_layer(int* arr, int size, const Layer& layer) const = 0;
+
+    // Drops the stepped state, for the native sort() overrides
+    void release_step_state();
+
+private:
+    int m_size = 0;
+    std::vector<Layer> m_layers;
+    int m_layer = 0;
+    std::vector<int> m_before;
+    std::vector<SortRegion> m_regions;
+};
+
+// Class for Bitonic Sort (all-ascending form, truncated to non power of two sizes)
+class BitonicSort : public NetworkSort {
+public:
+    const char* name() const override;
+    void sort(std::vector<int>& arr) override;
+
+protected:
+    void build_layers(int size, std::vector<Layer>& layers) const override;
+    int apply_layer(int* arr, int size, const Layer& layer) const override;
+};
+
+// Class for Batcher's Odd-Even Merge Sort (truncated to non power of two sizes)
+class OddEvenMergeSort : public NetworkSort {
+public:
+    const char* name() const override;
+    void sort(std::vector<int>& arr) override;
+
+protected:
+    void build_layers(int size, std::vector<Layer>& layers) const override;
+    int apply_layer(int* arr, int size, const Layer& layer) const override;
+};
+
+// Every algorithm and variant in the GUI's menu order, also what the exporter offers and the bench's stepped runs cover.
+// New variants go here so no front end misses them.
+std::vector<std::unique_ptr<SortingAlgo>> make_algorithms();
@@ -0,0 +1,324 @@
+#include <algorithm> // std::min(), std::max()
+#include "sorting_network.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VSORT_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void compare_exchange_scalar(int* lo, int* hi, int count) {
+    for (int i = 0; i < count; ++i) {
+        const int a = lo[i];
+        const int b = hi[i];
+        lo[i] = std::min(a, b);
+        hi[i] = std::max(a, b);
+    }
+}
+
+void compare_exchange_mirrored_scalar(int* lo, int* hi_last, int count) {
+    for (int i = 0; i < count; ++i) {
+        const int a = lo[i];
+        const int b = hi_last[-i];
+        lo[i] = std::min(a, b);
+        hi_last[-i] = std::max(a, b);
+    }
+}
+
+// In-block layer for small blocks: x meets x ^ partner_xor, and the lane with the low_bit set keeps the maximum
+void xor_layer_scalar(int* arr, int size, int partner_xor, int low_bit) {
+    for (int x = 0; x < size; ++x) {
+        const int y = x ^ partner_xor;
+        if ((x & low_bit) == 0 && y < size) {
+            const int a = arr[x];
+            const int b = arr[y];
+            arr[x] = std::min(a, b);
+            arr[y] = std::max(a, b);
+        }
+    }
+}
+
+#ifdef VSORT_X86_SIMD
+__attribute__((target("sse4.1"))) void compare_exchange_sse41(int* lo, int* hi, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(lo + i));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(hi + i));
+        _mm_storeu_si128((__m128i*)(lo + i), _mm_min_epi32(a, b));
+        _mm_storeu_si128((__m128i*)(hi + i), _mm_max_epi32(a, b));
+    }
+    compare_exchange_scalar(lo + i, hi + i, count - i);
+}
+
+// The mirrored lanes are loaded as one vector and reversed in the register
+__attribute__((target("sse4.1"))) void compare_exchange_mirrored_sse41(int* lo, int* hi_last, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        int* hi = hi_last - i - 3;
+        const __m128i a = _mm_loadu_si128((const __m128i*)(lo + i));
+        const __m128i b = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)hi), _MM_SHUFFLE(0, 1, 2, 3));
+        _mm_storeu_si128((__m128i*)(lo + i), _mm_min_epi32(a, b));
+        _mm_storeu_si128((__m128i*)hi, _mm_shuffle_epi32(_mm_max_epi32(a, b), _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+    compare_exchange_mirrored_scalar(lo + i, hi_last - i, count - i);
+}
+
+// Blocks up to 4 elements live in one register: shuffle the partners in, then blend the min and max lanes
+__attribute__((target("sse4.1"))) void xor_layer_sse41(int* arr, int size, int partner_xor, int low_bit) {
+    alignas(16) unsigned char partner_bytes[16];
+    alignas(16) int max_lanes[4];
+    for (int lane = 0; lane < 4; ++lane) {
+        for (int byte = 0; byte < 4; ++byte) {
+            partner_bytes[(lane * 4) + byte] = (unsigned char)(((lane ^ partner_xor) * 4) + byte);
+        }
+        max_lanes[lane] = (lane & low_bit) ? -1 : 0;
+    }
+    const __m128i partner = _mm_load_si128((const __m128i*)partner_bytes);
+    const __m128i take_max = _mm_load_si128((const __m128i*)max_lanes);
+
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(arr + i));
+        const __m128i p = _mm_shuffle_epi8(v, partner);
+        _mm_storeu_si128((__m128i*)(arr + i), _mm_blendv_epi8(_mm_min_epi32(v, p), _mm_max_epi32(v, p), take_max));
+    }
+    xor_layer_scalar(arr + i, size - i, partner_xor, low_bit);
+}
+
+__attribute__((target("avx2"))) void compare_exchange_avx2(int* lo, int* hi, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(lo + i));
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(hi + i));
+        _mm256_storeu_si256((__m256i*)(lo + i), _mm256_min_epi32(a, b));
+        _mm256_storeu_si256((__m256i*)(hi + i), _mm256_max_epi32(a, b));
+    }
+    compare_exchange_scalar(lo + i, hi + i, count - i);
+}
+
+__attribute__((target("avx2"))) void compare_exchange_mirrored_avx2(int* lo, int* hi_last, int count) {
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int* hi = hi_last - i - 7;
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(lo + i));
+        const __m256i b = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)hi), reverse);
+        _mm256_storeu_si256((__m256i*)(lo + i), _mm256_min_epi32(a, b));
+        _mm256_storeu_si256((__m256i*)hi, _mm256_permutevar8x32_epi32(_mm256_max_epi32(a, b), reverse));
+    }
+    compare_exchange_mirrored_scalar(lo + i, hi_last - i, count - i);
+}
+
+__attribute__((target("avx2"))) void xor_layer_avx2(int* arr, int size, int partner_xor, int low_bit) {
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i partner = _mm256_xor_si256(lane, _mm256_set1_epi32(partner_xor));
+    const __m256i low = _mm256_set1_epi32(low_bit);
+    const __m256i take_max = _mm256_cmpeq_epi32(_mm256_and_si256(lane, low), low);
+
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(arr + i));
+        const __m256i p = _mm256_permutevar8x32_epi32(v, partner);
+        _mm256_storeu_si256((__m256i*)(arr + i), _mm256_blendv_epi8(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), take_max));
+    }
+    xor_layer_scalar(arr + i, size - i, partner_xor, low_bit);
+}
+#endif
+
+SimdLevel detect_simd_level() {
+#ifdef VSORT_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return SimdLevel::SSE41;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+const SimdLevel g_max_simd_level = detect_simd_level();
+SimdLevel g_simd_level = g_max_simd_level;
+
+// Layers whose blocks fit in this many elements (128 KiB) are run chunk by chunk while the chunk is still in cache
+const int CACHE_CHUNK = 1 << 15;
+
+// Blocks below the register width are handled in-register instead of as tiny runs (and in one pass when scalar)
+int register_lanes() {
+    return (g_simd_level == SimdLevel::SSE41) ? 4 : 8;
+}
+
+void xor_layer(int* arr, int size, int partner_xor, int low_bit) {
+#ifdef VSORT_X86_SIMD
+    if (g_simd_level == SimdLevel::AVX2) {
+        xor_layer_avx2(arr, size, partner_xor, low_bit);
+        return;
+    }
+    if (g_simd_level == SimdLevel::SSE41) {
+        xor_layer_sse41(arr, size, partner_xor, low_bit);
+        return;
+    }
+#endif
+    xor_layer_scalar(arr, size, partner_xor, low_bit);
+}
+
+// Comparators in a layer of blocks of 2 * half truncated to size (same count for the mirror and half-cleaner layers)
+int block_layer_comparators(int size, int half) {
+    const int rest = size % (2 * half);
+    return ((size / (2 * half)) * half) + std::max(0, rest - half);
+}
+
+// All bitonic stages whose blocks fit in `size`, then nothing else: used on cache-sized chunks
+void bitonic_stages(int* arr, int size, int max_half) {
+    for (int half = 1; half < size && half <= max_half; half *= 2) {
+        bitonic_mirror_layer(arr, size, half);
+        for (int stride = half / 2; stride >= 1; stride /= 2) {
+            bitonic_half_cleaner_layer(arr, size, stride);
+        }
+    }
+}
+
+} // namespace
+
+SimdLevel network_simd_level() {
+    return g_simd_level;
+}
+
+SimdLevel network_max_simd_level() {
+    return g_max_simd_level;
+}
+
+void set_network_simd_level(SimdLevel level) {
+    g_simd_level = ((int)level > (int)g_max_simd_level) ? g_max_simd_level : level;
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::SSE41:
+        return "SSE4.1";
+    default:
+        return "scalar";
+    }
+}
+
+void network_compare_exchange(int* lo, int* hi, int count) {
+#ifdef VSORT_X86_SIMD
+    if (g_simd_level == SimdLevel::AVX2) {
+        compare_exchange_avx2(lo, hi, count);
+        return;
+    }
+    if (g_simd_level == SimdLevel::SSE41) {
+        compare_exchange_sse41(lo, hi, count);
+        return;
+    }
+#endif
+    compare_exchange_scalar(lo, hi, count);
+}
+
+void network_compare_exchange_mirrored(int* lo, int* hi_last, int count) {
+#ifdef VSORT_X86_SIMD
+    if (g_simd_level == SimdLevel::AVX2) {
+        compare_exchange_mirrored_avx2(lo, hi_last, count);
+        return;
+    }
+    if (g_simd_level == SimdLevel::SSE41) {
+        compare_exchange_mirrored_sse41(lo, hi_last, count);
+        return;
+    }
+#endif
+    compare_exchange_mirrored_scalar(lo, hi_last, count);
+}
+
+// Block [b, b + 2 * half): b + t against b + 2 * half - 1 - t, only the partners that exist
+int bitonic_mirror_layer(int* arr, int size, int half) {
+    if (half < register_lanes()) {
+        xor_layer(arr, size, (2 * half) - 1, half);
+        return block_layer_comparators(size, half);
+    }
+
+    for (int block = 0; block < size; block += 2 * half) {
+        const int first = std::max(0, block + (2 * half) - size);
+        const int count = half - first;
+        if (count > 0) {
+            network_compare_exchange_mirrored(arr + block + first, arr + block + (2 * half) - 1 - first, count);
+        }
+    }
+    return block_layer_comparators(size, half);
+}
+
+int bitonic_half_cleaner_layer(int* arr, int size, int stride) {
+    if (stride < register_lanes()) {
+        xor_layer(arr, size, stride, stride);
+        return block_layer_comparators(size, stride);
+    }
+
+    for (int block = 0; block < size; block += 2 * stride) {
+        const int count = std::min(stride, size - block - stride);
+        if (count > 0) {
+            network_compare_exchange(arr + block, arr + block + stride, count);
+        }
+    }
+    return block_layer_comparators(size, stride);
+}
+
+// Comparators (j + i, j + i + k) only stay inside one merge of size 2 * p. Since j is a multiple of k and 2 * p a
+// multiple of 2 * k, that holds for the whole run of k comparators or for none of them.
+int odd_even_merge_layer(int* arr, int size, int p, int k) {
+    int comparators = 0;
+    for (int j = k % p; j + k < size; j += 2 * k) {
+        if (j / (2 * p) != (j + k) / (2 * p)) {
+            continue;
+        }
+        const int count = std::min(k, size - j - k);
+        if (k < register_lanes()) { // Too short for a vector run
+            compare_exchange_scalar(arr + j, arr + j + k, count);
+        } else {
+            network_compare_exchange(arr + j, arr + j + k, count);
+        }
+        comparators += count;
+    }
+    return comparators;
+}
+
+// Same layers in the same order per element, but every run of layers that stays inside cache-sized chunks is
+// finished chunk by chunk instead of streaming the whole array once per layer
+void bitonic_sort(int* arr, int size) {
+    for (int chunk = 0; chunk < size; chunk += CACHE_CHUNK) {
+        bitonic_stages(arr + chunk, std::min(CACHE_CHUNK, size - chunk), CACHE_CHUNK / 2);
+    }
+
+    for (int half = CACHE_CHUNK; half < size; half *= 2) {
+        bitonic_mirror_layer(arr, size, half);
+        int stride = half / 2;
+        for (; stride >= CACHE_CHUNK; stride /= 2) {
+            bitonic_half_cleaner_layer(arr, size, stride);
+        }
+        for (int chunk = 0; chunk < size; chunk += CACHE_CHUNK) {
+            for (int chunk_stride = stride; chunk_stride >= 1; chunk_stride /= 2) {
+                bitonic_half_cleaner_layer(arr + chunk, std::min(CACHE_CHUNK, size - chunk), chunk_stride);
+            }
+        }
+    }
+}
+
+// Only the merges of runs that fit a chunk stay inside it, the inner layers of bigger merges cross chunk boundaries
+void odd_even_merge_sort(int* arr, int size) {
+    for (int chunk = 0; chunk < size; chunk += CACHE_CHUNK) {
+        const int chunk_size = std::min(CACHE_CHUNK, size - chunk);
+        for (int p = 1; p < chunk_size; p *= 2) {
+            for (int k = p; k >= 1; k /= 2) {
+                odd_even_merge_layer(arr + chunk, chunk_size, p, k);
+            }
+        }
+    }
+
+    for (int p = CACHE_CHUNK; p < size; p *= 2) {
+        for (int k = p; k >= 1; k /= 2) {
+            odd_even_merge_layer(arr, size, p, k);
+        }
+    }
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array> // std::array
+#include <cstddef> // std::size_t
+#include <utility> // std::index_sequence
+
+// Instruction sets the sorting network kernels can run on
+enum class SimdLevel {
+    Scalar,
+    SSE41,
+    AVX2,
+};
+
+// The kernels use the best level this CPU supports unless told otherwise (the request is clamped to that maximum)
+SimdLevel network_simd_level();
+SimdLevel network_max_simd_level();
+void set_network_simd_level(SimdLevel level);
+const char* simd_level_name(SimdLevel level);
+
+// A run of comparators, one per lane: lo[i] gets min(lo[i], hi[i]) and hi[i] gets the max
+void network_compare_exchange(int* lo, int* hi, int count);
+// Same, but lo[i] is paired with hi_last[-i] (the mirrored half of a bitonic merge)
+void network_compare_exchange_mirrored(int* lo, int* hi_last, int count);
+
+// Single comparator layers, truncated to size. Every comparator puts the minimum at the lower index, so dropping the
+// ones that reach past the end is the same as padding with +infinity. Each returns the number of comparators applied.
+int bitonic_mirror_layer(int* arr, int size, int half); // Blocks of 2 * half, element i against its mirror
+int bitonic_half_cleaner_layer(int* arr, int size, int stride); // Blocks of 2 * stride, element i against i + stride
+int odd_even_merge_layer(int* arr, int size, int p, int k); // Batcher's layer k of the merges of runs of size p
+
+// Whole networks, one layer after the other
+void bitonic_sort(int* arr, int size);
+void odd_even_merge_sort(int* arr, int size);
+
+// Largest size with a compile-time network
+static constexpr int MAX_SMALL_NETWORK = 32;
+
+struct Comparator {
+    int lo = 0;
+    int hi = 0;
+};
+
+namespace network_detail {
+
+// Batcher's odd-even merge network truncated to size, generated at compile time. Its comparator counts are the
+// optimal ones up to 8 inputs (19 for 8) and close at 16 (63 vs 60), the truncation costs more above 16 (85 vs 71 for 17).
+constexpr int odd_even_comparator_count(int size) {
+    int count = 0;
+    for (int p = 1; p < size; p *= 2) {
+        for (int k = p; k >= 1; k /= 2) {
+            for (int j = k % p; j + k < size; j += 2 * k) {
+                for (int i = 0; i < k && i + j + k < size; ++i) {
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                        ++count;
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+template <int N>
+constexpr std::array<Comparator, odd_even_comparator_count(N)> make_odd_even_network() {
+    std::array<Comparator, odd_even_comparator_count(N)> comparators = {};
+    int count = 0;
+    for (int p = 1; p < N; p *= 2) {
+        for (int k = p; k >= 1; k /= 2) {
+            for (int j = k % p; j + k < N; j += 2 * k) {
+                for (int i = 0; i < k && i + j + k < N; ++i) {
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                        comparators[count].lo = i + j;
+                        comparators[count].hi = i + j + k;
+                        ++count;
+                    }
+                }
+            }
+        }
+    }
+    return comparators;
+}
+
+} // namespace network_detail
+
+template <int N>
+struct SmallNetwork {
+    static constexpr int COUNT = network_detail::odd_even_comparator_count(N);
+    static constexpr std::array<Comparator, COUNT> COMPARATORS = network_detail::make_odd_even_network<N>();
+};
+
+// Branchless exchange, compilers turn it into conditional moves (or min/max for arithmetic types)
+template <typename T>
+inline void compare_exchange(T& a, T& b) {
+    const bool out_of_order = b < a;
+    const T lo = out_of_order ? b : a;
+    const T hi = out_of_order ? a : b;
+    a = lo;
+    b = hi;
+}
+
+namespace network_detail {
+
+template <int N, typename T, std::size_t... I>
+inline void apply_small_network(T* arr, std::index_sequence<I...>) {
+    (void)arr; // Unused by the empty networks
+    (compare_exchange(arr[SmallNetwork<N>::COMPARATORS[I].lo], arr[SmallNetwork<N>::COMPARATORS[I].hi]), ...);
+}
+
+template <typename T, std::size_t N>
+inline void small_network_entry(T* arr) {
+    apply_small_network<(int)N>(arr, std::make_index_sequence<SmallNetwork<(int)N>::COUNT>{});
+}
+
+template <typename T, std::size_t... N>
+constexpr std::array<void (*)(T*), sizeof...(N)> make_small_network_table(std::index_sequence<N...>) {
+    return {{&small_network_entry<T, N>...}};
+}
+
+template <std::size_t... N>
+constexpr std::array<const Comparator*, sizeof...(N)> make_comparator_table(std::index_sequence<N...>) {
+    return {{SmallNetwork<(int)N>::COMPARATORS.data()...}};
+}
+
+template <std::size_t... N>
+constexpr std::array<int, sizeof...(N)> make_count_table(std::index_sequence<N...>) {
+    return {{SmallNetwork<(int)N>::COUNT...}};
+}
+
+} // namespace network_detail
+
+// Sorts arr[0, N) with the fully unrolled network
+template <int N, typename T>
+inline void small_network_sort(T* arr) {
+    network_detail::small_network_entry<T, (std::size_t)N>(arr);
+}
+
+// Sorts arr[0, size) for any size up to MAX_SMALL_NETWORK by jumping to the unrolled network of that size
+template <typename T>
+inline void small_network_sort(T* arr, int size) {
+    static constexpr auto table = network_detail::make_small_network_table<T>(std::make_index_sequence<MAX_SMALL_NETWORK + 1>{});
+    table[size](arr);
+}
+
+// Comparator list of the network for size (for stepping through it one comparator at a time)
+inline const Comparator* small_network_comparators(int size, int& count) {
+    static constexpr auto comparators = network_detail::make_comparator_table(std::make_index_sequence<MAX_SMALL_NETWORK + 1>{});
+    static constexpr auto counts = network_detail::make_count_table(std::make_index_sequence<MAX_SMALL_NETWORK + 1>{});
+    count = counts[size];
+    return comparators[size];
+}
@@ -0,0 +1,60 @@
+#include <algorithm> // std::max()
+#include "step_rates.h"
+
+StepRates::StepRates() : m_compares(HISTORY), m_swaps(HISTORY), m_writes(HISTORY), m_sortedness(HISTORY) {}
+
+void StepRates::add(int compares, int swaps, int writes, const std::vector<int>& arr) {
+    m_window_compares += compares;
+    m_window_swaps += swaps;
+    m_window_writes += writes;
+    if (++m_window_steps == WINDOW_STEPS) {
+        record(arr);
+    }
+}
+
+void StepRates::flush(const std::vector<int>& arr) {
+    if (m_window_steps > 0) {
+        record(arr);
+    }
+}
+
+void StepRates::record(const std::vector<int>& arr) {
+    m_compares.push((float)m_window_compares);
+    m_swaps.push((float)m_window_swaps);
+    m_writes.push((float)m_window_writes);
+    m_sortedness.push(adjacent_sortedness(arr));
+    m_window_steps = 0;
+    m_window_compares = 0;
+    m_window_swaps = 0;
+    m_window_writes = 0;
+}
+
+void StepRates::clear() {
+    m_window_steps = 0;
+    m_window_compares = 0;
+    m_window_swaps = 0;
+    m_window_writes = 0;
+    m_compares.clear();
+    m_swaps.clear();
+    m_writes.clear();
+    m_sortedness.clear();
+}
+
+float StepRates::max_of(const RingBuffer<float>& history) {
+    float max_value = 0.0f;
+    for (size_t i = 0; i < history.size(); ++i) {
+        max_value = std::max(max_value, history[i]);
+    }
+    return max_value;
+}
+
+float adjacent_sortedness(const std::vector<int>& arr) {
+    if (arr.size() < 2) {
+        return 1.0f;
+    }
+    size_t in_order = 0;
+    for (size_t i = 1; i < arr.size(); ++i) {
+        in_order += (arr[i - 1] <= arr[i]) ? 1 : 0;
+    }
+    return (float)in_order / (float)(arr.size() - 1);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector> // std::vector
+#include "ring_buffer.h"
+
+// Rolling history of the running algorithm's work, binned into windows of WINDOW_STEPS steps: comparisons, swaps and
+// writes done in each of the last HISTORY windows and the array's sortedness at the end of each. Every sample covers
+// the same number of steps whatever the frame rate or steps per frame, so phases show up as changes in the mix of work,
+// e.g. Heap Sort's build heap vs extract or Comb Sort's swaps thinning out as the gap shrinks. The rings are sized
+// once, so recording never allocates, and the O(n) sortedness pass runs once per window rather than per step.
+class StepRates {
+public:
+    static constexpr size_t HISTORY = 600;
+    static constexpr int WINDOW_STEPS = 32;
+
+    StepRates();
+
+    // One step's work. The step that fills a window records it, with the sortedness of arr after that step.
+    void add(int compares, int swaps, int writes, const std::vector<int>& arr);
+    // Records the partial window left at the end of a run, if there is one
+    void flush(const std::vector<int>& arr);
+    void clear();
+
+    size_t windows() const {
+        return m_compares.size();
+    }
+    const RingBuffer<float>& compares() const {
+        return m_compares;
+    }
+    const RingBuffer<float>& swaps() const {
+        return m_swaps;
+    }
+    const RingBuffer<float>& writes() const {
+        return m_writes;
+    }
+    const RingBuffer<float>& sortedness() const {
+        return m_sortedness;
+    }
+
+    // Largest value in the history, 0 when empty
+    static float max_of(const RingBuffer<float>& history);
+
+private:
+    void record(const std::vector<int>& arr);
+
+    int m_window_steps = 0;
+    int m_window_compares = 0;
+    int m_window_swaps = 0;
+    int m_window_writes = 0;
+    RingBuffer<float> m_compares;
+    RingBuffer<float> m_swaps;
+    RingBuffer<float> m_writes;
+    RingBuffer<float> m_sortedness;
+};
+
+// Fraction of adjacent pairs in order (0-1), 1 for a sorted array. One pass, no allocation.
+float adjacent_sortedness(const std::vector<int>& arr);
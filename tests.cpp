@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "access_counters.h"
+#include "bench_results.h"
+#include "cache_sim.h"
+#include "frame_export.h"
+#include "sorting_algo.h"
+
+// Global constants for default settings
+static const unsigned int TEST_SEED = 12345;
+static const int TEST_SIZES[] = {0, 1, 2, 37, 256}; // Empty, trivial, one pair, odd, power of two
+// sort() only: above ParallelMergeSort's MIN_CHUNK_SIZE and the parallel sorts' sequential cutoffs (up to 1 << 14),
+// so the threaded paths run
+static const int NATIVE_SIZES[] = {4097, 40001};
+// Stepped write counts: 100 and 333 end a ping-pong Merge Sort with a step that drains a merge tail and starts the copy
+static const int WRITE_COUNT_SIZES[] = {0, 1, 2, 37, 100, 256, 333};
+static const char* const TEST_INPUTS[] = {"random", "sorted", "reversed", "few", "wide"};
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+// Function prototypes
+static void test_algorithms();
+static void test_native_sizes();
+static void test_write_counts();
+static void test_counting_sort_stable();
+static void test_parse_cache_levels();
+static void test_compare_timings();
+static void test_frame_size();
+static std::vector<std::unique_ptr<SortingAlgo>> all_algorithms();
+static bool is_quadratic(const SortingAlgo& algo);
+static void fill_input(std::vector<int>& arr, int size, const char* input, std::mt19937& rng);
+static TimingStats make_timings(double mean_ms, double spread_ms, int trials);
+static void check(bool ok, const char* what, const char* file, int line);
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+static const TestCase TESTS[] = {
+    {"algorithms", test_algorithms},
+    {"native_sizes", test_native_sizes},
+    {"write_counts", test_write_counts},
+    {"counting_sort_stable", test_counting_sort_stable},
+    {"parse_cache_levels", test_parse_cache_levels},
+    {"compare_timings", test_compare_timings},
+    {"frame_size", test_frame_size},
+};
+
+static int g_checks = 0;
+static int g_failures = 0;
+
+// Runs every test, or only those whose name contains the first argument. Exits with 1 if any check failed.
+int main(int argc, char** argv) {
+    const char* filter = (argc > 1) ? argv[1] : "";
+    for (const TestCase& test : TESTS) {
+        if (std::strstr(test.name, filter) == nullptr) {
+            continue;
+        }
+        const int failures_before = g_failures;
+        test.run();
+        std::printf("%-24s %s\n", test.name, (g_failures == failures_before) ? "ok" : "FAILED");
+    }
+    std::printf("%d checks, %d failed\n", g_checks, g_failures);
+    return (g_failures == 0) ? 0 : 1;
+}
+
+// Every algorithm and variant, stepped to completion and through sort(), against std::sort on every input and size
+static void test_algorithms() {
+    const std::vector<std::unique_ptr<SortingAlgo>> algorithms = all_algorithms();
+    std::mt19937 rng(TEST_SEED);
+    std::vector<int> input;
+    std::vector<int> expected;
+    std::vector<int> arr;
+    for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+        for (const char* input_name : TEST_INPUTS) {
+            for (int size : TEST_SIZES) {
+                fill_input(input, size, input_name, rng);
+                expected = input;
+                std::sort(expected.begin(), expected.end());
+
+                arr = input;
+                run_steps(*algo, arr);
+                if (arr != expected || !algo->is_done()) {
+                    std::printf("  %s, %s input of %d: stepped run didn't sort\n", algo->name(), input_name, size);
+                    CHECK(arr == expected && algo->is_done());
+                } else {
+                    CHECK(true);
+                }
+
+                arr = input;
+                algo->sort(arr);
+                if (arr != expected) {
+                    std::printf("  %s, %s input of %d: sort() didn't sort\n", algo->name(), input_name, size);
+                }
+                CHECK(arr == expected);
+            }
+        }
+    }
+}
+
+// sort() of every algorithm but the quadratic ones on sizes past the parallel cutoffs, with 3 and 4 threads
+static void test_native_sizes() {
+    const std::vector<std::unique_ptr<SortingAlgo>> algorithms = all_algorithms();
+    std::mt19937 rng(TEST_SEED);
+    std::vector<int> input;
+    std::vector<int> expected;
+    std::vector<int> arr;
+    for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+        if (is_quadratic(*algo)) {
+            continue;
+        }
+        for (const char* input_name : TEST_INPUTS) {
+            for (int size : NATIVE_SIZES) {
+                fill_input(input, size, input_name, rng);
+                expected = input;
+                std::sort(expected.begin(), expected.end());
+
+                arr = input;
+                algo->sort(arr);
+                if (arr != expected) {
+                    std::printf("  %s, %s input of %d: sort() didn't sort\n", algo->name(), input_name, size);
+                }
+                CHECK(arr == expected);
+            }
+        }
+    }
+}
+
+// The write_count every step reports adds up to the writes the access counters saw, array and buffer together. Keys
+// stay below the size so every buffer index (e.g. a counting histogram) is one the counters track.
+static void test_write_counts() {
+    const std::vector<std::unique_ptr<SortingAlgo>> algorithms = all_algorithms();
+    std::mt19937 rng(TEST_SEED);
+    AccessCounters counters;
+    std::vector<int> arr;
+    for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+        algo->set_access_counters(&counters);
+        for (const char* input_name : {"random", "sorted", "reversed"}) {
+            for (int size : WRITE_COUNT_SIZES) {
+                fill_input(arr, size, input_name, rng);
+                counters.reset(size);
+                const SortRunTotals totals = run_steps(*algo, arr);
+
+                long long counted = 0;
+                for (int i = 0; i < size; ++i) {
+                    counted += (long long)counters.writes[i] + counters.buffer_writes[i];
+                }
+                if (totals.writes != counted) {
+                    std::printf("  %s, %s input of %d: %lld writes reported, %lld counted\n", algo->name(), input_name,
+                        size, totals.writes, counted);
+                }
+                CHECK(totals.writes == counted);
+            }
+        }
+        algo->set_access_counters(nullptr);
+    }
+}
+
+// Equal keys keep their input order, on a dense key range and on one past the cap (the comparison fallback)
+static void test_counting_sort_stable() {
+    std::mt19937 rng(TEST_SEED);
+    for (const char* input_name : {"few", "wide"}) {
+        for (int size : TEST_SIZES) {
+            std::vector<int> keys;
+            fill_input(keys, size, input_name, rng);
+            if (std::strcmp(input_name, "wide") == 0 && size >= 4) {
+                keys[size / 2] = keys[size / 4]; // At least one tie
+            }
+            std::vector<int> expected = keys;
+            std::sort(expected.begin(), expected.end());
+            std::vector<int> values(size);
+            for (int i = 0; i < size; ++i) {
+                values[i] = i;
+            }
+
+            const std::vector<int> input = keys;
+            counting_sort_stable(keys, values);
+            CHECK(keys == expected);
+            bool stable = true;
+            for (int i = 0; i < size; ++i) {
+                stable = stable && (input[values[i]] == keys[i]);
+                if (i > 0 && keys[i - 1] == keys[i]) {
+                    stable = stable && (values[i - 1] < values[i]);
+                }
+            }
+            CHECK(stable);
+        }
+    }
+}
+
+static void test_parse_cache_levels() {
+    std::vector<CacheLevelConfig> levels;
+    CHECK(parse_cache_levels("32K/8,1M/16,8M/16", levels));
+    CHECK(levels.size() == 3);
+    if (levels.size() == 3) {
+        CHECK(levels[0].size_bytes == 32 * 1024 && levels[0].ways == 8);
+        CHECK(levels[1].size_bytes == 1024 * 1024 && levels[1].ways == 16);
+        CHECK(levels[2].size_bytes == 8 * 1024 * 1024 && levels[2].ways == 16);
+    }
+    CHECK(parse_cache_levels("256/2,1k/4,4K/8", levels));
+    CHECK(levels.size() == 3 && levels[0].size_bytes == 256 && levels[1].size_bytes == 1024);
+
+    // Malformed: empty, no ways, zero size or ways, unknown suffix, trailing garbage
+    for (const char* spec : {"", "32K", "32K/", "0/8", "32K/0", "/8", "32G/8", "32K/8;1M/16", "32K/8x"}) {
+        const bool parsed = parse_cache_levels(spec, levels);
+        if (parsed) {
+            std::printf("  \"%s\" parsed\n", spec);
+        }
+        CHECK(!parsed);
+    }
+}
+
+static void test_compare_timings() {
+    const TimingStats baseline = make_timings(10.0, 0.1, 10);
+
+    CHECK(compare_timings(baseline, make_timings(10.0, 0.1, 10), 0.05).verdict == BenchVerdict::Same);
+    CHECK(compare_timings(baseline, make_timings(12.0, 0.1, 10), 0.05).verdict == BenchVerdict::Slower);
+    CHECK(compare_timings(baseline, make_timings(8.0, 0.1, 10), 0.05).verdict == BenchVerdict::Faster);
+    // A 3% change is real but under the threshold, a 20% one drowns in the noise
+    CHECK(compare_timings(baseline, make_timings(10.3, 0.1, 10), 0.05).verdict == BenchVerdict::Same);
+    CHECK(compare_timings(baseline, make_timings(12.0, 8.0, 10), 0.05).verdict == BenchVerdict::Same);
+
+    const BenchDiff diff = compare_timings(baseline, make_timings(12.0, 0.1, 10), 0.05);
+    CHECK(diff.ratio > 1.19 && diff.ratio < 1.21);
+    CHECK(diff.diff_low_ms < 2.0 && diff.diff_high_ms > 2.0);
+
+    // Too few trials for an interval
+    CHECK(compare_timings(make_timings(10.0, 0.0, 1), make_timings(20.0, 0.0, 1), 0.05).verdict == BenchVerdict::Same);
+}
+
+// A Y4M stream is its header plus, per frame, "FRAME\n" and a 4:2:0 picture of 1.5 bytes per (even-rounded) pixel
+static void test_frame_size() {
+    std::vector<uint8_t> rgb(64 * 36 * 3, 128);
+    std::vector<uint8_t> yuv;
+    rgb_to_i420(rgb.data(), 64, 36, yuv);
+    CHECK(yuv.size() == 64 * 36 * 3 / 2);
+
+    ExportOptions options;
+    options.width = 65; // Rounded down to 64
+    options.height = 37; // And to 36
+    options.threads = 2;
+    for (ExportFormat format : {ExportFormat::Y4M, ExportFormat::RawRgb}) {
+        options.format = format;
+        FILE* out = std::tmpfile();
+        CHECK(out != nullptr);
+        if (out == nullptr) {
+            continue;
+        }
+
+        std::vector<int> arr = {5, 3, 8, 1, 9, 2, 7, 4, 6, 0};
+        InsertionSort algo;
+        const long long frames = export_run(algo, arr, options, out);
+        CHECK(frames > 2);
+        CHECK(std::is_sorted(arr.begin(), arr.end()));
+
+        const long bytes = std::ftell(out);
+        std::fclose(out);
+        char header[64];
+        std::snprintf(header, sizeof(header), "YUV4MPEG2 W64 H36 F%d:1 Ip A1:1 C420jpeg\n", options.fps);
+        const long long expected = (format == ExportFormat::Y4M)
+            ? (long long)std::strlen(header) + frames * (6 + 64 * 36 * 3 / 2)
+            : frames * (64 * 36 * 3);
+        if (bytes != expected) {
+            std::printf("  %s: %ld bytes for %lld frames, expected %lld\n", (format == ExportFormat::Y4M) ? "y4m" : "rgb",
+                bytes, frames, expected);
+        }
+        CHECK(bytes == expected);
+    }
+}
+
+// The GUI's list plus every option combination it leaves out, the parallel sorts on 1, 3 and 4 threads
+static std::vector<std::unique_ptr<SortingAlgo>> all_algorithms() {
+    std::vector<std::unique_ptr<SortingAlgo>> algorithms = make_algorithms();
+    const std::vector<int> custom_gaps = {701, 301, 132, 57, 23, 10, 4};
+    for (int i = 0; i < GAP_SEQUENCE_COUNT; ++i) {
+        const GapSequence sequence = (GapSequence)i;
+        if (sequence != GapSequence::Shrink) {
+            std::unique_ptr<CombSort> comb = std::make_unique<CombSort>(sequence);
+            comb->gap_engine().set_custom(custom_gaps);
+            algorithms.emplace_back(std::move(comb));
+        }
+        if (sequence != GapSequence::Ciura && sequence != GapSequence::Tokuda && sequence != GapSequence::Pratt) {
+            std::unique_ptr<ShellSort> shell = std::make_unique<ShellSort>(sequence);
+            shell->gap_engine().set_custom(custom_gaps);
+            algorithms.emplace_back(std::move(shell));
+        }
+    }
+    algorithms.emplace_back(std::make_unique<DaryHeapSort>(2, false));
+    algorithms.emplace_back(std::make_unique<DaryHeapSort>(4, false));
+    algorithms.emplace_back(std::make_unique<DaryHeapSort>(8, false));
+    algorithms.emplace_back(std::make_unique<DaryHeapSort>(8, true));
+    algorithms.emplace_back(std::make_unique<MergeSort>(LeafSort::Network, 16, true));
+    for (int threads : {1, 3, 4}) {
+        algorithms.emplace_back(std::make_unique<ParallelMergeSort>(threads));
+        algorithms.emplace_back(std::make_unique<ParallelQuickSort>(threads, false));
+        algorithms.emplace_back(std::make_unique<ParallelQuickSort>(threads, true));
+        algorithms.emplace_back(std::make_unique<ParallelSampleSort>(threads));
+    }
+    return algorithms;
+}
+
+// O(n^2) sort() too, left out of the native sizes
+static bool is_quadratic(const SortingAlgo& algo) {
+    return dynamic_cast<const BubbleSort*>(&algo) != nullptr || dynamic_cast<const SelectionSort*>(&algo) != nullptr ||
+        dynamic_cast<const CycleSort*>(&algo) != nullptr || dynamic_cast<const InsertionSort*>(&algo) != nullptr ||
+        dynamic_cast<const CocktailSort*>(&algo) != nullptr;
+}
+
+// random: a permutation-sized value range, few: 4 distinct keys, wide: the whole int range including both ends
+static void fill_input(std::vector<int>& arr, int size, const char* input, std::mt19937& rng) {
+    arr.resize(size);
+    if (std::strcmp(input, "sorted") == 0 || std::strcmp(input, "reversed") == 0) {
+        for (int i = 0; i < size; ++i) {
+            arr[i] = i;
+        }
+        if (std::strcmp(input, "reversed") == 0) {
+            std::reverse(arr.begin(), arr.end());
+        }
+    } else if (std::strcmp(input, "few") == 0) {
+        for (int& value : arr) {
+            value = (int)(rng() % 4);
+        }
+    } else if (std::strcmp(input, "wide") == 0) {
+        for (int& value : arr) {
+            value = (int)rng();
+        }
+        if (size >= 2) {
+            arr[0] = INT_MAX;
+            arr[size - 1] = INT_MIN;
+        }
+    } else {
+        for (int& value : arr) {
+            value = (int)(rng() % (unsigned int)size);
+        }
+    }
+}
+
+// trials times alternating mean +- spread
+static TimingStats make_timings(double mean_ms, double spread_ms, int trials) {
+    std::vector<double> times(trials);
+    for (int i = 0; i < trials; ++i) {
+        times[i] = mean_ms + ((i % 2 == 0) ? spread_ms : -spread_ms);
+    }
+    return summarize_timings(times);
+}
+
+static void check(bool ok, const char* what, const char* file, int line) {
+    ++g_checks;
+    if (!ok) {
+        ++g_failures;
+        std::printf("  %s:%d: CHECK(%s) failed\n", file, line, what);
+    }
+}
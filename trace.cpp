@@ -0,0 +1,87 @@
+#include <cstdio> // std::fopen(), std::fprintf()
+#include <utility> // std::move()
+#include "json_util.h"
+#include "trace.h"
+
+namespace {
+
+const char* track_name(TraceTrack track) {
+    return (track == TraceTrack::Frame) ? "main loop" : "algorithm";
+}
+
+} // namespace
+
+void TraceRecorder::enable() {
+    m_enabled = true;
+    m_origin = std::chrono::steady_clock::now();
+    m_events.clear();
+    m_dropped = 0;
+    m_phase.clear();
+    m_phase_algorithm.clear();
+}
+
+void TraceRecorder::add(Event&& event) {
+    if (m_events.size() >= MAX_EVENTS) {
+        ++m_dropped;
+        return;
+    }
+    m_events.push_back(std::move(event));
+}
+
+void TraceRecorder::span(const char* name, long long start_us, long long end_us, TraceTrack track) {
+    if (m_enabled) {
+        add({name, std::string(), start_us, end_us, track});
+    }
+}
+
+void TraceRecorder::phase(const char* algorithm, const char* phase) {
+    if (!m_enabled) {
+        return;
+    }
+
+    const bool same = (phase != nullptr) && (m_phase == phase) && (m_phase_algorithm == algorithm);
+    if (same) {
+        return;
+    }
+
+    const long long now = now_us();
+    if (!m_phase.empty()) {
+        add({m_phase, m_phase_algorithm, m_phase_start_us, now, TraceTrack::Algorithm});
+    }
+
+    m_phase = (phase != nullptr) ? phase : "";
+    m_phase_algorithm = (phase != nullptr) ? algorithm : "";
+    m_phase_start_us = now;
+}
+
+bool TraceRecorder::save(const char* path) {
+    phase(nullptr, nullptr);
+
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    // Complete ("X") events on one process, one thread id per track, named by metadata events
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    const TraceTrack tracks[] = {TraceTrack::Frame, TraceTrack::Algorithm};
+    for (TraceTrack track : tracks) {
+        std::fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n",
+            (int)track + 1, track_name(track));
+    }
+    for (size_t i = 0; i < m_events.size(); ++i) {
+        const Event& event = m_events[i];
+        std::fprintf(file, "{\"ph\":\"X\",\"name\":");
+        write_json_string(file, event.name);
+        std::fprintf(file, ",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld", (int)event.track + 1, event.start_us,
+            event.end_us - event.start_us);
+        if (!event.algorithm.empty()) {
+            std::fprintf(file, ",\"args\":{\"algorithm\":");
+            write_json_string(file, event.algorithm);
+            std::fprintf(file, "}");
+        }
+        std::fprintf(file, "}%s\n", (i + 1 < m_events.size()) ? "," : "");
+    }
+    std::fprintf(file, "]}\n");
+    return std::fclose(file) == 0;
+}
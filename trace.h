@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono> // std::chrono::steady_clock
+#include <string> // std::string
+#include <vector> // std::vector
+
+// Timeline tracks of the trace, shown as separate rows by the viewer
+enum class TraceTrack {
+    Frame, // Main loop spans
+    Algorithm, // Phases of the running algorithm
+};
+
+// Records timestamped spans and writes them as Chrome trace event JSON, which chrome://tracing and
+// ui.perfetto.dev open directly. Recording is off until enable(), so the spans cost one branch otherwise.
+class TraceRecorder {
+public:
+    void enable();
+    bool enabled() const {
+        return m_enabled;
+    }
+
+    // Microseconds since enable()
+    long long now_us() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_origin).count();
+    }
+
+    void span(const char* name, long long start_us, long long end_us, TraceTrack track = TraceTrack::Frame);
+
+    // Marks what the algorithm is doing from now on. A change of algorithm or phase closes the previous phase span,
+    // a null phase closes it without opening another (the algorithm is idle).
+    void phase(const char* algorithm, const char* phase);
+
+    // Closes the open phase and writes every span, false if the file can't be written
+    bool save(const char* path);
+
+    size_t dropped() const {
+        return m_dropped;
+    }
+
+private:
+    struct Event {
+        std::string name;
+        std::string algorithm; // Only for phase spans
+        long long start_us;
+        long long end_us;
+        TraceTrack track;
+    };
+
+    // Beyond this the oldest spans are kept and new ones dropped (an uncapped frame rate adds spans fast)
+    static constexpr size_t MAX_EVENTS = 1 << 21;
+
+    void add(Event&& event);
+
+    bool m_enabled = false;
+    std::chrono::steady_clock::time_point m_origin;
+    std::vector<Event> m_events;
+    size_t m_dropped = 0;
+
+    std::string m_phase;
+    std::string m_phase_algorithm;
+    long long m_phase_start_us = 0;
+};
+
+// Span covering the lifetime of the scope
+class TraceScope {
+public:
+    TraceScope(TraceRecorder& recorder, const char* name) : m_recorder(recorder), m_name(name) {
+        if (m_recorder.enabled()) {
+            m_start_us = m_recorder.now_us();
+        }
+    }
+
+    ~TraceScope() {
+        if (m_recorder.enabled()) {
+            m_recorder.span(m_name, m_start_us, m_recorder.now_us());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceRecorder& m_recorder;
+    const char* m_name;
+    long long m_start_us = 0;
+};
@@ -0,0 +1,108 @@
+#include <cstdio> // std::fopen(), std::fprintf()
+#include <cstdlib> // std::abs(), std::strtod()
+#include <fstream> // std::ifstream
+#include <sstream> // std::istringstream
+#include "tuning.h"
+
+int tuning_size_class(int size) {
+    int size_class = 0;
+    while (size_class < 31 && (1 << size_class) < size) {
+        ++size_class;
+    }
+    return size_class;
+}
+
+bool TuningTable::load(const char* path) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    m_entries.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        Entry entry;
+        std::string size_class;
+        std::string pairs;
+        if (!std::getline(fields, entry.key_type, '\t') || !std::getline(fields, size_class, '\t') ||
+            !std::getline(fields, entry.algo, '\t') || !std::getline(fields, pairs)) {
+            std::fprintf(stderr, "Skipping malformed tuning line: %s\n", line.c_str());
+            continue;
+        }
+        entry.size_class = std::atoi(size_class.c_str());
+
+        std::istringstream pair_stream(pairs);
+        std::string pair;
+        while (pair_stream >> pair) {
+            const size_t eq = pair.find('=');
+            if (eq != std::string::npos) {
+                entry.params.emplace_back(pair.substr(0, eq), std::strtod(pair.c_str() + eq + 1, nullptr));
+            }
+        }
+        m_entries.push_back(entry);
+    }
+    return true;
+}
+
+bool TuningTable::save(const char* path) const {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::fprintf(file, "# vsort autotuner results: key type, size class (n <= 2^class), algorithm, parameters\n");
+    for (const Entry& entry : m_entries) {
+        std::fprintf(file, "%s\t%d\t%s\t", entry.key_type.c_str(), entry.size_class, entry.algo.c_str());
+        for (size_t i = 0; i < entry.params.size(); ++i) {
+            std::fprintf(file, "%s%s=%g", (i > 0) ? " " : "", entry.params[i].first.c_str(), entry.params[i].second);
+        }
+        std::fprintf(file, "\n");
+    }
+    std::fclose(file);
+    return true;
+}
+
+void TuningTable::store(const char* algo, const char* key_type, int size, const std::vector<AlgoParam>& params) {
+    Entry entry;
+    entry.algo = algo;
+    entry.key_type = key_type;
+    entry.size_class = tuning_size_class(size);
+    for (const AlgoParam& param : params) {
+        entry.params.emplace_back(param.name, param.value);
+    }
+
+    for (Entry& existing : m_entries) {
+        if (existing.algo == entry.algo && existing.key_type == entry.key_type && existing.size_class == entry.size_class) {
+            existing = entry;
+            return;
+        }
+    }
+    m_entries.push_back(entry);
+}
+
+bool TuningTable::apply(SortingAlgo& algo, const char* algo_key, const char* key_type, int size) const {
+    const int size_class = tuning_size_class(size);
+    const Entry* best = nullptr;
+    for (const Entry& entry : m_entries) {
+        if (entry.algo != algo_key || entry.key_type != key_type) {
+            continue;
+        }
+        if (best == nullptr || std::abs(entry.size_class - size_class) < std::abs(best->size_class - size_class)) {
+            best = &entry;
+        }
+    }
+
+    if (best == nullptr) {
+        return false;
+    }
+
+    for (const auto& param : best->params) {
+        algo.set_param(param.first.c_str(), param.second);
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string> // std::string
+#include <vector> // std::vector
+#include "sorting_algo.h"
+
+// Default file the autotuner writes and the GUI reads, relative to the working directory
+static const char* const TUNING_FILE = "vsort_tuning.txt";
+
+// Sizes are grouped by power of two: the size class of n is ceil(log2(n))
+int tuning_size_class(int size);
+
+// Best parameters found by the autotuner, keyed by algorithm, key type and size class. The algorithm key is the name
+// of the untuned instance, since names can change with the parameters.
+// Stored as one tab-separated line per entry: key type, size class, algorithm name, then name=value pairs.
+class TuningTable {
+public:
+    bool load(const char* path);
+    bool save(const char* path) const;
+
+    // Replaces the entry for (algo, key_type, size class of size)
+    void store(const char* algo, const char* key_type, int size, const std::vector<AlgoParam>& params);
+
+    // Applies the entry for the closest size class tuned for this algorithm and key type, false if there is none
+    bool apply(SortingAlgo& algo, const char* algo_key, const char* key_type, int size) const;
+
+    bool empty() const {
+        return m_entries.empty();
+    }
+
+private:
+    struct Entry {
+        std::string algo;
+        std::string key_type;
+        int size_class = 0;
+        std::vector<std::pair<std::string, double>> params;
+    };
+
+    std::vector<Entry> m_entries;
+};
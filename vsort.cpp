@@ -1,6 +1,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <algorithm>
 #include <vector>
@@ -8,7 +9,13 @@
 #include <string>
 #include <fstream>
 #include <SDL2/SDL.h>
+#include "complexity.h"
+#include "frame_stats.h"
+#include "palette.h"
 #include "sorting_algo.h"
+#include "step_rates.h"
+#include "trace.h"
+#include "tuning.h"
 #include "imgui/imgui.h"
 #include "imgui/backends/imgui_impl_sdl2.h"
 #include "imgui/backends/imgui_impl_sdlrenderer2.h"
@@ -18,14 +25,29 @@ static const int FPS = 0; // 0 for uncapped
 static const int ARRAY_SIZE = 100;
 static const int MIN_ARRAY_SIZE = 50;
 static const int MAX_ARRAY_SIZE = 500;
+static const int MAX_STEPS_PER_FRAME = 1000;
 static const int WINDOW_WIDTH = 1280;
 static const int WINDOW_HEIGHT = 720;
+static const int IDLE_REDRAW_FRAMES = 3; // Frames drawn after an event while idle, ImGui settles hover and popup state over a few
+static const int TEXT_CURSOR_BLINK_MS = 33; // Idle wake-up interval while a text field is focused, for its cursor
 
 // Global constants for UI layout
-static const int STATS_LINE_COUNT = 6;
+static const int STATS_LINE_COUNT = 7;
 static const float PADDING = 5.0f;
 static const float SECTION_GAP = PADDING;
 static const float FONT_SIZE = 17.0f;
+static const float HEAT_ROW_HEIGHT = 8.0f;
+// Simulated cache hierarchy, scaled down so arrays of a few hundred elements spill out of L1 and L2 the way large
+// sorts spill out of a real one
+static const char* const CACHE_LEVELS = "256/2,1K/4,4K/8";
+static const int CACHE_LINE_BYTES = 32;
+// Sizes of the complexity panel's sweep, kept small enough that a sweep of a quadratic sort blocks the UI for about a second
+static const int SWEEP_MIN_SIZE = 64;
+static const int SWEEP_MAX_SIZE = 1 << 16;
+static const double SWEEP_MAX_MS = 50.0;
+static const int SWEEP_COUNT_MAX_SIZE = 1 << 14;
+static const double SWEEP_JUMP = 0.25;
+static const char* const SWEEP_CSV_FILE = "vsort_sweep.csv";
 
 // Global variables
 static bool g_sorting_paused = true;
@@ -34,12 +56,35 @@ static bool g_repeat_elements = false;
 static bool g_weak_shuffle = false;
 static unsigned int g_num_swaps = 0;
 static unsigned int g_num_compar = 0;
+static unsigned int g_num_writes = 0;
 static int g_window_width = WINDOW_WIDTH;
 static int g_window_height = WINDOW_HEIGHT;
 static int g_array_size = ARRAY_SIZE;
 static int g_fps_cap = FPS;
+static int g_steps_per_frame = 1; // Sorting steps run per frame, the animation speed at a given frame rate
 static float g_fps = 0.0f;
 static float g_bar_spacing = 2.0f; // 0-4, default 2
+static TuningTable g_tuning; // Loaded from TUNING_FILE (written by vsort_bench tune) if present
+static std::vector<std::string> g_tuning_keys; // Untuned name of each algorithm
+
+// Writes of every algorithm replaying the input of the last completed run, ascending
+struct WriteRank {
+    std::string name;
+    long long writes;
+};
+static std::vector<int> g_run_input; // The array as the current run started
+static std::vector<WriteRank> g_write_ranking;
+static TraceRecorder g_trace; // Enabled by --trace FILE, written on exit
+static FrameStats g_frame_stats;
+static bool g_show_frame_stats = false; // Frame timing panel, toggled with F
+static AccessCounters g_access; // Reads and writes per index of the current run
+static bool g_show_heatmap = false; // Access heat strip under the bars, toggled with H
+static std::unique_ptr<CacheSim> g_cache; // Fed through g_access, configured by --cache and --line
+static bool g_show_complexity = false; // Complexity sweep panel, toggled with C
+static StepRates g_rates; // Work of the current run per window of steps
+static bool g_show_rates = false; // Rate plots panel, toggled with P
+static SweepSeries g_sweep; // Last sweep run from the panel
+static Uint32 g_wake_event = (Uint32)-1; // Pushed when sorting resumes, so an idle wait returns at once
 SDL_Window* g_window = nullptr;
 SDL_Renderer* g_renderer = nullptr;
 
@@ -48,16 +93,39 @@ static int init_sdl();
 static int init_imgui();
 static void init_array(std::vector<int>& arr);
 static void handle_events(bool& done, std::vector<int>& arr, std::vector<std::unique_ptr<SortingAlgo>>& algorithms, int& selected_algo);
+static void resume_sorting();
 static void switch_algorithm(std::vector<int>& arr, std::vector<std::unique_ptr<SortingAlgo>>& algorithms, int& selected_algo, int new_algo);
 static void set_array_size(std::vector<int>& arr, std::vector<std::unique_ptr<SortingAlgo>>& algorithms, int selected_algo, int new_size);
-static void render_bars(const std::vector<int>& arr, int hi1, int hi2, ImU32 color1, ImU32 color2);
-static void render_stats(const char* algo_name);
+static void apply_tuning(std::vector<std::unique_ptr<SortingAlgo>>& algorithms, int index);
+static void rank_writes(std::vector<std::unique_ptr<SortingAlgo>>& algorithms);
+static void render_bars(const std::vector<int>& arr, int hi1, int hi2, const std::vector<SortRegion>& regions, ImU32 color1, ImU32 color2);
+static void render_heat_row(ImDrawList* draw_list, const std::vector<unsigned int>& counts, float x, float y, float bar_width);
+static void render_stats(const SortingAlgo& algo);
 static void render_controls(std::vector<int>& arr, std::vector<std::unique_ptr<SortingAlgo>>& algorithms, int& selected_algo);
+static void render_frame_stats();
+static void render_complexity(std::vector<std::unique_ptr<SortingAlgo>>& algorithms, int selected_algo);
+static void render_rates(const SortingAlgo& algo);
 static float calc_stats_height();
+static double lap_ms(Uint64& mark);
+static ImU32 palette_col(const PaletteColor& color);
 
 int main(int argc, char** argv) {
-    (void)argc;
-    (void)argv;
+    const char* trace_path = nullptr;
+    CacheConfig cache_config;
+    cache_config.line_bytes = CACHE_LINE_BYTES;
+    parse_cache_levels(CACHE_LEVELS, cache_config.levels);
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0) {
+            trace_path = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--cache") == 0 && !parse_cache_levels(argv[i + 1], cache_config.levels)) {
+            fprintf(stderr, "Bad cache levels: %s (expected SIZE/WAYS,... e.g. 32K/8,1M/16)\n", argv[i + 1]);
+            return 1;
+        } else if (std::strcmp(argv[i], "--line") == 0) {
+            cache_config.line_bytes = std::max(4, std::atoi(argv[i + 1]));
+        }
+    }
+    g_cache = std::make_unique<CacheSim>(cache_config);
+    g_access.cache = g_cache.get();
 
     // Initialize SDL and create window and renderer
     if (init_sdl() != 0) {
@@ -74,18 +142,18 @@ int main(int argc, char** argv) {
     // Initialize the array to be sorted
     std::vector<int> arr;
     init_array(arr);
-    std::vector<std::unique_ptr<SortingAlgo>> algorithms;
-    algorithms.emplace_back(std::make_unique<BubbleSort>());
-    algorithms.emplace_back(std::make_unique<SelectionSort>());
-    algorithms.emplace_back(std::make_unique<InsertionSort>());
-    algorithms.emplace_back(std::make_unique<CocktailSort>());
-    algorithms.emplace_back(std::make_unique<CombSort>());
-    algorithms.emplace_back(std::make_unique<ShellSort>());
-    algorithms.emplace_back(std::make_unique<QuickSort>());
-    algorithms.emplace_back(std::make_unique<HeapSort>());
-    algorithms.emplace_back(std::make_unique<MergeSort>());
+    std::vector<std::unique_ptr<SortingAlgo>> algorithms = make_algorithms();
+    for (const std::unique_ptr<SortingAlgo>& algo : algorithms) {
+        g_tuning_keys.push_back(algo->name());
+        algo->set_access_counters(&g_access);
+    }
+    if (g_tuning.load(TUNING_FILE)) {
+        printf("Loaded tuned parameters from %s\n", TUNING_FILE);
+    }
+
     int selected_algo = 0;
     SortingAlgo* sorting_algo = algorithms[selected_algo].get();
+    apply_tuning(algorithms, selected_algo);
     sorting_algo->reset(g_array_size);
 
     bool done = false;
@@ -94,48 +162,114 @@ int main(int argc, char** argv) {
     Uint32 fps_last_ticks = SDL_GetTicks();
     unsigned int fps_frames = 0;
 
+    if (trace_path != nullptr) {
+        g_trace.enable();
+    }
+
     // Main loop
+    int redraw_frames = IDLE_REDRAW_FRAMES;
     while (!done) {
+        // Nothing animates while paused or done, so block until an event instead of redrawing. Only a focused text
+        // field needs frames without one, for its blinking cursor. Resuming pushes g_wake_event.
+        if ((g_sorting_done || g_sorting_paused) && redraw_frames <= 0) {
+            TraceScope scope(g_trace, "idle wait");
+            if (ImGui::GetIO().WantTextInput) {
+                redraw_frames = SDL_WaitEventTimeout(nullptr, TEXT_CURSOR_BLINK_MS) ? IDLE_REDRAW_FRAMES : 1;
+            } else {
+                SDL_WaitEvent(nullptr);
+                redraw_frames = IDLE_REDRAW_FRAMES;
+            }
+        }
+
+        TraceScope frame_scope(g_trace, "frame");
         Uint32 frame_start = SDL_GetTicks();
+        double stage_ms[FRAME_STAGE_COUNT] = {};
+        Uint64 stage_mark = SDL_GetPerformanceCounter();
 
-        handle_events(done, arr, algorithms, selected_algo);
+        {
+            TraceScope scope(g_trace, "handle_events");
+            handle_events(done, arr, algorithms, selected_algo);
+        }
+        stage_ms[(int)FrameStage::Events] = lap_ms(stage_mark);
 
-        // One sorting step per frame
+        // A batch of g_steps_per_frame sorting steps per frame, the highlights are the last step's
         int hi1 = -1;
         int hi2 = -1;
         if (!g_sorting_done && !g_sorting_paused) {
-            const SortStepResult step_result = sorting_algo->step(arr);
-            hi1 = step_result.hi1;
-            hi2 = step_result.hi2;
-            if (step_result.compared) {
-                ++g_num_compar;
-            }
-            if (step_result.swapped) {
-                ++g_num_swaps;
-            }
-            if (step_result.done) {
-                g_sorting_done = true;
-                g_sorting_paused = true;
+            TraceScope scope(g_trace, "step");
+            for (int i = 0; i < g_steps_per_frame && !g_sorting_done; ++i) {
+                const SortStepResult step_result = sorting_algo->step(arr);
+                hi1 = step_result.hi1;
+                hi2 = step_result.hi2;
+                const int compares = step_result.compared ? std::max(1, step_result.compare_count) : 0;
+                const int swaps = step_result.swapped ? std::max(1, step_result.swap_count) : 0;
+                g_num_compar += compares;
+                g_num_swaps += swaps;
+                g_num_writes += step_result.write_count;
+                g_rates.add(compares, swaps, step_result.write_count, arr);
+                if (step_result.done) {
+                    g_sorting_done = true;
+                    g_sorting_paused = true;
+                    g_rates.flush(arr);
+                    hi1 = -1;
+                    hi2 = -1;
+                    TraceScope rank_scope(g_trace, "rank_writes");
+                    rank_writes(algorithms);
+                }
             }
         }
+        if (g_sorting_done || g_sorting_paused) {
+            g_trace.phase(nullptr, nullptr);
+        } else {
+            g_trace.phase(sorting_algo->name(), sorting_algo->phase());
+        }
+        stage_ms[(int)FrameStage::Step] = lap_ms(stage_mark);
 
         // Start ImGui frame with the SDL2 backend
-        ImGui_ImplSDLRenderer2_NewFrame();
-        ImGui_ImplSDL2_NewFrame();
-        ImGui::NewFrame();
+        {
+            TraceScope scope(g_trace, "ImGui::NewFrame");
+            ImGui_ImplSDLRenderer2_NewFrame();
+            ImGui_ImplSDL2_NewFrame();
+            ImGui::NewFrame();
+        }
 
         // Render VSort stuff
-        render_stats(sorting_algo->name());
-        render_controls(arr, algorithms, selected_algo);
-        sorting_algo = algorithms[selected_algo].get();
-        render_bars(arr, hi1, hi2, IM_COL32(255, 60, 60, 255), IM_COL32(255, 200, 0, 255));
+        {
+            TraceScope scope(g_trace, "build UI");
+            render_stats(*sorting_algo);
+            render_controls(arr, algorithms, selected_algo);
+            sorting_algo = algorithms[selected_algo].get();
+            render_bars(arr, hi1, hi2, sorting_algo->regions(), palette_col(PALETTE_HIGHLIGHT1), palette_col(PALETTE_HIGHLIGHT2));
+            if (g_show_frame_stats) {
+                render_frame_stats();
+            }
+            if (g_show_complexity) {
+                render_complexity(algorithms, selected_algo);
+            }
+            if (g_show_rates) {
+                render_rates(*sorting_algo);
+            }
+        }
 
         // Render ImGui and present the frame
-        ImGui::Render();
-        SDL_SetRenderDrawColor(g_renderer, 13, 13, 13, 255);
-        SDL_RenderClear(g_renderer);
-        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), g_renderer);
-        SDL_RenderPresent(g_renderer);
+        {
+            TraceScope scope(g_trace, "ImGui::Render");
+            ImGui::Render();
+        }
+        stage_ms[(int)FrameStage::UiBuild] = lap_ms(stage_mark);
+        {
+            TraceScope scope(g_trace, "RenderDrawData");
+            SDL_SetRenderDrawColor(g_renderer, PALETTE_BACKGROUND.r, PALETTE_BACKGROUND.g, PALETTE_BACKGROUND.b, 255);
+            SDL_RenderClear(g_renderer);
+            ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), g_renderer);
+        }
+        stage_ms[(int)FrameStage::Submit] = lap_ms(stage_mark);
+        {
+            TraceScope scope(g_trace, "SDL_RenderPresent");
+            SDL_RenderPresent(g_renderer);
+        }
+        stage_ms[(int)FrameStage::Present] = lap_ms(stage_mark);
+        g_frame_stats.add(stage_ms);
 
         // FPS calculation
         ++fps_frames;
@@ -147,9 +281,15 @@ int main(int argc, char** argv) {
             fps_last_ticks = now;
         }
 
+        if (g_sorting_done || g_sorting_paused) {
+            --redraw_frames;
+        } else {
+            redraw_frames = IDLE_REDRAW_FRAMES;
+        }
+
         // Frame cap policy
         Uint32 target_frame_ms = 0;
-        if (g_sorting_done || g_sorting_paused) { // 30 fps when paused/done to reduce load whilst keeping responsiveness
+        if (g_sorting_done || g_sorting_paused) { // 30 fps at most for the frames drawn while idle (e.g. dragging the mouse)
             target_frame_ms = 33;
         } else if (g_fps_cap > 0) {
             target_frame_ms = (Uint32)(1000.0f / g_fps_cap);
@@ -161,11 +301,20 @@ int main(int argc, char** argv) {
         if (target_frame_ms > 0) {
             Uint32 frame_time = SDL_GetTicks() - frame_start;
             if (frame_time < target_frame_ms) {
+                TraceScope scope(g_trace, "frame cap delay");
                 SDL_Delay(target_frame_ms - frame_time);
             }
         }
     }
 
+    if (trace_path != nullptr) {
+        if (g_trace.save(trace_path)) {
+            printf("Trace written to %s (%zu spans dropped)\n", trace_path, g_trace.dropped());
+        } else {
+            fprintf(stderr, "Failed to write the trace to %s\n", trace_path);
+        }
+    }
+
     // Cleanup ImGui and SDL
     ImGui_ImplSDLRenderer2_Shutdown();
     ImGui_ImplSDL2_Shutdown();
@@ -214,11 +363,15 @@ static void handle_events(bool& done, std::vector<int>& arr, std::vector<std::un
                         } else {
                             g_num_swaps = 0;
                             g_num_compar = 0;
+                            g_num_writes = 0;
                         }
                         algorithms[selected_algo]->reset(g_array_size);
+                        g_run_input = arr;
+                        g_access.reset(g_array_size);
+                        g_rates.clear();
                     }
                     g_sorting_done = false;
-                    g_sorting_paused = false;
+                    resume_sorting();
                 }
             } else if (event.key.keysym.sym == SDLK_BACKSPACE) { // Space to start/stop sorting
                 init_array(arr);
@@ -254,6 +407,14 @@ static void handle_events(bool& done, std::vector<int>& arr, std::vector<std::un
                 }
             } else if (event.key.keysym.sym == SDLK_0) { // 0 to remove FPS cap
                 g_fps_cap = 0;
+            } else if (event.key.keysym.sym == SDLK_f) { // Toggle the frame timing panel
+                g_show_frame_stats = !g_show_frame_stats;
+            } else if (event.key.keysym.sym == SDLK_h) { // Toggle the access heatmap
+                g_show_heatmap = !g_show_heatmap;
+            } else if (event.key.keysym.sym == SDLK_c) { // Toggle the complexity sweep panel
+                g_show_complexity = !g_show_complexity;
+            } else if (event.key.keysym.sym == SDLK_p) { // Toggle the rate plots panel
+                g_show_rates = !g_show_rates;
             } else if (event.key.keysym.sym == SDLK_COMMA) { // </> to change bar spacing
                 g_bar_spacing -= 1.0f;
                 if (g_bar_spacing < 0.0f) {
@@ -269,6 +430,15 @@ static void handle_events(bool& done, std::vector<int>& arr, std::vector<std::un
     }
 }
 
+static void resume_sorting() {
+    g_sorting_paused = false;
+    if (g_wake_event != (Uint32)-1) {
+        SDL_Event event = {};
+        event.type = g_wake_event;
+        SDL_PushEvent(&event);
+    }
+}
+
 static int init_sdl() {
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0) {
         std::fprintf(stderr, "SDL_Init Error: %s\n", SDL_GetError());
@@ -292,6 +462,7 @@ static int init_sdl() {
 
     // Minimum size to prevent controls from being unusable
     SDL_SetWindowMinimumSize(g_window, 890, 400);
+    g_wake_event = SDL_RegisterEvents(1);
 
     SDL_GetWindowSize(g_window, &g_window_width, &g_window_height);
     return 0;
@@ -405,6 +576,10 @@ static void init_array(std::vector<int>& arr) {
 
     g_num_swaps = 0;
     g_num_compar = 0;
+    g_num_writes = 0;
+    g_write_ranking.clear();
+    g_access.reset(g_array_size);
+    g_rates.clear();
 }
 
 static void switch_algorithm(std::vector<int>& arr, std::vector<std::unique_ptr<SortingAlgo>>& algorithms, int& selected_algo, int new_algo) {
@@ -414,9 +589,13 @@ static void switch_algorithm(std::vector<int>& arr, std::vector<std::unique_ptr<
 
     (void)arr;
     selected_algo = new_algo;
+    apply_tuning(algorithms, selected_algo);
     algorithms[selected_algo]->reset(g_array_size);
     g_num_swaps = 0;
     g_num_compar = 0;
+    g_num_writes = 0;
+    g_access.reset(g_array_size);
+    g_rates.clear();
     g_sorting_done = true;
     g_sorting_paused = true;
 }
@@ -429,12 +608,38 @@ static void set_array_size(std::vector<int>& arr, std::vector<std::unique_ptr<So
 
     g_array_size = clamped_size;
     init_array(arr);
+    apply_tuning(algorithms, selected_algo);
     algorithms[selected_algo]->reset(g_array_size);
     g_sorting_done = true;
     g_sorting_paused = true;
 }
 
-static void render_bars(const std::vector<int>& arr, int hi1, int hi2, ImU32 color1, ImU32 color2) {
+// Tuned parameters depend on the size class, so they are re-applied whenever the algorithm or the size changes
+static void apply_tuning(std::vector<std::unique_ptr<SortingAlgo>>& algorithms, int index) {
+    if (!g_tuning.empty()) {
+        g_tuning.apply(*algorithms[index], g_tuning_keys[index].c_str(), "int32", g_array_size);
+    }
+}
+
+// Replays the run's input through every algorithm. The selected one ends up done on the same input again, and the
+// others are reset (and re-tuned) when they get selected.
+static void rank_writes(std::vector<std::unique_ptr<SortingAlgo>>& algorithms) {
+    g_write_ranking.clear();
+    std::vector<int> arr;
+    for (int i = 0; i < (int)algorithms.size(); ++i) {
+        apply_tuning(algorithms, i);
+        arr = g_run_input;
+        algorithms[i]->set_access_counters(nullptr); // The heatmap keeps the run that was watched
+        const SortRunTotals totals = run_steps(*algorithms[i], arr);
+        algorithms[i]->set_access_counters(&g_access);
+        g_write_ranking.push_back({algorithms[i]->name(), totals.writes});
+    }
+    std::stable_sort(g_write_ranking.begin(), g_write_ranking.end(), [](const WriteRank& a, const WriteRank& b) {
+        return a.writes < b.writes;
+    });
+}
+
+static void render_bars(const std::vector<int>& arr, int hi1, int hi2, const std::vector<SortRegion>& regions, ImU32 color1, ImU32 color2) {
     const float stats_height = calc_stats_height();
     const float sorting_height = (float)g_window_height - stats_height - (PADDING * 2.0f) - SECTION_GAP;
 
@@ -448,9 +653,16 @@ static void render_bars(const std::vector<int>& arr, int hi1, int hi2, ImU32 col
     ImVec2 p = ImGui::GetCursorScreenPos();
     ImVec2 avail = ImGui::GetContentRegionAvail();
 
+    // Heat strip rows: array reads and writes, then the buffer's if the algorithm has one
+    const bool has_buffer = std::any_of(g_access.buffer_writes.begin(), g_access.buffer_writes.end(), [](unsigned int c) {
+        return c > 0;
+    });
+    const int heat_rows = g_show_heatmap ? (has_buffer ? 4 : 2) : 0;
+    const float heat_height = (heat_rows > 0) ? (heat_rows * HEAT_ROW_HEIGHT) + PADDING : 0.0f;
+
     const int bar_count = (int)arr.size();
     const float bar_width = (avail.x - (bar_count - 1) * g_bar_spacing) / bar_count;
-    const float bar_max_height = avail.y;
+    const float bar_max_height = avail.y - heat_height;
 
     for (int i = 0; i < bar_count; ++i) {
         float h = (arr[i] / (float)bar_count) * bar_max_height;
@@ -459,7 +671,12 @@ static void render_bars(const std::vector<int>& arr, int hi1, int hi2, ImU32 col
         float x1 = x0 + bar_width;
         float y1 = p.y + bar_max_height;
 
-        ImU32 col = IM_COL32(220, 220, 220, 255);
+        ImU32 col = palette_col(PALETTE_BAR);
+        for (const SortRegion& region : regions) {
+            if (i >= region.lo && i <= region.hi) {
+                col = palette_col(PALETTE_WORKERS[region.worker % PALETTE_WORKER_COUNT]);
+            }
+        }
         if (i == hi1) {
             col = color1;
         }
@@ -470,10 +687,48 @@ static void render_bars(const std::vector<int>& arr, int hi1, int hi2, ImU32 col
         draw_list->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), col);
     }
 
+    if (heat_rows > 0) {
+        const std::vector<unsigned int>* rows[] = {&g_access.reads, &g_access.writes, &g_access.buffer_reads, &g_access.buffer_writes};
+        const float strip_y = p.y + bar_max_height + PADDING;
+        for (int row = 0; row < heat_rows; ++row) {
+            render_heat_row(draw_list, *rows[row], p.x, strip_y + (row * HEAT_ROW_HEIGHT), bar_width);
+        }
+
+        // Hovering the strip gives the counts of the index under the mouse
+        const ImVec2 mouse = ImGui::GetMousePos();
+        const int index = (int)((mouse.x - p.x) / (bar_width + g_bar_spacing));
+        if (ImGui::IsWindowHovered() && mouse.y >= strip_y && mouse.y < strip_y + (heat_rows * HEAT_ROW_HEIGHT) &&
+            mouse.x >= p.x && index < (int)g_access.reads.size()) {
+            ImGui::BeginTooltip();
+            ImGui::Text("Index %d: %u reads, %u writes", index, g_access.reads[index], g_access.writes[index]);
+            if (has_buffer) {
+                ImGui::Text("Buffer: %u reads, %u writes", g_access.buffer_reads[index], g_access.buffer_writes[index]);
+            }
+            ImGui::EndTooltip();
+        }
+    }
+
     ImGui::End();
 }
 
-static void render_stats(const char* algo_name) {
+// One cell per bar, on a log scale up to the busiest index of the row so a few hot spots don't wash out the rest
+static void render_heat_row(ImDrawList* draw_list, const std::vector<unsigned int>& counts, float x, float y, float bar_width) {
+    const unsigned int max_count = counts.empty() ? 0 : *std::max_element(counts.begin(), counts.end());
+    const float log_max = std::log1p((float)max_count);
+    for (int i = 0; i < (int)counts.size(); ++i) {
+        const float heat = (max_count > 0) ? std::log1p((float)counts[i]) / log_max : 0.0f;
+        // Dark blue through red to yellow
+        const float r = std::min(1.0f, heat * 2.0f);
+        const float g = std::max(0.0f, (heat * 2.0f) - 1.0f);
+        const float b = 0.25f * (1.0f - heat);
+        const ImU32 col = IM_COL32((int)(40 + (215 * r)), (int)(20 + (200 * g)), (int)(40 + (160 * b)), 255);
+
+        const float x0 = x + i * (bar_width + g_bar_spacing);
+        draw_list->AddRectFilled(ImVec2(x0, y), ImVec2(x0 + bar_width, y + HEAT_ROW_HEIGHT - 1.0f), col);
+    }
+}
+
+static void render_stats(const SortingAlgo& algo) {
     const float stats_height = calc_stats_height();
     const float sorting_height = (float)g_window_height - stats_height - (PADDING * 2.0f) - SECTION_GAP;
     const float stats_y = PADDING + sorting_height + SECTION_GAP;
@@ -485,9 +740,47 @@ static void render_stats(const char* algo_name) {
     ImGuiWindowFlags flags = ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse | ImGuiWindowFlags_NoCollapse;
     ImGui::Begin("Stats", nullptr, flags);
 
-    ImGui::Text("Algorithm: %s\t", algo_name);
+    ImGui::Text("Algorithm: %s\t", algo.name());
     ImGui::Text("Swaps: %u", g_num_swaps);
     ImGui::Text("Comparisons: %u", g_num_compar);
+    int write_rank = 0;
+    for (int i = 0; i < (int)g_write_ranking.size(); ++i) {
+        if (std::strcmp(g_write_ranking[i].name.c_str(), algo.name()) == 0) {
+            write_rank = i + 1;
+        }
+    }
+    if (write_rank > 0) {
+        ImGui::Text("Writes: %u (#%d of %d)", g_num_writes, write_rank, (int)g_write_ranking.size());
+    } else {
+        ImGui::Text("Writes: %u", g_num_writes);
+    }
+    // Hovering the line lists every algorithm by writes on the same input
+    if (!g_write_ranking.empty() && ImGui::IsItemHovered()) {
+        ImGui::BeginTooltip();
+        for (int i = 0; i < (int)g_write_ranking.size(); ++i) {
+            const WriteRank& rank = g_write_ranking[i];
+            const ImVec4 color = (i + 1 == write_rank) ? ImVec4(1.0f, 0.78f, 0.0f, 1.0f) : ImGui::GetStyle().Colors[ImGuiCol_Text];
+            ImGui::TextColored(color, "%2d. %-40s %8lld", i + 1, rank.name.c_str(), rank.writes);
+        }
+        ImGui::EndTooltip();
+    }
+    ImGui::Text("Aux memory: %zu B", algo.aux_memory_bytes());
+    const int last_level = g_cache->level_count() - 1;
+    ImGui::Text("Cache (sim): L1 miss %.1f%%, memory %.2f lines/elem", g_cache->stats(0).miss_rate() * 100.0,
+        (double)g_cache->stats(last_level).transfers() / g_array_size);
+    // Hovering the line shows every level of the model
+    if (ImGui::IsItemHovered()) {
+        const CacheConfig& config = g_cache->config();
+        ImGui::BeginTooltip();
+        ImGui::Text("%lld accesses, %d B lines", g_cache->accesses(), config.line_bytes);
+        for (int level = 0; level <= last_level; ++level) {
+            const CacheLevelStats& stats = g_cache->stats(level);
+            ImGui::Text("L%d %6zu B %2d-way: %8lld hits %8lld misses (%5.1f%%), %.2f transfers/elem", level + 1,
+                config.levels[level].size_bytes, config.levels[level].ways, stats.hits, stats.misses, stats.miss_rate() * 100.0,
+                (double)stats.transfers() / g_array_size);
+        }
+        ImGui::EndTooltip();
+    }
     ImGui::Text("FPS: %d", fps);
 
     ImGui::End();
@@ -545,11 +838,15 @@ static void render_controls(std::vector<int>& arr, std::vector<std::unique_ptr<S
                 } else {
                     g_num_swaps = 0;
                     g_num_compar = 0;
+                    g_num_writes = 0;
                 }
                 algorithms[selected_algo]->reset(g_array_size);
+                g_run_input = arr;
+                g_access.reset(g_array_size);
+                g_rates.clear();
             }
             g_sorting_done = false;
-            g_sorting_paused = false;
+            resume_sorting();
         }
     }
     ImGui::PopStyleVar();
@@ -585,6 +882,272 @@ static void render_controls(std::vector<int>& arr, std::vector<std::unique_ptr<S
         g_fps_cap = 0;
     }
 
+    // Text box for the animation speed
+    ImGui::SetNextItemWidth(combo_width / 2);
+    ImGui::InputInt(" Steps/frame", &g_steps_per_frame, 1, 10);
+    g_steps_per_frame = std::max(1, std::min(g_steps_per_frame, MAX_STEPS_PER_FRAME));
+
+    ImGui::End();
+}
+
+static void render_frame_stats() {
+    static const double PERCENTILES[] = {50.0, 95.0, 99.0};
+    static const int HISTOGRAM_BINS = 40;
+    static std::vector<float> bins(HISTOGRAM_BINS);
+
+    const float width = 460.0f;
+    ImGui::SetNextWindowPos(ImVec2((float)g_window_width - width - (PADDING * 4.0f), PADDING * 8.0f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(width, 0.0f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if (!ImGui::Begin("Frame timing", &g_show_frame_stats, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("Last %zu frames, frame cap delay excluded", g_frame_stats.frames());
+    const ImGuiTableFlags table_flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("##stages", 5, table_flags)) {
+        ImGui::TableSetupColumn("Stage (ms)");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("Share");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < FRAME_STAGE_COUNT; ++i) {
+            const FrameStage stage = (FrameStage)i;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(frame_stage_name(stage));
+            for (double p : PERCENTILES) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", g_frame_stats.stage_percentile(stage, p));
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f%%", g_frame_stats.stage_share(stage) * 100.0);
+        }
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted("Frame");
+        for (double p : PERCENTILES) {
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", g_frame_stats.frame_percentile(p));
+        }
+        ImGui::EndTable();
+    }
+
+    // The algorithm is the step, the renderer is everything from building the UI to presenting
+    const double step_share = g_frame_stats.stage_share(FrameStage::Step);
+    const double render_share = g_frame_stats.stage_share(FrameStage::UiBuild) + g_frame_stats.stage_share(FrameStage::Submit) +
+        g_frame_stats.stage_share(FrameStage::Present);
+    if (g_frame_stats.frames() > 0) {
+        ImGui::Text("Limited by: %s (%.0f%% of frame time)", (step_share > render_share) ? "the algorithm" : "the renderer",
+            std::max(step_share, render_share) * 100.0);
+    }
+
+    const RingBuffer<float>& history = g_frame_stats.frame_history();
+    const float p99 = g_frame_stats.frame_percentile(99.0);
+    const float plot_width = ImGui::GetContentRegionAvail().x;
+    ImGui::PlotLines("##frame_ms", history.data(), (int)history.size(), (int)history.offset(), "Frame time", 0.0f, p99 * 1.5f,
+        ImVec2(plot_width, 60.0f));
+
+    // Histogram up to 1.5x the p99, so the tail shows without one outlier flattening the rest
+    const float max_ms = std::max(p99 * 1.5f, 0.001f);
+    g_frame_stats.histogram(max_ms, bins);
+    char overlay[64];
+    std::snprintf(overlay, sizeof(overlay), "0 - %.2f ms", max_ms);
+    ImGui::PlotHistogram("##frame_hist", bins.data(), HISTOGRAM_BINS, 0, overlay, 0.0f, FLT_MAX, ImVec2(plot_width, 80.0f));
+
+    ImGui::End();
+}
+
+// Sweeps the selected algorithm over a geometric size range on demand and shows the fitted growth of its comparisons,
+// swaps and time, with time and comparisons per element charted against log n
+static void render_complexity(std::vector<std::unique_ptr<SortingAlgo>>& algorithms, int selected_algo) {
+    static std::vector<float> ns_per_element;
+    static std::vector<float> compares_per_nlogn;
+    static std::string status;
+
+    const float width = 520.0f;
+    ImGui::SetNextWindowPos(ImVec2(PADDING * 4.0f, PADDING * 8.0f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(width, 0.0f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if (!ImGui::Begin("Complexity", &g_show_complexity, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+
+    SortingAlgo& algo = *algorithms[selected_algo];
+    ImGui::Text("n = %d to %d (x2), random permutations", SWEEP_MIN_SIZE, SWEEP_MAX_SIZE);
+    const bool idle = g_sorting_done || g_sorting_paused;
+    ImGui::BeginDisabled(!idle);
+    if (ImGui::Button("Sweep")) {
+        // The sweep reuses the algorithm, so a paused run is dropped like on an algorithm switch
+        SweepOptions options;
+        options.min_size = SWEEP_MIN_SIZE;
+        options.max_size = SWEEP_MAX_SIZE;
+        options.max_ms = SWEEP_MAX_MS;
+        options.count_max_size = SWEEP_COUNT_MAX_SIZE;
+        algo.set_access_counters(nullptr);
+        g_sweep.algo = algo.name();
+        g_sweep.points = run_sweep(algo, options, (unsigned int)std::time(nullptr));
+        algo.set_access_counters(&g_access);
+        apply_tuning(algorithms, selected_algo);
+        algo.reset(g_array_size);
+        g_num_swaps = 0;
+        g_num_compar = 0;
+        g_num_writes = 0;
+        g_access.reset(g_array_size);
+        g_rates.clear();
+        g_sorting_done = true;
+        g_sorting_paused = true;
+
+        ns_per_element.clear();
+        compares_per_nlogn.clear();
+        for (const SweepPoint& point : g_sweep.points) {
+            ns_per_element.push_back((float)(point.ms * 1e6 / point.size));
+            if (point.compares >= 0) {
+                compares_per_nlogn.push_back((float)((double)point.compares / growth_model_value(GrowthModel::NLogN, point.size)));
+            }
+        }
+        status.clear();
+    }
+    ImGui::EndDisabled();
+    if (!idle && ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+        ImGui::SetTooltip("Pause or finish the run first");
+    }
+    ImGui::SameLine();
+    ImGui::BeginDisabled(g_sweep.points.empty());
+    if (ImGui::Button("Save CSV")) {
+        status = save_sweep_csv(SWEEP_CSV_FILE, {g_sweep}) ? std::string("Saved to ") + SWEEP_CSV_FILE : "Failed to write the CSV";
+    }
+    ImGui::EndDisabled();
+    if (!status.empty()) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(status.c_str());
+    }
+
+    if (g_sweep.points.empty()) {
+        ImGui::TextDisabled("No sweep yet");
+        ImGui::End();
+        return;
+    }
+
+    std::vector<double> sizes;
+    std::vector<double> compares;
+    std::vector<double> swaps;
+    std::vector<double> times;
+    for (const SweepPoint& point : g_sweep.points) {
+        sizes.push_back(point.size);
+        compares.push_back((double)point.compares);
+        swaps.push_back((double)point.swaps);
+        times.push_back(point.ms);
+    }
+    const ComplexityFit compare_fit = fit_complexity(sizes, compares);
+    ImGui::Text("%s, up to n = %d", g_sweep.algo.c_str(), g_sweep.points.back().size);
+    const ImGuiTableFlags table_flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("##fits", 4, table_flags)) {
+        ImGui::TableSetupColumn("Measure");
+        ImGui::TableSetupColumn("n^k");
+        ImGui::TableSetupColumn("Closest model");
+        ImGui::TableSetupColumn("c n log n error");
+        ImGui::TableHeadersRow();
+        const char* const names[] = {"Comparisons", "Swaps", "Time"};
+        const std::vector<double>* values[] = {&compares, &swaps, &times};
+        for (int i = 0; i < 3; ++i) {
+            const ComplexityFit fit = fit_complexity(sizes, *values[i]);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(names[i]);
+            ImGui::TableNextColumn();
+            if (fit.points < 3) {
+                ImGui::TextDisabled("-");
+                continue;
+            }
+            ImGui::Text("k = %.2f", fit.exponent);
+            ImGui::TableNextColumn();
+            ImGui::Text("%s (%.0f%%)", growth_model_name(fit.model), fit.model_rms * 100.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f%%", fit.nlogn_rms * 100.0);
+        }
+        ImGui::EndTable();
+    }
+
+    // Jumps are measured against the model the comparisons follow, so the algorithm's own growth doesn't count
+    const GrowthModel model = (compare_fit.points >= 3) ? compare_fit.model : GrowthModel::NLogN;
+    const std::vector<int> jumps = find_jumps(sizes, times, model, SWEEP_JUMP);
+    std::string jump_text = jumps.empty() ? "none" : "";
+    for (int i : jumps) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%s%d KiB", jump_text.empty() ? "" : ", ", (int)(g_sweep.points[i].size * sizeof(int) / 1024));
+        jump_text += text;
+    }
+    ImGui::Text("Time per element jumps (array size): %s", jump_text.c_str());
+    CacheConfig host;
+    if (host_cache_config(host)) {
+        std::string host_text;
+        for (size_t i = 0; i < host.levels.size(); ++i) {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%sL%zu %zu KiB", (i > 0) ? ", " : "", i + 1, host.levels[i].size_bytes >> 10);
+            host_text += text;
+        }
+        ImGui::TextDisabled("Host caches: %s", host_text.c_str());
+    }
+
+    // One point per size, so the x axis is log n
+    const float plot_width = ImGui::GetContentRegionAvail().x;
+    ImGui::PlotLines("##ns_per_element", ns_per_element.data(), (int)ns_per_element.size(), 0, "ns per element, log n ->", 0.0f,
+        FLT_MAX, ImVec2(plot_width, 90.0f));
+    if (!compares_per_nlogn.empty()) {
+        ImGui::PlotLines("##compares_per_nlogn", compares_per_nlogn.data(), (int)compares_per_nlogn.size(), 0,
+            "comparisons / n log2 n, log n ->", 0.0f, FLT_MAX, ImVec2(plot_width, 90.0f));
+    }
+
+    ImGui::End();
+}
+
+// Work per window of StepRates::WINDOW_STEPS steps of the current run and the array's sortedness after each window
+static void render_rates(const SortingAlgo& algo) {
+    const float width = 460.0f;
+    ImGui::SetNextWindowPos(ImVec2(((float)g_window_width - width) / 2.0f, PADDING * 8.0f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(width, 0.0f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if (!ImGui::Begin("Rates", &g_show_rates, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("%s, phase: %s", algo.name(), (g_sorting_done || g_sorting_paused) ? "-" : algo.phase());
+    if (g_rates.windows() == 0) {
+        ImGui::TextDisabled("Fewer than %d steps in this run yet", StepRates::WINDOW_STEPS);
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("Last %zu windows of %d steps, ~%.0f steps/s", g_rates.windows(), StepRates::WINDOW_STEPS,
+        (g_sorting_done || g_sorting_paused) ? 0.0f : g_fps * g_steps_per_frame);
+
+    struct RatePlot {
+        const char* id;
+        const char* label;
+        const RingBuffer<float>& history;
+    };
+    const RatePlot plots[] = {
+        {"##compares", "comparisons", g_rates.compares()},
+        {"##swaps", "swaps", g_rates.swaps()},
+        {"##writes", "writes", g_rates.writes()},
+    };
+    const float plot_width = ImGui::GetContentRegionAvail().x;
+    char overlay[64];
+    for (const RatePlot& plot : plots) {
+        const float max_value = StepRates::max_of(plot.history);
+        std::snprintf(overlay, sizeof(overlay), "%s/window: %.0f (max %.0f)", plot.label, plot.history.back(), max_value);
+        ImGui::PlotLines(plot.id, plot.history.data(), (int)plot.history.size(), (int)plot.history.offset(), overlay, 0.0f,
+            std::max(max_value, 1.0f) * 1.1f, ImVec2(plot_width, 60.0f));
+    }
+    const RingBuffer<float>& sortedness = g_rates.sortedness();
+    std::snprintf(overlay, sizeof(overlay), "adjacent pairs in order: %.1f%%", sortedness.back() * 100.0f);
+    ImGui::PlotLines("##sortedness", sortedness.data(), (int)sortedness.size(), (int)sortedness.offset(), overlay, 0.0f, 1.0f,
+        ImVec2(plot_width, 60.0f));
+
     ImGui::End();
 }
 
@@ -593,4 +1156,16 @@ static float calc_stats_height() {
     const float line_height = ImGui::GetTextLineHeightWithSpacing();
     const float content_height = (STATS_LINE_COUNT * line_height) - style.ItemSpacing.y;
     return (style.WindowPadding.y * 2.0f) + content_height;
-}
\ No newline at end of file
+}
+
+// Milliseconds since mark, which moves on to now
+static double lap_ms(Uint64& mark) {
+    const Uint64 now = SDL_GetPerformanceCounter();
+    const double ms = (double)(now - mark) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    mark = now;
+    return ms;
+}
+
+static ImU32 palette_col(const PaletteColor& color) {
+    return IM_COL32(color.r, color.g, color.b, 255);
+}